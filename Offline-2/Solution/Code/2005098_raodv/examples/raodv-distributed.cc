@@ -0,0 +1,547 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Partitioned version of the manet-routing-compare scenario for the distributed simulator.
+ */
+
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/raodv-module.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mpi.h>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("RaodvDistributed");
+
+/**
+ * \ingroup raodv-examples
+ * \ingroup examples
+ * \brief The manet-routing-compare scenario, partitioned over MPI ranks.
+ *
+ * A wireless channel cannot be split between ranks, so the area is cut into
+ * --regions strips of --regionWidth x --regionHeight m placed side by side,
+ * each with a WiFi channel of its own and owned by one rank, round robin. The
+ * nodes of a region move by random waypoint inside it. The first node of every
+ * region is a static gateway at its center, and the gateways of neighboring
+ * regions are joined by a point-to-point link whose delay is the propagation
+ * delay between them. With regions on different ranks these are the only links
+ * crossing ranks, so that delay is the lookahead of the distributed simulator.
+ * raodv runs on all the interfaces, the WiFi ones and the point-to-point ones.
+ *
+ * As in manet-routing-compare, the first half of the nodes are sinks, each
+ * one receiving 64 byte UDP packets at --packetNumber packets per second from
+ * a source in the second half. Every rank counts the traffic of the sources
+ * and sinks it owns, and rank 0 adds them up and appends one CSV row with the
+ * metrics, the number of ranks, the wall clock time of Simulator::Run and the
+ * events of all ranks. The random streams are assigned by node and region,
+ * never by rank, so the runs of one scenario with different numbers of ranks
+ * simulate the same network and their run times give the speedup:
+ *
+ * mpiexec -np 1 ./ns3 run "raodv-distributed --nodeNumber=1000 --regions=4"
+ * mpiexec -np 4 ./ns3 run "raodv-distributed --nodeNumber=1000 --regions=4"
+ */
+class DistributedExperiment
+{
+  public:
+    DistributedExperiment();
+    /**
+     * \brief Configure the experiment
+     * \param argc is the command line argument count
+     * \param argv is the command line arguments
+     * \return true on successful configuration
+     */
+    bool Configure(int argc, char** argv);
+    /// Run the simulation and write the results on rank 0
+    void Run();
+
+  private:
+    /// Traffic counters, summed over the ranks at the end of the run
+    struct Counters
+    {
+        uint64_t txPackets; ///< Packets sent by the sources
+        uint64_t rxPackets; ///< Packets received by the sinks
+        uint64_t rxBytes;   ///< Bytes received by the sinks
+        double delaySum;    ///< Sum of the end-to-end delays of the received packets, s
+    };
+
+    // parameters
+    /// Number of nodes, gateways included
+    uint32_t m_nodeNumber;
+    /// Packets per second of every source
+    uint32_t m_packetNumber;
+    /// Node speed, m/s
+    uint32_t m_nodeSpeed;
+    /// Number of regions
+    uint32_t m_regions;
+    /// Width of a region, m
+    double m_regionWidth;
+    /// Height of a region, m
+    double m_regionHeight;
+    /// Transmission power, dBm
+    double m_txp;
+    /// Simulation time, s
+    double m_totalTime;
+    /// Run number of RngSeedManager
+    uint32_t m_run;
+    /// CSV file the results are appended to
+    std::string m_CSVfileName;
+    /// Prefix of the raodv statistics files, none if empty
+    std::string m_statsPrefix;
+
+    /// Traffic of this rank
+    Counters m_counters;
+
+    /**
+     * \param nodeId a node index
+     * \returns the region of the node
+     */
+    uint32_t GetRegion(uint32_t nodeId) const;
+    /**
+     * Count a packet sent by a source and stamp it with the current time
+     * \param packet the packet
+     */
+    void TransmitPacket(Ptr<const Packet> packet);
+    /**
+     * Receive the packets of a sink
+     * \param socket the receiving socket
+     */
+    void ReceivePacket(Ptr<Socket> socket);
+};
+
+/**
+ * Transmission timestamp carried by the data packets, to measure their end-to-end delay.
+ */
+class DistributedTimestampTag : public Tag
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("RaodvDistributedTimestampTag")
+                                .SetParent<Tag>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<DistributedTimestampTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return sizeof(int64_t);
+    }
+
+    void Serialize(TagBuffer i) const override
+    {
+        i.WriteU64(m_timestamp.GetTimeStep());
+    }
+
+    void Deserialize(TagBuffer i) override
+    {
+        m_timestamp = TimeStep(i.ReadU64());
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "t=" << m_timestamp;
+    }
+
+    /**
+     * Set the transmission time.
+     * \param t The time.
+     */
+    void SetTimestamp(Time t)
+    {
+        m_timestamp = t;
+    }
+
+    /**
+     * \return the transmission time.
+     */
+    Time GetTimestamp() const
+    {
+        return m_timestamp;
+    }
+
+  private:
+    Time m_timestamp; //!< Transmission time.
+};
+
+int
+main(int argc, char** argv)
+{
+    DistributedExperiment experiment;
+    if (!experiment.Configure(argc, argv))
+    {
+        NS_FATAL_ERROR("Configuration failed. Aborted.");
+    }
+    experiment.Run();
+    MpiInterface::Disable();
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+DistributedExperiment::DistributedExperiment()
+    : m_nodeNumber(1000),
+      m_packetNumber(4),
+      m_nodeSpeed(5),
+      m_regions(0),
+      m_regionWidth(300),
+      m_regionHeight(1500),
+      m_txp(15),
+      m_totalTime(10),
+      m_run(1),
+      m_CSVfileName("raodv-distributed.csv"),
+      m_statsPrefix(""),
+      m_counters{0, 0, 0, 0.0}
+{
+}
+
+bool
+DistributedExperiment::Configure(int argc, char** argv)
+{
+    bool nullmsg = false;
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("nodeNumber", "Number of nodes, gateways included.", m_nodeNumber);
+    cmd.AddValue("packetNumber", "Packets per second of every source.", m_packetNumber);
+    cmd.AddValue("nodeSpeed", "Node speed, m/s.", m_nodeSpeed);
+    cmd.AddValue("regions", "Number of regions, 0 for one per rank.", m_regions);
+    cmd.AddValue("regionWidth", "Width of a region, m.", m_regionWidth);
+    cmd.AddValue("regionHeight", "Height of a region, m.", m_regionHeight);
+    cmd.AddValue("txp", "Transmission power, dBm.", m_txp);
+    cmd.AddValue("time", "Simulation time, s.", m_totalTime);
+    cmd.AddValue("run", "Run number of the random number generator.", m_run);
+    cmd.AddValue("CSVfileName", "CSV file the results are appended to.", m_CSVfileName);
+    cmd.AddValue("statsPrefix",
+                 "Prefix of the raodv statistics files of each rank.",
+                 m_statsPrefix);
+    cmd.AddValue("nullmsg", "Use the null message synchronization algorithm.", nullmsg);
+    cmd.Parse(argc, argv);
+
+    // The granted time window algorithm by default
+    GlobalValue::Bind("SimulatorImplementationType",
+                      StringValue(nullmsg ? "ns3::NullMessageSimulatorImpl"
+                                          : "ns3::DistributedSimulatorImpl"));
+    MpiInterface::Enable(&argc, &argv);
+
+    if (m_regions == 0)
+    {
+        m_regions = MpiInterface::GetSize();
+    }
+    if (m_regions < MpiInterface::GetSize())
+    {
+        std::cerr << "Fewer regions than ranks, some ranks would have nothing to do"
+                  << std::endl;
+        return false;
+    }
+    if (m_nodeNumber < 2 * m_regions)
+    {
+        std::cerr << "Every region needs a gateway and another node" << std::endl;
+        return false;
+    }
+    return m_packetNumber > 0 && m_totalTime > 2;
+}
+
+uint32_t
+DistributedExperiment::GetRegion(uint32_t nodeId) const
+{
+    // The first m_nodeNumber % m_regions regions have one node more
+    uint32_t small = m_nodeNumber / m_regions;
+    uint32_t large = m_nodeNumber % m_regions;
+    if (nodeId < large * (small + 1))
+    {
+        return nodeId / (small + 1);
+    }
+    return large + (nodeId - large * (small + 1)) / small;
+}
+
+void
+DistributedExperiment::TransmitPacket(Ptr<const Packet> packet)
+{
+    DistributedTimestampTag tag;
+    tag.SetTimestamp(Simulator::Now());
+    packet->AddByteTag(tag);
+    m_counters.txPackets++;
+}
+
+void
+DistributedExperiment::ReceivePacket(Ptr<Socket> socket)
+{
+    Ptr<Packet> packet;
+    while ((packet = socket->Recv()))
+    {
+        m_counters.rxPackets++;
+        m_counters.rxBytes += packet->GetSize();
+        DistributedTimestampTag tag;
+        if (packet->FindFirstMatchingByteTag(tag))
+        {
+            m_counters.delaySum += (Simulator::Now() - tag.GetTimestamp()).GetSeconds();
+        }
+    }
+}
+
+void
+DistributedExperiment::Run()
+{
+    auto setupStart = std::chrono::steady_clock::now();
+    uint32_t rank = MpiInterface::GetSystemId();
+    uint32_t ranks = MpiInterface::GetSize();
+    RngSeedManager::SetRun(m_run);
+    std::string phyMode("DsssRate11Mbps");
+    Config::SetDefault("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue(phyMode));
+
+    // Every rank creates all the nodes, each one tagged with the rank owning its region
+    NodeContainer nodes;
+    std::vector<NodeContainer> regionNodes(m_regions);
+    for (uint32_t i = 0; i < m_nodeNumber; i++)
+    {
+        uint32_t region = GetRegion(i);
+        Ptr<Node> node = CreateObject<Node>(region % ranks);
+        nodes.Add(node);
+        regionNodes[region].Add(node);
+    }
+
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211b);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode",
+                                 StringValue(phyMode),
+                                 "ControlMode",
+                                 StringValue(phyMode));
+    YansWifiPhyHelper wifiPhy;
+    wifiPhy.Set("TxPowerStart", DoubleValue(m_txp));
+    wifiPhy.Set("TxPowerEnd", DoubleValue(m_txp));
+    WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac");
+    YansWifiChannelHelper wifiChannel;
+    wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+    wifiChannel.AddPropagationLoss("ns3::FriisPropagationLossModel");
+    std::vector<NetDeviceContainer> regionDevices(m_regions);
+    for (uint32_t r = 0; r < m_regions; r++)
+    {
+        wifiPhy.SetChannel(wifiChannel.Create());
+        regionDevices[r] = wifi.Install(wifiPhy, wifiMac, regionNodes[r]);
+    }
+
+    // Only the owner of a region moves its nodes, from streams of its own, so that the
+    // placeholder nodes of the other ranks do not schedule mobility events
+    // Two streams for the positions of a region and two for every node moving in it
+    int64_t regionStreams = 2 * (m_nodeNumber / m_regions + 2);
+    int64_t stream = 0;
+    for (uint32_t r = 0; r < m_regions; r++)
+    {
+        double x0 = r * m_regionWidth;
+        Ptr<Node> gateway = regionNodes[r].Get(0);
+        Ptr<ConstantPositionMobilityModel> fixed = CreateObject<ConstantPositionMobilityModel>();
+        fixed->SetPosition(Vector(x0 + m_regionWidth / 2, m_regionHeight / 2, 0));
+        gateway->AggregateObject(fixed);
+
+        NodeContainer mobile;
+        for (uint32_t i = 1; i < regionNodes[r].GetN(); i++)
+        {
+            mobile.Add(regionNodes[r].Get(i));
+        }
+        int64_t regionStream = stream + r * regionStreams;
+        MobilityHelper mobility;
+        if (gateway->GetSystemId() == rank)
+        {
+            std::ostringstream rangeX;
+            rangeX << "ns3::UniformRandomVariable[Min=" << x0 << "|Max=" << x0 + m_regionWidth
+                   << "]";
+            std::ostringstream rangeY;
+            rangeY << "ns3::UniformRandomVariable[Min=0.0|Max=" << m_regionHeight << "]";
+            ObjectFactory pos;
+            pos.SetTypeId("ns3::RandomRectanglePositionAllocator");
+            pos.Set("X", StringValue(rangeX.str()));
+            pos.Set("Y", StringValue(rangeY.str()));
+            Ptr<PositionAllocator> positions = pos.Create()->GetObject<PositionAllocator>();
+            positions->AssignStreams(regionStream);
+            std::ostringstream speed;
+            speed << "ns3::ConstantRandomVariable[Constant=" << m_nodeSpeed << "]";
+            mobility.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+                                      "Speed",
+                                      StringValue(speed.str()),
+                                      "Pause",
+                                      StringValue("ns3::ConstantRandomVariable[Constant=0]"),
+                                      "PositionAllocator",
+                                      PointerValue(positions));
+            mobility.SetPositionAllocator(positions);
+            mobility.Install(mobile);
+            mobility.AssignStreams(mobile, regionStream + 2);
+        }
+        else
+        {
+            mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+            mobility.Install(mobile);
+        }
+    }
+    stream += m_regions * regionStreams;
+
+    // Backhaul between the gateways of neighboring regions; the point-to-point helper makes
+    // remote channels for the links between regions of different ranks
+    Ptr<ConstantSpeedPropagationDelayModel> propagation =
+        CreateObject<ConstantSpeedPropagationDelayModel>();
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue("100Mbps"));
+    std::vector<NetDeviceContainer> backhaulDevices;
+    Time lookahead = Time::Max();
+    for (uint32_t r = 0; r + 1 < m_regions; r++)
+    {
+        Ptr<Node> a = regionNodes[r].Get(0);
+        Ptr<Node> b = regionNodes[r + 1].Get(0);
+        Time delay = propagation->GetDelay(a->GetObject<MobilityModel>(),
+                                           b->GetObject<MobilityModel>());
+        p2p.SetChannelAttribute("Delay", TimeValue(delay));
+        backhaulDevices.push_back(p2p.Install(a, b));
+        if (a->GetSystemId() != b->GetSystemId())
+        {
+            lookahead = std::min(lookahead, delay);
+        }
+    }
+    if (rank == 0 && lookahead != Time::Max())
+    {
+        std::cout << "Lookahead " << lookahead.As(Time::US) << std::endl;
+    }
+
+    RaodvHelper raodv;
+    InternetStackHelper internet;
+    internet.SetRoutingHelper(raodv);
+    internet.Install(nodes);
+    // Over all the nodes on every rank, so that every agent gets the same stream everywhere
+    stream += raodv.AssignStreams(nodes, stream);
+    for (uint32_t r = 0; r < m_regions; r++)
+    {
+        stream += wifi.AssignStreams(regionDevices[r], stream);
+    }
+
+    Ipv4AddressHelper address;
+    std::vector<Ipv4InterfaceContainer> regionInterfaces(m_regions);
+    for (uint32_t r = 0; r < m_regions; r++)
+    {
+        std::ostringstream base;
+        base << "10." << r + 1 << ".0.0";
+        address.SetBase(base.str().c_str(), "255.255.0.0");
+        regionInterfaces[r] = address.Assign(regionDevices[r]);
+    }
+    for (uint32_t r = 0; r < backhaulDevices.size(); r++)
+    {
+        std::ostringstream base;
+        base << "172.16." << r << ".0";
+        address.SetBase(base.str().c_str(), "255.255.255.252");
+        address.Assign(backhaulDevices[r]);
+    }
+
+    // Sink i receives from source i + sinks; an application only runs on the rank of its node
+    uint16_t port = 9;
+    OnOffHelper onoff("ns3::UdpSocketFactory", Address());
+    onoff.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));
+    onoff.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]"));
+    onoff.SetAttribute("PacketSize", UintegerValue(64));
+    onoff.SetAttribute("DataRate", DataRateValue(DataRate(m_packetNumber * 64 * 8)));
+    Ptr<UniformRandomVariable> start = CreateObject<UniformRandomVariable>();
+    start->SetStream(stream++);
+    uint32_t sinks = m_nodeNumber / 2;
+    for (uint32_t i = 0; i < sinks; i++)
+    {
+        // Drawn on every rank, so that the start times do not depend on the partitioning
+        double startTime = start->GetValue(1.0, 2.0);
+        Ptr<Node> sinkNode = nodes.Get(i);
+        Ptr<Node> sourceNode = nodes.Get(i + sinks);
+        Ipv4Address sinkAddress = sinkNode->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+        if (sinkNode->GetSystemId() == rank)
+        {
+            Ptr<Socket> sink = Socket::CreateSocket(sinkNode, UdpSocketFactory::GetTypeId());
+            sink->Bind(InetSocketAddress(sinkAddress, port));
+            sink->SetRecvCallback(MakeCallback(&DistributedExperiment::ReceivePacket, this));
+        }
+        if (sourceNode->GetSystemId() == rank)
+        {
+            onoff.SetAttribute("Remote", AddressValue(InetSocketAddress(sinkAddress, port)));
+            ApplicationContainer source = onoff.Install(sourceNode);
+            source.Start(Seconds(startTime));
+            source.Stop(Seconds(m_totalTime));
+            source.Get(0)->TraceConnectWithoutContext(
+                "Tx",
+                MakeCallback(&DistributedExperiment::TransmitPacket, this));
+        }
+    }
+
+    NS_LOG_INFO("Run Simulation on rank " << rank << " of " << ranks);
+    Simulator::Stop(Seconds(m_totalTime));
+    auto runStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    auto runEnd = std::chrono::steady_clock::now();
+
+    if (!m_statsPrefix.empty())
+    {
+        raodv.DumpStatistics(nodes, m_statsPrefix + "-rank" + std::to_string(rank));
+    }
+
+    double setupSeconds = std::chrono::duration<double>(runStart - setupStart).count();
+    double runSeconds = std::chrono::duration<double>(runEnd - runStart).count();
+    uint64_t events = Simulator::GetEventCount();
+    Simulator::Destroy();
+
+    // The slowest rank sets the wall clock time, the traffic and events are summed
+    MPI_Comm comm = MpiInterface::GetCommunicator();
+    Counters total;
+    double maxSetupSeconds;
+    double maxRunSeconds;
+    uint64_t totalEvents;
+    MPI_Reduce(&m_counters.txPackets, &total.txPackets, 1, MPI_UINT64_T, MPI_SUM, 0, comm);
+    MPI_Reduce(&m_counters.rxPackets, &total.rxPackets, 1, MPI_UINT64_T, MPI_SUM, 0, comm);
+    MPI_Reduce(&m_counters.rxBytes, &total.rxBytes, 1, MPI_UINT64_T, MPI_SUM, 0, comm);
+    MPI_Reduce(&m_counters.delaySum, &total.delaySum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    MPI_Reduce(&setupSeconds, &maxSetupSeconds, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(&runSeconds, &maxRunSeconds, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(&events, &totalEvents, 1, MPI_UINT64_T, MPI_SUM, 0, comm);
+    if (rank != 0)
+    {
+        return;
+    }
+
+    double throughput = total.rxBytes * 8.0 / (m_totalTime * 1024);
+    double delay = total.rxPackets ? total.delaySum / total.rxPackets : 0;
+    // Packets still in flight at the end of the run count as dropped
+    double delivered = std::min(total.rxPackets, total.txPackets);
+    double deliveryRatio = total.txPackets ? delivered / total.txPackets * 100 : 0;
+    double dropRatio = total.txPackets ? (total.txPackets - delivered) / total.txPackets * 100 : 0;
+
+    std::ostringstream row;
+    row << m_nodeNumber << "," << m_packetNumber << "," << m_nodeSpeed << "," << m_regions
+        << "," << ranks << "," << m_run << "," << m_totalTime << "," << maxSetupSeconds << ","
+        << maxRunSeconds << "," << totalEvents << "," << throughput << "," << delay << ","
+        << deliveryRatio << "," << dropRatio << "\n";
+    std::cout << row.str() << std::flush;
+
+    std::ifstream existing(m_CSVfileName);
+    bool writeHeader = !existing || existing.peek() == std::ifstream::traits_type::eof();
+    existing.close();
+    std::ofstream out(m_CSVfileName, std::ios::app);
+    if (writeHeader)
+    {
+        out << "Number of nodes,Number of packets per second,Speed of nodes,Regions,Ranks,Run,"
+            << "Simulation time,Setup wall time,Run wall time,Events,Throughput,"
+            << "End-to-end Delay,Packet Delivery Ratio,Packet Drop Ratio\n";
+    }
+    out << row.str();
+}
@@ -0,0 +1,584 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Microbenchmarks of the raodv data structures and control message headers.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/packet.h"
+#include "ns3/raodv-dpd.h"
+#include "ns3/raodv-id-cache.h"
+#include "ns3/raodv-neighbor.h"
+#include "ns3/raodv-packet.h"
+#include "ns3/raodv-rqueue.h"
+#include "ns3/raodv-rtable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+using namespace ns3::raodv;
+
+/// Number of heap allocations made by the program so far
+static std::atomic<uint64_t> g_allocations{0};
+
+void*
+operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * \ingroup raodv-examples
+ * \ingroup examples
+ * \brief Microbenchmarks of the raodv data structures.
+ *
+ * Every structure is driven by a synthetic workload mixing lookups, inserts
+ * and expiries, with about size live entries. Simulated time advances by
+ * one step per batch of size / 10 operations, so the lifetimes are given in
+ * steps. Each row of the output reports the wall clock time and the heap
+ * allocations per operation, counted through a replacement operator new.
+ *
+ * ./ns3 run "raodv-microbenchmark --minSize=100 --maxSize=100000"
+ */
+class RaodvMicrobenchmark
+{
+  public:
+    RaodvMicrobenchmark();
+    /**
+     * \brief Configure the benchmark
+     * \param argc is the command line argument count
+     * \param argv is the command line arguments
+     * \return true on successful configuration
+     */
+    bool Configure(int argc, char** argv);
+    /// Run all benchmarks and print the table
+    void Run();
+
+  private:
+    /// Operation of a workload, called with the operation index
+    typedef std::function<void(uint64_t)> Operation;
+
+    /// Smallest workload size
+    uint32_t m_minSize;
+    /// Largest workload size
+    uint32_t m_maxSize;
+    /// Operations per measurement
+    uint64_t m_ops;
+    /// Only run the structures whose name contains this string
+    std::string m_filter;
+    /// Random state of the workloads
+    uint64_t m_random;
+
+    /**
+     * Measure a workload
+     *
+     * The operations run in batches, one simulator event per batch, and the
+     * simulator is destroyed afterwards.
+     *
+     * \param structure the name of the structure
+     * \param operation the name of the operation mix
+     * \param size the workload size
+     * \param op the operation
+     */
+    void Measure(const std::string& structure,
+                 const std::string& operation,
+                 uint32_t size,
+                 Operation op);
+    /**
+     * Measure a workload which does not need simulated time
+     * \param structure the name of the structure
+     * \param operation the name of the operation
+     * \param size the workload size
+     * \param op the operation
+     */
+    void MeasureDirect(const std::string& structure,
+                       const std::string& operation,
+                       uint32_t size,
+                       Operation op);
+    /**
+     * Print a result row
+     * \param structure the name of the structure
+     * \param operation the name of the operation
+     * \param size the workload size
+     * \param ns the wall clock time, nanoseconds
+     * \param allocations the number of allocations
+     */
+    void Report(const std::string& structure,
+                const std::string& operation,
+                uint32_t size,
+                double ns,
+                uint64_t allocations) const;
+    /**
+     * Run one batch of operations and schedule the next one
+     * \param op the operation
+     * \param first index of the first operation of the batch
+     * \param batch the batch size
+     */
+    void RunBatch(const Operation* op, uint64_t first, uint64_t batch);
+    /**
+     * \param n upper bound
+     * \returns a pseudo random number in [0, n)
+     */
+    uint64_t Random(uint64_t n);
+    /**
+     * \param structure the name of the structure
+     * \returns whether the structure passes the filter
+     */
+    bool Selected(const std::string& structure) const;
+
+    /**
+     * Benchmark IdCache
+     * \param size the number of live entries
+     */
+    void BenchIdCache(uint32_t size);
+    /**
+     * Benchmark DuplicatePacketDetection
+     * \param size the number of live entries
+     */
+    void BenchDpd(uint32_t size);
+    /**
+     * Benchmark RoutingTable
+     * \param size the number of routes
+     */
+    void BenchRoutingTable(uint32_t size);
+    /**
+     * Benchmark RequestQueue
+     * \param size the queue length
+     */
+    void BenchRequestQueue(uint32_t size);
+    /**
+     * Benchmark Neighbors
+     * \param size the number of neighbors
+     */
+    void BenchNeighbors(uint32_t size);
+    /// Benchmark the header serialization and deserialization
+    void BenchHeaders();
+    /**
+     * Benchmark the serialization and deserialization of a header
+     * \param name the name of the header
+     * \param size the size reported for the header
+     * \param header the header to serialize
+     * \param copy a header to deserialize into
+     */
+    void BenchHeader(const std::string& name, uint32_t size, const Header& header, Header& copy);
+};
+
+/// Simulated time between two batches
+static const Time STEP = MilliSeconds(1);
+
+/**
+ * \param i the address index
+ * \returns the i-th address of 10.0.0.0/8
+ */
+static Ipv4Address
+MakeAddress(uint64_t i)
+{
+    return Ipv4Address(0x0a000000 + uint32_t(i % 0xffffff) + 1);
+}
+
+/// Unicast forward callback of the queued packets
+static void
+QueueUnicast(Ptr<Ipv4Route>, Ptr<const Packet>, const Ipv4Header&)
+{
+}
+
+/// Error callback of the queued packets
+static void
+QueueError(Ptr<const Packet>, const Ipv4Header&, Socket::SocketErrno)
+{
+}
+
+int
+main(int argc, char** argv)
+{
+    RaodvMicrobenchmark bench;
+    if (!bench.Configure(argc, argv))
+    {
+        NS_FATAL_ERROR("Configuration failed. Aborted.");
+    }
+    bench.Run();
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+RaodvMicrobenchmark::RaodvMicrobenchmark()
+    : m_minSize(100),
+      m_maxSize(100000),
+      m_ops(200000),
+      m_filter(""),
+      m_random(0x9e3779b97f4a7c15ULL)
+{
+}
+
+bool
+RaodvMicrobenchmark::Configure(int argc, char** argv)
+{
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("minSize", "Smallest workload size.", m_minSize);
+    cmd.AddValue("maxSize", "Largest workload size, sizes grow tenfold.", m_maxSize);
+    cmd.AddValue("ops", "Operations per measurement.", m_ops);
+    cmd.AddValue("filter", "Only run the structures whose name contains this.", m_filter);
+    cmd.Parse(argc, argv);
+    return m_minSize > 0 && m_minSize <= m_maxSize && m_ops > 0;
+}
+
+void
+RaodvMicrobenchmark::Run()
+{
+    std::cout << "structure,operation,size,ops,ns_per_op,allocs_per_op\n";
+    for (uint64_t size = m_minSize; size <= m_maxSize; size *= 10)
+    {
+        BenchIdCache(size);
+        BenchDpd(size);
+        BenchRoutingTable(size);
+        BenchRequestQueue(size);
+        BenchNeighbors(size);
+    }
+    BenchHeaders();
+}
+
+uint64_t
+RaodvMicrobenchmark::Random(uint64_t n)
+{
+    // xorshift64*, cheap and allocation free
+    m_random ^= m_random >> 12;
+    m_random ^= m_random << 25;
+    m_random ^= m_random >> 27;
+    return ((m_random * 0x2545f4914f6cdd1dULL) >> 11) % n;
+}
+
+bool
+RaodvMicrobenchmark::Selected(const std::string& structure) const
+{
+    return structure.find(m_filter) != std::string::npos;
+}
+
+void
+RaodvMicrobenchmark::RunBatch(const Operation* op, uint64_t first, uint64_t batch)
+{
+    uint64_t last = std::min(first + batch, m_ops);
+    for (uint64_t i = first; i < last; i++)
+    {
+        (*op)(i);
+    }
+    if (last < m_ops)
+    {
+        Simulator::Schedule(STEP, &RaodvMicrobenchmark::RunBatch, this, op, last, batch);
+    }
+}
+
+void
+RaodvMicrobenchmark::Measure(const std::string& structure,
+                             const std::string& operation,
+                             uint32_t size,
+                             Operation op)
+{
+    uint64_t batch = std::max<uint64_t>(size / 10, 1);
+    Simulator::Schedule(STEP, &RaodvMicrobenchmark::RunBatch, this, &op, 0, batch);
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    Simulator::Run();
+    auto end = std::chrono::steady_clock::now();
+    allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+    Simulator::Destroy();
+    Report(structure,
+           operation,
+           size,
+           std::chrono::duration<double, std::nano>(end - start).count(),
+           allocations);
+}
+
+void
+RaodvMicrobenchmark::MeasureDirect(const std::string& structure,
+                                   const std::string& operation,
+                                   uint32_t size,
+                                   Operation op)
+{
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < m_ops; i++)
+    {
+        op(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+    Report(structure,
+           operation,
+           size,
+           std::chrono::duration<double, std::nano>(end - start).count(),
+           allocations);
+}
+
+void
+RaodvMicrobenchmark::Report(const std::string& structure,
+                            const std::string& operation,
+                            uint32_t size,
+                            double ns,
+                            uint64_t allocations) const
+{
+    std::cout << structure << "," << operation << "," << size << "," << m_ops << ","
+              << ns / m_ops << "," << double(allocations) / m_ops << std::endl;
+}
+
+void
+RaodvMicrobenchmark::BenchIdCache(uint32_t size)
+{
+    if (!Selected("IdCache"))
+    {
+        return;
+    }
+    // One insert for three lookups of live entries; the lifetime keeps about size entries
+    uint64_t batch = std::max<uint32_t>(size / 10, 1);
+    Time lifetime = STEP * int64_t(size * 4 / batch);
+    IdCache cache(lifetime);
+    uint64_t inserted = 0;
+    Measure("IdCache", "insert25-lookup75", size, [&](uint64_t i) {
+        if (i % 4 == 0 || inserted == 0)
+        {
+            cache.IsDuplicate(MakeAddress(inserted % size), inserted / size);
+            inserted++;
+            return;
+        }
+        uint64_t k = inserted - 1 - Random(std::min<uint64_t>(inserted, size));
+        cache.IsDuplicate(MakeAddress(k % size), k / size);
+    });
+}
+
+void
+RaodvMicrobenchmark::BenchDpd(uint32_t size)
+{
+    if (!Selected("DuplicatePacketDetection"))
+    {
+        return;
+    }
+    // Every other broadcast is a copy of a recent one
+    std::vector<Ptr<Packet>> packets(m_ops / 2 + 1);
+    for (auto& p : packets)
+    {
+        p = Create<Packet>();
+    }
+    std::vector<Ipv4Header> headers(size);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        headers[i].SetSource(MakeAddress(i));
+    }
+    uint64_t batch = std::max<uint32_t>(size / 10, 1);
+    DuplicatePacketDetection dpd(STEP * int64_t(size * 2 / batch));
+    uint64_t received = 0;
+    Measure("DuplicatePacketDetection", "new50-copy50", size, [&](uint64_t i) {
+        if (i % 2 == 0 || received == 0)
+        {
+            dpd.IsDuplicate(packets[received], headers[received % size]);
+            received++;
+            return;
+        }
+        uint64_t k = received - 1 - Random(std::min<uint64_t>(received, size));
+        dpd.IsDuplicate(packets[k], headers[k % size]);
+    });
+}
+
+void
+RaodvMicrobenchmark::BenchRoutingTable(uint32_t size)
+{
+    if (!Selected("RoutingTable"))
+    {
+        return;
+    }
+    // Lookups of active routes, refreshes, and replacement of expiring routes
+    uint64_t batch = std::max<uint32_t>(size / 10, 1);
+    Time lifetime = STEP * int64_t(size * 20 / batch);
+    RoutingTable table(Seconds(0));
+    for (uint32_t i = 0; i < size; i++)
+    {
+        RoutingTableEntry rt(nullptr,
+                             MakeAddress(i),
+                             true,
+                             i,
+                             Ipv4InterfaceAddress(),
+                             1 + i % 8,
+                             MakeAddress(i % 16),
+                             lifetime);
+        table.AddRoute(rt);
+    }
+    uint64_t added = size;
+    Measure("RoutingTable", "lookup80-update10-replace10", size, [&](uint64_t i) {
+        RoutingTableEntry rt;
+        uint32_t mix = i % 10;
+        if (mix < 8)
+        {
+            table.LookupValidRoute(MakeAddress(Random(added)), rt);
+        }
+        else if (mix == 8)
+        {
+            if (table.LookupRoute(MakeAddress(Random(added)), rt))
+            {
+                rt.SetLifeTime(lifetime);
+                table.Update(rt);
+            }
+        }
+        else
+        {
+            table.DeleteRoute(MakeAddress(added - size));
+            RoutingTableEntry fresh(nullptr,
+                                    MakeAddress(added),
+                                    true,
+                                    added,
+                                    Ipv4InterfaceAddress(),
+                                    1 + added % 8,
+                                    MakeAddress(added % 16),
+                                    lifetime);
+            table.AddRoute(fresh);
+            added++;
+        }
+    });
+}
+
+void
+RaodvMicrobenchmark::BenchRequestQueue(uint32_t size)
+{
+    if (!Selected("RequestQueue"))
+    {
+        return;
+    }
+    // Packets for size / 8 destinations; a found route flushes one destination
+    std::vector<Ptr<Packet>> packets(m_ops);
+    for (auto& p : packets)
+    {
+        p = Create<Packet>();
+    }
+    uint32_t destinations = std::max<uint32_t>(size / 8, 1);
+    RequestQueue queue(size, Seconds(30));
+    Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback(&QueueUnicast);
+    Ipv4RoutingProtocol::ErrorCallback ecb = MakeCallback(&QueueError);
+    std::vector<QueueEntry> entries;
+    entries.reserve(size);
+    Ipv4Header header;
+    Measure("RequestQueue", "enqueue75-find15-flush10", size, [&](uint64_t i) {
+        uint32_t mix = i % 20;
+        Ipv4Address dst = MakeAddress(Random(destinations));
+        if (mix < 15)
+        {
+            header.SetDestination(dst);
+            QueueEntry entry(packets[i], header, ucb, ecb);
+            queue.Enqueue(entry);
+        }
+        else if (mix < 18)
+        {
+            queue.Find(dst);
+        }
+        else
+        {
+            entries.clear();
+            queue.DequeueAll(dst, entries);
+        }
+    });
+}
+
+void
+RaodvMicrobenchmark::BenchNeighbors(uint32_t size)
+{
+    if (!Selected("Neighbors"))
+    {
+        return;
+    }
+    // Hellos refreshing neighbors, checks, and a stream of new neighbors expiring others
+    uint64_t batch = std::max<uint32_t>(size / 10, 1);
+    Time lifetime = STEP * int64_t(size * 10 / batch);
+    Neighbors neighbors(Seconds(1));
+    for (uint32_t i = 0; i < size; i++)
+    {
+        neighbors.Update(MakeAddress(i), lifetime);
+    }
+    uint64_t added = size;
+    Measure("Neighbors", "refresh70-check20-new10", size, [&](uint64_t i) {
+        uint32_t mix = i % 10;
+        if (mix < 7)
+        {
+            neighbors.Update(MakeAddress(added - 1 - Random(size)), lifetime);
+        }
+        else if (mix < 9)
+        {
+            neighbors.IsNeighbor(MakeAddress(added - 1 - Random(size)));
+        }
+        else
+        {
+            neighbors.Update(MakeAddress(added), lifetime);
+            added++;
+        }
+    });
+}
+
+void
+RaodvMicrobenchmark::BenchHeader(const std::string& name,
+                                 uint32_t size,
+                                 const Header& header,
+                                 Header& copy)
+{
+    uint32_t length = header.GetSerializedSize();
+    Buffer buffer;
+    buffer.AddAtStart(length);
+    MeasureDirect(name, "serialize", size, [&](uint64_t) { header.Serialize(buffer.Begin()); });
+    MeasureDirect(name, "deserialize", size, [&](uint64_t) { copy.Deserialize(buffer.Begin()); });
+    MeasureDirect(name, "packet-add-remove", size, [&](uint64_t) {
+        Ptr<Packet> packet = Create<Packet>();
+        packet->AddHeader(header);
+        packet->RemoveHeader(copy);
+    });
+}
+
+void
+RaodvMicrobenchmark::BenchHeaders()
+{
+    if (Selected("RreqHeader"))
+    {
+        RreqHeader rreq(0, 0, 3, 42, MakeAddress(1), 7, MakeAddress(2), 9);
+        RreqHeader copy;
+        BenchHeader("RreqHeader", 1, rreq, copy);
+    }
+    if (Selected("RevRreqHeader"))
+    {
+        RevRreqHeader rreq(0, 0, 3, 42, MakeAddress(1), 7, MakeAddress(2), 9);
+        RevRreqHeader copy;
+        BenchHeader("RevRreqHeader", 1, rreq, copy);
+    }
+    if (Selected("RerrHeader"))
+    {
+        for (uint32_t destinations : {1, 16, 255})
+        {
+            RerrHeader rerr;
+            for (uint32_t i = 0; i < destinations; i++)
+            {
+                rerr.AddUnDestination(MakeAddress(i), i);
+            }
+            RerrHeader copy;
+            BenchHeader("RerrHeader", destinations, rerr, copy);
+        }
+    }
+}
@@ -0,0 +1,438 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ *
+ * Simulator cost of raodv against AODV, OLSR and DSDV as the network grows.
+ */
+
+#include "ns3/aodv-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/core-module.h"
+#include "ns3/dsdv-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/network-module.h"
+#include "ns3/olsr-module.h"
+#include "ns3/raodv-module.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup raodv-examples
+ * \ingroup examples
+ * \brief Scaling benchmark of the MANET routing protocols.
+ *
+ * Every combination of --protocols, --nodes and --speeds is simulated in
+ * its own child process, one at a time, so that the wall clock times are not
+ * disturbed by each other and the peak resident set size is the one of that
+ * simulation only. The nodes move by random waypoint in a square whose side
+ * grows with the square root of the node count, keeping the density constant,
+ * and --flows pairs exchange 64 byte UDP packets at --rate packets per second.
+ *
+ * One CSV row per simulation reports the setup and run wall clock times, the
+ * simulated events and events per wall clock second, the peak RSS, and the
+ * routing control bytes transmitted per data byte delivered. Control bytes
+ * are the IP sizes of the UDP packets to or from the routing protocol port,
+ * counted at every transmission including forwarding and rebroadcasts.
+ *
+ * ./ns3 run "raodv-scaling-benchmark --protocols=AODV,RAODV --nodes=20,100,500 --speeds=1,20"
+ */
+class ScalingBenchmark
+{
+  public:
+    ScalingBenchmark();
+    /**
+     * \brief Configure the benchmark
+     * \param argc is the command line argument count
+     * \param argv is the command line arguments
+     * \return true on successful configuration
+     */
+    bool Configure(int argc, char** argv);
+    /// Run the sweep and write the table
+    void Run();
+
+  private:
+    /// Cost and traffic of one simulation, sent back by its child process
+    struct Result
+    {
+        double setupSeconds;   ///< Wall clock time of the scenario setup
+        double runSeconds;     ///< Wall clock time of Simulator::Run
+        uint64_t events;       ///< Simulated events
+        long peakRssKb;        ///< Peak resident set size, kilobytes
+        uint64_t controlBytes; ///< Routing control bytes transmitted
+        uint64_t dataTxBytes;  ///< Data bytes sent by the sources
+        uint64_t dataRxBytes;  ///< Data bytes delivered to the sinks
+    };
+
+    // parameters
+    /// Comma-separated protocols
+    std::string m_protocols;
+    /// Comma-separated node counts
+    std::string m_nodes;
+    /// Comma-separated node speeds, m/s
+    std::string m_speeds;
+    /// Number of source/sink pairs
+    uint32_t m_flows;
+    /// Packets per second of every flow
+    uint32_t m_rate;
+    /// Simulation time, seconds
+    double m_totalTime;
+    /// Mean distance between neighboring nodes, meters
+    double m_spacing;
+    /// Run number of RngSeedManager
+    uint32_t m_run;
+    /// Write the table to this file besides stdout, if not empty
+    std::string m_output;
+
+    /// Control bytes of the running simulation
+    uint64_t m_controlBytes;
+    /// Data bytes sent in the running simulation
+    uint64_t m_dataTxBytes;
+
+    /**
+     * Simulate one sweep point
+     * \param protocol the routing protocol
+     * \param nodes the number of nodes
+     * \param speed the node speed, m/s
+     * \returns the cost and traffic of the simulation
+     */
+    Result RunOne(const std::string& protocol, uint32_t nodes, double speed);
+    /**
+     * Count a transmitted IP packet if it is a routing control packet
+     * \param packet the packet, with its IP header
+     * \param ipv4 the IP stack
+     * \param interface the output interface
+     */
+    void CountControl(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+    /**
+     * Count a data packet sent by a source
+     * \param packet the packet
+     */
+    void CountData(Ptr<const Packet> packet);
+};
+
+/**
+ * Split a comma-separated list.
+ * \param list The list.
+ * \return the non-empty items.
+ */
+static std::vector<std::string>
+SplitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+int
+main(int argc, char** argv)
+{
+    ScalingBenchmark bench;
+    if (!bench.Configure(argc, argv))
+    {
+        NS_FATAL_ERROR("Configuration failed. Aborted.");
+    }
+    bench.Run();
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+ScalingBenchmark::ScalingBenchmark()
+    : m_protocols("AODV,RAODV,OLSR,DSDV"),
+      m_nodes("20,50,100,200,500"),
+      m_speeds("1,20"),
+      m_flows(10),
+      m_rate(4),
+      m_totalTime(30),
+      m_spacing(100),
+      m_run(1),
+      m_output(""),
+      m_controlBytes(0),
+      m_dataTxBytes(0)
+{
+}
+
+bool
+ScalingBenchmark::Configure(int argc, char** argv)
+{
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("protocols",
+                 "Comma-separated protocols (AODV, RAODV, OLSR, DSDV).",
+                 m_protocols);
+    cmd.AddValue("nodes", "Comma-separated node counts.", m_nodes);
+    cmd.AddValue("speeds", "Comma-separated node speeds, m/s.", m_speeds);
+    cmd.AddValue("flows", "Number of source/sink pairs.", m_flows);
+    cmd.AddValue("rate", "Packets per second of every flow.", m_rate);
+    cmd.AddValue("time", "Simulation time, s.", m_totalTime);
+    cmd.AddValue("spacing", "Mean distance between neighboring nodes, m.", m_spacing);
+    cmd.AddValue("run", "Run number of the random number generator.", m_run);
+    cmd.AddValue("output", "Also write the table to this file.", m_output);
+    cmd.Parse(argc, argv);
+
+    for (const auto& protocol : SplitList(m_protocols))
+    {
+        if (protocol != "AODV" && protocol != "RAODV" && protocol != "OLSR" && protocol != "DSDV")
+        {
+            std::cerr << "No such protocol: " << protocol << std::endl;
+            return false;
+        }
+    }
+    return m_flows > 0 && m_rate > 0 && m_totalTime > 2;
+}
+
+void
+ScalingBenchmark::Run()
+{
+    std::ostringstream table;
+    table << "protocol,nodes,speed,sim_time_s,setup_wall_s,run_wall_s,events,events_per_s,"
+          << "peak_rss_kb,control_bytes,data_tx_bytes,data_rx_bytes,control_per_data_byte,pdr\n";
+    std::cout << table.str() << std::flush;
+
+    for (const auto& protocol : SplitList(m_protocols))
+    {
+        for (const auto& nodes : SplitList(m_nodes))
+        {
+            for (const auto& speed : SplitList(m_speeds))
+            {
+                uint32_t nodeCount = std::stoul(nodes);
+                if (nodeCount < 2 * m_flows)
+                {
+                    std::cerr << "Skipping " << nodeCount << " nodes, fewer than 2 * flows"
+                              << std::endl;
+                    continue;
+                }
+                // One child per simulation, so that every peak RSS is its own
+                int fds[2];
+                if (pipe(fds) != 0)
+                {
+                    NS_FATAL_ERROR("Could not create pipe for the simulation");
+                }
+                std::cout.flush();
+                pid_t pid = fork();
+                if (pid < 0)
+                {
+                    NS_FATAL_ERROR("Could not fork the simulation");
+                }
+                if (pid == 0)
+                {
+                    close(fds[0]);
+                    Result result = RunOne(protocol, nodeCount, std::stod(speed));
+                    ssize_t written = write(fds[1], &result, sizeof(result));
+                    close(fds[1]);
+                    _exit(written == sizeof(result) ? 0 : 1);
+                }
+                close(fds[1]);
+                int status;
+                waitpid(pid, &status, 0);
+                Result result;
+                bool done = WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                            read(fds[0], &result, sizeof(result)) == sizeof(result);
+                close(fds[0]);
+                if (!done)
+                {
+                    std::cerr << "Simulation " << protocol << " nodes=" << nodes
+                              << " speed=" << speed << " failed" << std::endl;
+                    continue;
+                }
+
+                std::ostringstream row;
+                row << protocol << "," << nodeCount << "," << speed << "," << m_totalTime << ","
+                    << result.setupSeconds << "," << result.runSeconds << "," << result.events
+                    << "," << (result.runSeconds > 0 ? result.events / result.runSeconds : 0)
+                    << "," << result.peakRssKb << "," << result.controlBytes << ","
+                    << result.dataTxBytes << "," << result.dataRxBytes << ","
+                    << (result.dataRxBytes ? double(result.controlBytes) / result.dataRxBytes
+                                           : 0)
+                    << ","
+                    << (result.dataTxBytes ? double(result.dataRxBytes) / result.dataTxBytes : 0)
+                    << "\n";
+                std::cout << row.str() << std::flush;
+                table << row.str();
+            }
+        }
+    }
+
+    if (!m_output.empty())
+    {
+        std::ofstream out(m_output);
+        out << table.str();
+    }
+}
+
+void
+ScalingBenchmark::CountControl(Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+    Ptr<Packet> copy = packet->Copy();
+    Ipv4Header ipHeader;
+    copy->RemoveHeader(ipHeader);
+    if (ipHeader.GetProtocol() != UdpL4Protocol::PROT_NUMBER)
+    {
+        return;
+    }
+    UdpHeader udpHeader;
+    copy->PeekHeader(udpHeader);
+    // AODV and raodv, OLSR, DSDV
+    for (uint16_t port : {654, 698, 269})
+    {
+        if (udpHeader.GetDestinationPort() == port || udpHeader.GetSourcePort() == port)
+        {
+            m_controlBytes += packet->GetSize();
+            return;
+        }
+    }
+}
+
+void
+ScalingBenchmark::CountData(Ptr<const Packet> packet)
+{
+    m_dataTxBytes += packet->GetSize();
+}
+
+ScalingBenchmark::Result
+ScalingBenchmark::RunOne(const std::string& protocol, uint32_t nodeCount, double speed)
+{
+    auto setupStart = std::chrono::steady_clock::now();
+    RngSeedManager::SetRun(m_run);
+    std::string phyMode("DsssRate11Mbps");
+    Config::SetDefault("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue(phyMode));
+
+    NodeContainer nodes;
+    nodes.Create(nodeCount);
+
+    WifiHelper wifi;
+    wifi.SetStandard(WIFI_STANDARD_80211b);
+    wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                 "DataMode",
+                                 StringValue(phyMode),
+                                 "ControlMode",
+                                 StringValue(phyMode));
+    YansWifiPhyHelper wifiPhy;
+    YansWifiChannelHelper wifiChannel;
+    wifiChannel.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
+    wifiChannel.AddPropagationLoss("ns3::FriisPropagationLossModel");
+    wifiPhy.SetChannel(wifiChannel.Create());
+    wifiPhy.Set("TxPowerStart", DoubleValue(15));
+    wifiPhy.Set("TxPowerEnd", DoubleValue(15));
+    WifiMacHelper wifiMac;
+    wifiMac.SetType("ns3::AdhocWifiMac");
+    NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, nodes);
+
+    double side = m_spacing * std::sqrt(double(nodeCount));
+    std::ostringstream range;
+    range << "ns3::UniformRandomVariable[Min=0.0|Max=" << side << "]";
+    ObjectFactory pos;
+    pos.SetTypeId("ns3::RandomRectanglePositionAllocator");
+    pos.Set("X", StringValue(range.str()));
+    pos.Set("Y", StringValue(range.str()));
+    Ptr<PositionAllocator> positions = pos.Create()->GetObject<PositionAllocator>();
+    int64_t stream = positions->AssignStreams(0);
+    std::ostringstream speedValue;
+    speedValue << "ns3::ConstantRandomVariable[Constant=" << speed << "]";
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::RandomWaypointMobilityModel",
+                              "Speed",
+                              StringValue(speedValue.str()),
+                              "Pause",
+                              StringValue("ns3::ConstantRandomVariable[Constant=0]"),
+                              "PositionAllocator",
+                              PointerValue(positions));
+    mobility.SetPositionAllocator(positions);
+    mobility.Install(nodes);
+    stream += mobility.AssignStreams(nodes, stream);
+
+    AodvHelper aodv;
+    RaodvHelper raodv;
+    OlsrHelper olsr;
+    DsdvHelper dsdv;
+    InternetStackHelper internet;
+    if (protocol == "AODV")
+    {
+        internet.SetRoutingHelper(aodv);
+    }
+    else if (protocol == "RAODV")
+    {
+        internet.SetRoutingHelper(raodv);
+    }
+    else if (protocol == "OLSR")
+    {
+        internet.SetRoutingHelper(olsr);
+    }
+    else
+    {
+        internet.SetRoutingHelper(dsdv);
+    }
+    internet.Install(nodes);
+    Ipv4AddressHelper address;
+    address.SetBase("10.0.0.0", "255.0.0.0");
+    Ipv4InterfaceContainer interfaces = address.Assign(devices);
+
+    uint16_t port = 9;
+    PacketSinkHelper sinkHelper("ns3::UdpSocketFactory",
+                                InetSocketAddress(Ipv4Address::GetAny(), port));
+    OnOffHelper onoff("ns3::UdpSocketFactory", Address());
+    onoff.SetAttribute("OnTime", StringValue("ns3::ConstantRandomVariable[Constant=1.0]"));
+    onoff.SetAttribute("OffTime", StringValue("ns3::ConstantRandomVariable[Constant=0.0]"));
+    onoff.SetAttribute("PacketSize", UintegerValue(64));
+    onoff.SetAttribute("DataRate", DataRateValue(DataRate(m_rate * 64 * 8)));
+    ApplicationContainer sinks;
+    ApplicationContainer sources;
+    Ptr<UniformRandomVariable> start = CreateObject<UniformRandomVariable>();
+    for (uint32_t i = 0; i < m_flows; i++)
+    {
+        sinks.Add(sinkHelper.Install(nodes.Get(i)));
+        onoff.SetAttribute("Remote",
+                           AddressValue(InetSocketAddress(interfaces.GetAddress(i), port)));
+        ApplicationContainer source = onoff.Install(nodes.Get(nodeCount - 1 - i));
+        source.Start(Seconds(start->GetValue(1.0, 2.0)));
+        source.Get(0)->TraceConnectWithoutContext(
+            "Tx",
+            MakeCallback(&ScalingBenchmark::CountData, this));
+        sources.Add(source);
+    }
+    sinks.Start(Seconds(0));
+    sources.Stop(Seconds(m_totalTime));
+
+    m_controlBytes = 0;
+    m_dataTxBytes = 0;
+    Config::ConnectWithoutContext("/NodeList/*/$ns3::Ipv4L3Protocol/Tx",
+                                  MakeCallback(&ScalingBenchmark::CountControl, this));
+
+    Simulator::Stop(Seconds(m_totalTime));
+    auto runStart = std::chrono::steady_clock::now();
+    Simulator::Run();
+    auto runEnd = std::chrono::steady_clock::now();
+
+    Result result;
+    result.setupSeconds = std::chrono::duration<double>(runStart - setupStart).count();
+    result.runSeconds = std::chrono::duration<double>(runEnd - runStart).count();
+    result.events = Simulator::GetEventCount();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.peakRssKb = usage.ru_maxrss;
+    result.controlBytes = m_controlBytes;
+    result.dataTxBytes = m_dataTxBytes;
+    result.dataRxBytes = 0;
+    for (uint32_t i = 0; i < sinks.GetN(); i++)
+    {
+        result.dataRxBytes += DynamicCast<PacketSink>(sinks.Get(i))->GetTotalRx();
+    }
+    Simulator::Destroy();
+    return result;
+}
@@ -9,10 +9,14 @@
 #include "raodv-helper.h"
 
 #include "ns3/raodv-routing-protocol.h"
+#include "ns3/abort.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/names.h"
 #include "ns3/node-list.h"
 #include "ns3/ptr.h"
+#include "ns3/simulator.h"
+
+#include <fstream>
 
 namespace ns3
 {
@@ -83,4 +87,82 @@ RaodvHelper::AssignStreams(NodeContainer c, int64_t stream)
     return (currentStream - stream);
 }
 
+void
+RaodvHelper::DumpStatistics(NodeContainer c, std::string prefix) const
+{
+    static const char* const typeNames[] = {"", "rreq", "rrep", "rerr", "rrep_ack", "r_rreq"};
+    static const char* const eventNames[] = {"sent", "received", "suppressed"};
+
+    std::ofstream stats(prefix + "-stats.csv");
+    std::ofstream histograms(prefix + "-histograms.csv");
+    NS_ABORT_MSG_UNLESS(stats && histograms, "Cannot write statistics with prefix " << prefix);
+
+    stats << "node";
+    for (uint32_t type = raodv::RAODVTYPE_RREQ; type <= raodv::RAODVTYPE_R_RREQ; type++)
+    {
+        for (uint32_t event = 0; event < raodv::RoutingProtocol::MESSAGE_EVENTS; event++)
+        {
+            stats << "," << typeNames[type] << "_" << eventNames[event];
+        }
+    }
+    stats << ",duplicate_checks,duplicate_hits,duplicate_hit_rate";
+    for (uint32_t reason = 0; reason < raodv::RequestQueue::DROP_REASONS; reason++)
+    {
+        stats << ",drop_"
+              << raodv::RequestQueue::GetDropReasonName(raodv::RequestQueue::DropReason(reason));
+    }
+    stats << ",discoveries,mean_discovery_latency_s,queued_sent,mean_queue_wait_s"
+          << ",routing_table_size\n";
+    histograms << "node,histogram,bin_start_s,count\n";
+
+    for (auto i = c.Begin(); i != c.End(); ++i)
+    {
+        Ptr<raodv::RoutingProtocol> raodv = (*i)->GetObject<raodv::RoutingProtocol>();
+        // Under the distributed simulator, the nodes of the other ranks did not run here
+        if (!raodv || (*i)->GetSystemId() != Simulator::GetSystemId())
+        {
+            continue;
+        }
+        const raodv::RoutingProtocol::Statistics& s = raodv->GetStatistics();
+        uint32_t id = (*i)->GetId();
+        stats << id;
+        for (uint32_t type = raodv::RAODVTYPE_RREQ; type <= raodv::RAODVTYPE_R_RREQ; type++)
+        {
+            for (uint32_t event = 0; event < raodv::RoutingProtocol::MESSAGE_EVENTS; event++)
+            {
+                stats << "," << s.m_messages[type][event];
+            }
+        }
+        stats << "," << s.m_duplicateChecks << "," << s.m_duplicateHits << ","
+              << (s.m_duplicateChecks ? double(s.m_duplicateHits) / s.m_duplicateChecks : 0);
+        for (uint32_t reason = 0; reason < raodv::RequestQueue::DROP_REASONS; reason++)
+        {
+            stats << ","
+                  << raodv->GetQueueDropCount(raodv::RequestQueue::DropReason(reason));
+        }
+        stats << "," << s.m_discoveries << ","
+              << (s.m_discoveries ? s.m_discoveryLatencySum.GetSeconds() / s.m_discoveries : 0)
+              << "," << s.m_queuedSent << ","
+              << (s.m_queuedSent ? s.m_queueWaitSum.GetSeconds() / s.m_queuedSent : 0) << ","
+              << raodv->GetRoutingTableSize() << "\n";
+
+        // Histogram has no const bin accessors, so work on copies
+        std::pair<const char*, Histogram> hists[] = {
+            {"discovery_latency", s.m_discoveryLatency},
+            {"queue_wait", s.m_queueWait},
+        };
+        for (auto& h : hists)
+        {
+            for (uint32_t bin = 0; bin < h.second.GetNBins(); bin++)
+            {
+                if (h.second.GetBinCount(bin) > 0)
+                {
+                    histograms << id << "," << h.first << "," << h.second.GetBinStart(bin) << ","
+                               << h.second.GetBinCount(bin) << "\n";
+                }
+            }
+        }
+    }
+}
+
 } // namespace ns3
@@ -63,6 +63,16 @@ class RaodvHelper : public Ipv4RoutingHelper
      * \return the number of stream indices assigned by this helper
      */
     int64_t AssignStreams(NodeContainer c, int64_t stream);
+    /**
+     * Write the raodv statistics of the nodes as CSV, typically at the end of a run.
+     *
+     * \param c NodeContainer of the nodes to report; nodes without raodv and, under the
+     *        distributed simulator, nodes of the other ranks are skipped, so every rank
+     *        should be given its own prefix
+     * \param prefix file name prefix; the counters go to \<prefix\>-stats.csv and
+     *        the histogram bins to \<prefix\>-histograms.csv
+     */
+    void DumpStatistics(NodeContainer c, std::string prefix) const;
 
   private:
     /** the factory to create raodv routing object */
@@ -15,32 +15,65 @@
  */
 #include "raodv-id-cache.h"
 
-#include <algorithm>
-
 namespace ns3
 {
 namespace raodv
 {
 bool
 IdCache::IsDuplicate(Ipv4Address addr, uint32_t id)
+{
+    return IsDuplicate(MakeKey(addr, id));
+}
+
+bool
+IdCache::Contains(Ipv4Address addr, uint32_t id)
+{
+    return Contains(MakeKey(addr, id));
+}
+
+bool
+IdCache::IsDuplicate(Ipv4Address addr, Ipv4Address dst, uint32_t id)
+{
+    return IsDuplicate(MakeKey(addr, dst, id));
+}
+
+bool
+IdCache::Contains(Ipv4Address addr, Ipv4Address dst, uint32_t id)
+{
+    return Contains(MakeKey(addr, dst, id));
+}
+
+bool
+IdCache::IsDuplicate(const Key& key)
 {
     Purge();
-    for (auto i = m_idCache.begin(); i != m_idCache.end(); ++i)
+    if (m_idCache.find(key) != m_idCache.end())
     {
-        if (i->m_context == addr && i->m_id == id)
-        {
-            return true;
-        }
+        return true;
     }
-    UniqueId uniqueId = {addr, id, m_lifetime + Simulator::Now()};
-    m_idCache.push_back(uniqueId);
+    Time expire = m_lifetime + Simulator::Now();
+    m_idCache.insert(key);
+    m_expiry.emplace(expire, key);
     return false;
 }
 
+bool
+IdCache::Contains(const Key& key)
+{
+    Purge();
+    return m_idCache.find(key) != m_idCache.end();
+}
+
 void
 IdCache::Purge()
 {
-    m_idCache.erase(remove_if(m_idCache.begin(), m_idCache.end(), IsExpired()), m_idCache.end());
+    // Records are never refreshed, so each key has exactly one heap entry
+    Time now = Simulator::Now();
+    while (!m_expiry.empty() && m_expiry.top().first < now)
+    {
+        m_idCache.erase(m_expiry.top().second);
+        m_expiry.pop();
+    }
 }
 
 uint32_t
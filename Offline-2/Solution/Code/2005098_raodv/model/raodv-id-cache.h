@@ -20,6 +20,10 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/simulator.h"
 
+#include <functional>
+#include <queue>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -30,6 +34,10 @@ namespace raodv
  * \ingroup raodv
  *
  * \brief Unique packets identification cache used for simple duplicate detection.
+ *
+ * Records are hashed on (address, id) so a lookup is O(1). A min-heap ordered by
+ * expiration time lets Purge() pop only the records that have actually expired,
+ * instead of sweeping the whole cache on every lookup.
  */
 class IdCache
 {
@@ -50,6 +58,29 @@ class IdCache
      * \returns true if the pair exists
      */
     bool IsDuplicate(Ipv4Address addr, uint32_t id);
+    /**
+     * Check that entry (addr, id) exists in cache, without adding it.
+     * \param addr the IP address
+     * \param id the cache entry ID
+     * \returns true if the pair exists
+     */
+    bool Contains(Ipv4Address addr, uint32_t id);
+    /**
+     * Check that entry (addr, dst, id) exists in cache. Add entry, if it doesn't exist.
+     * \param addr the IP address
+     * \param dst the second IP address of the entry
+     * \param id the cache entry ID
+     * \returns true if the triple exists
+     */
+    bool IsDuplicate(Ipv4Address addr, Ipv4Address dst, uint32_t id);
+    /**
+     * Check that entry (addr, dst, id) exists in cache, without adding it.
+     * \param addr the IP address
+     * \param dst the second IP address of the entry
+     * \param id the cache entry ID
+     * \returns true if the triple exists
+     */
+    bool Contains(Ipv4Address addr, Ipv4Address dst, uint32_t id);
     /// Remove all expired entries
     void Purge();
     /**
@@ -76,36 +107,69 @@ class IdCache
     }
 
   private:
-    /// Unique packet ID
-    struct UniqueId
-    {
-        /// ID is supposed to be unique in single address context (e.g. sender address)
-        Ipv4Address m_context;
-        /// The id
-        uint32_t m_id;
-        /// When record will expire
-        Time m_expire;
-    };
-
     /**
-     * \brief IsExpired structure
+     * Key of a record: the two 32 bit fields packed in the first member, and the ID of
+     * an (addr, dst, id) record, or 0, in the second one.
      */
-    struct IsExpired
+    typedef std::pair<uint64_t, uint32_t> Key;
+
+    /// Hash of a Key
+    struct KeyHash
     {
         /**
-         * \brief Check if the entry is expired
-         *
-         * \param u UniqueId entry
-         * \return true if expired, false otherwise
+         * \param key the key
+         * \returns the hash of the key
          */
-        bool operator()(const UniqueId& u) const
+        std::size_t operator()(const Key& key) const
         {
-            return (u.m_expire < Simulator::Now());
+            return std::hash<uint64_t>()(key.first ^ (static_cast<uint64_t>(key.second) << 16));
         }
     };
 
+    /**
+     * Build the key of an (addr, id) record: the address in the upper 32 bits and the
+     * ID, which is supposed to be unique in single address context, in the lower ones.
+     * \param addr the IP address
+     * \param id the cache entry ID
+     * \returns the key
+     */
+    static Key MakeKey(Ipv4Address addr, uint32_t id)
+    {
+        return Key((static_cast<uint64_t>(addr.Get()) << 32) | id, 0);
+    }
+
+    /**
+     * Build the key of an (addr, dst, id) record.
+     * \param addr the IP address
+     * \param dst the second IP address of the entry
+     * \param id the cache entry ID
+     * \returns the key
+     */
+    static Key MakeKey(Ipv4Address addr, Ipv4Address dst, uint32_t id)
+    {
+        return Key(MakeKey(addr, dst.Get()).first, id);
+    }
+
+    /**
+     * Check that the record exists in cache. Add it, if it doesn't exist.
+     * \param key the key of the record
+     * \returns true if the record exists
+     */
+    bool IsDuplicate(const Key& key);
+    /**
+     * Check that the record exists in cache, without adding it.
+     * \param key the key of the record
+     * \returns true if the record exists
+     */
+    bool Contains(const Key& key);
+
+    /// Expiration time and key of a record, ordered by expiration time
+    typedef std::pair<Time, Key> Expiry;
+
     /// Already seen IDs
-    std::vector<UniqueId> m_idCache;
+    std::unordered_set<Key, KeyHash> m_idCache;
+    /// Records ordered by expiration time, earliest first
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> m_expiry;
     /// Default lifetime for ID records
     Time m_lifetime;
 };
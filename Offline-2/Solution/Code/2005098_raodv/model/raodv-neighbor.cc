@@ -29,7 +29,8 @@ NS_LOG_COMPONENT_DEFINE("RaodvNeighbors");
 namespace raodv
 {
 Neighbors::Neighbors(Time delay)
-    : m_ntimer(Timer::CANCEL_ON_DESTROY)
+    : m_ntimer(Timer::CANCEL_ON_DESTROY),
+      m_changes(0)
 {
     m_ntimer.SetDelay(delay);
     m_ntimer.SetFunction(&Neighbors::Purge, this);
@@ -40,26 +41,17 @@ bool
 Neighbors::IsNeighbor(Ipv4Address addr)
 {
     Purge();
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
-    {
-        if (i->m_neighborAddress == addr)
-        {
-            return true;
-        }
-    }
-    return false;
+    return m_nb.find(addr) != m_nb.end();
 }
 
 Time
 Neighbors::GetExpireTime(Ipv4Address addr)
 {
     Purge();
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    auto i = m_nb.find(addr);
+    if (i != m_nb.end())
     {
-        if (i->m_neighborAddress == addr)
-        {
-            return (i->m_expireTime - Simulator::Now());
-        }
+        return (i->second.m_expireTime - Simulator::Now());
     }
     return Seconds(0);
 }
@@ -67,41 +59,39 @@ Neighbors::GetExpireTime(Ipv4Address addr)
 void
 Neighbors::Update(Ipv4Address addr, Time expire)
 {
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    auto i = m_nb.find(addr);
+    if (i != m_nb.end())
     {
-        if (i->m_neighborAddress == addr)
+        Neighbor& nb = i->second;
+        if (expire + Simulator::Now() > nb.m_expireTime)
+        {
+            // The timer is left as is: if it fires early, Purge() rearms it
+            m_expiry.erase(std::make_pair(nb.m_expireTime, addr));
+            nb.m_expireTime = expire + Simulator::Now();
+            m_expiry.insert(std::make_pair(nb.m_expireTime, addr));
+        }
+        if (nb.m_hardwareAddress == Mac48Address())
         {
-            i->m_expireTime = std::max(expire + Simulator::Now(), i->m_expireTime);
-            if (i->m_hardwareAddress == Mac48Address())
+            nb.m_hardwareAddress = LookupMacAddress(nb.m_neighborAddress);
+            if (nb.m_hardwareAddress != Mac48Address())
             {
-                i->m_hardwareAddress = LookupMacAddress(i->m_neighborAddress);
+                m_macIndex.insert(std::make_pair(GetMacKey(nb.m_hardwareAddress), addr));
             }
-            return;
         }
+        return;
     }
 
     NS_LOG_LOGIC("Open link to " << addr);
+    m_changes++;
     Neighbor neighbor(addr, LookupMacAddress(addr), expire + Simulator::Now());
-    m_nb.push_back(neighbor);
-    Purge();
-}
-
-/**
- * \brief CloseNeighbor structure
- */
-struct CloseNeighbor
-{
-    /**
-     * Check if the entry is expired
-     *
-     * \param nb Neighbors::Neighbor entry
-     * \return true if expired, false otherwise
-     */
-    bool operator()(const Neighbors::Neighbor& nb) const
+    m_nb.insert(std::make_pair(addr, neighbor));
+    m_expiry.insert(std::make_pair(neighbor.m_expireTime, addr));
+    if (neighbor.m_hardwareAddress != Mac48Address())
     {
-        return ((nb.m_expireTime < Simulator::Now()) || nb.close);
+        m_macIndex.insert(std::make_pair(GetMacKey(neighbor.m_hardwareAddress), addr));
     }
-};
+    Purge();
+}
 
 void
 Neighbors::Purge()
@@ -111,21 +101,33 @@ Neighbors::Purge()
         return;
     }
 
-    CloseNeighbor pred;
+    std::vector<Ipv4Address> lost;
+    lost.swap(m_closed);
+    Time now = Simulator::Now();
+    for (auto i = m_expiry.begin(); i != m_expiry.end() && i->first < now; ++i)
+    {
+        if (!m_nb.find(i->second)->second.close)
+        {
+            lost.push_back(i->second);
+        }
+    }
     if (!m_handleLinkFailure.IsNull())
     {
-        for (auto j = m_nb.begin(); j != m_nb.end(); ++j)
+        for (auto j = lost.begin(); j != lost.end(); ++j)
         {
-            if (pred(*j))
-            {
-                NS_LOG_LOGIC("Close link to " << j->m_neighborAddress);
-                m_handleLinkFailure(j->m_neighborAddress);
-            }
+            NS_LOG_LOGIC("Close link to " << *j);
+            m_handleLinkFailure(*j);
         }
     }
-    m_nb.erase(std::remove_if(m_nb.begin(), m_nb.end(), pred), m_nb.end());
+    for (auto j = lost.begin(); j != lost.end(); ++j)
+    {
+        Erase(*j);
+    }
     m_ntimer.Cancel();
-    m_ntimer.Schedule();
+    if (!m_expiry.empty())
+    {
+        ScheduleExpiry(m_expiry.begin()->first);
+    }
 }
 
 void
@@ -135,6 +137,82 @@ Neighbors::ScheduleTimer()
     m_ntimer.Schedule();
 }
 
+void
+Neighbors::ScheduleExpiry(Time expire)
+{
+    // A neighbor is lost once its expire time is strictly in the past
+    Time delay = expire - Simulator::Now() + TimeStep(1);
+    if (m_ntimer.IsRunning() && m_ntimer.GetDelayLeft() <= delay)
+    {
+        return;
+    }
+    m_ntimer.Cancel();
+    m_ntimer.Schedule(delay);
+}
+
+void
+Neighbors::Erase(Ipv4Address addr)
+{
+    auto i = m_nb.find(addr);
+    if (i == m_nb.end())
+    {
+        return;
+    }
+    m_expiry.erase(std::make_pair(i->second.m_expireTime, addr));
+    if (i->second.m_hardwareAddress != Mac48Address())
+    {
+        auto range = m_macIndex.equal_range(GetMacKey(i->second.m_hardwareAddress));
+        for (auto j = range.first; j != range.second; ++j)
+        {
+            if (j->second == addr)
+            {
+                m_macIndex.erase(j);
+                break;
+            }
+        }
+    }
+    m_nb.erase(i);
+    m_changes++;
+}
+
+uint64_t
+Neighbors::GetMacKey(Mac48Address addr)
+{
+    uint8_t buf[6];
+    addr.CopyTo(buf);
+    uint64_t key = 0;
+    for (uint8_t i = 0; i < 6; ++i)
+    {
+        key = (key << 8) | buf[i];
+    }
+    return key;
+}
+
+void
+Neighbors::UpdateSnr(Ipv4Address addr, double snr)
+{
+    auto i = m_snr.find(addr);
+    if (i == m_snr.end())
+    {
+        m_snr.insert(std::make_pair(addr, snr));
+        return;
+    }
+    i->second = 0.875 * i->second + 0.125 * snr;
+}
+
+uint16_t
+Neighbors::GetLinkCost(Ipv4Address addr) const
+{
+    auto i = m_snr.find(addr);
+    if (i == m_snr.end())
+    {
+        return LINK_COST_UNIT;
+    }
+    double poorness = (GOOD_SNR - i->second) / (GOOD_SNR - POOR_SNR);
+    poorness = std::min(1.0, std::max(0.0, poorness));
+    return LINK_COST_UNIT * (1 + (MAX_LINK_TRANSMISSIONS - 1) * poorness);
+}
+
 void
 Neighbors::AddArpCache(Ptr<ArpCache> a)
 {
@@ -168,11 +246,19 @@ Neighbors::ProcessTxError(const WifiMacHeader& hdr)
 {
     Mac48Address addr = hdr.GetAddr1();
 
-    for (auto i = m_nb.begin(); i != m_nb.end(); ++i)
+    auto range = m_macIndex.equal_range(GetMacKey(addr));
+    for (auto i = range.first; i != range.second; ++i)
     {
-        if (i->m_hardwareAddress == addr)
+        auto snr = m_snr.find(i->second);
+        if (snr != m_snr.end())
+        {
+            UpdateSnr(i->second, POOR_SNR);
+        }
+        Neighbor& nb = m_nb.find(i->second)->second;
+        if (!nb.close)
         {
-            i->close = true;
+            nb.close = true;
+            m_closed.push_back(i->second);
         }
     }
     Purge();
@@ -23,6 +23,9 @@
 #include "ns3/simulator.h"
 #include "ns3/timer.h"
 
+#include <set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -38,13 +41,17 @@ class RoutingProtocol;
 /**
  * \ingroup raodv
  * \brief maintain list of active neighbors
+ *
+ * Neighbors are hashed by IPv4 address and by MAC address, and ordered by
+ * expire time. The purge timer is armed for the earliest expire time, so
+ * that a purge only visits the neighbors that are actually lost.
  */
 class Neighbors
 {
   public:
     /**
      * constructor
-     * \param delay the delay time for purging the list of neighbors
+     * \param delay the delay time for the first purge scheduled by ScheduleTimer()
      */
     Neighbors(Time delay);
 
@@ -99,12 +106,55 @@ class Neighbors
     /// Schedule m_ntimer.
     void ScheduleTimer();
 
+    /**
+     * Get the number of changes of the neighbor set. It grows whenever a neighbor is added
+     * or removed, so two equal values mean the neighbor set did not change in between.
+     * \returns the change count
+     */
+    uint32_t GetChangeCount() const
+    {
+        return m_changes;
+    }
+
     /// Remove all entries
     void Clear()
     {
+        if (!m_nb.empty())
+        {
+            m_changes++;
+        }
         m_nb.clear();
+        m_expiry.clear();
+        m_macIndex.clear();
+        m_closed.clear();
+        m_snr.clear();
     }
 
+    /// Cost of a link needing a single transmission per packet
+    static constexpr uint16_t LINK_COST_UNIT = 16;
+    /// Smoothed SNR (dB) above which a link needs a single transmission
+    static constexpr double GOOD_SNR = 20;
+    /// Smoothed SNR (dB) at and below which a link costs MAX_LINK_TRANSMISSIONS
+    static constexpr double POOR_SNR = 5;
+    /// Expected transmissions per packet of the poorest links
+    static constexpr double MAX_LINK_TRANSMISSIONS = 8;
+
+    /**
+     * Record the SNR of a packet received from a node. The SNR of every node is smoothed by
+     * an exponentially weighted moving average.
+     * \param addr the IP address of the sender
+     * \param snr the SNR in dB
+     */
+    void UpdateSnr(Ipv4Address addr, double snr);
+    /**
+     * Get the ETX-like cost of the link to a node: LINK_COST_UNIT per expected transmission,
+     * from the smoothed SNR, growing linearly from GOOD_SNR down to POOR_SNR. Layer 2
+     * transmission failures count as POOR_SNR samples.
+     * \param addr the IP address of the node
+     * \returns the link cost, LINK_COST_UNIT if no SNR was recorded
+     */
+    uint16_t GetLinkCost(Ipv4Address addr) const;
+
     /**
      * Add ARP cache to be used to allow layer 2 notifications processing
      * \param a pointer to the ARP cache to add
@@ -148,12 +198,25 @@ class Neighbors
     Callback<void, Ipv4Address> m_handleLinkFailure;
     /// TX error callback
     Callback<void, const WifiMacHeader&> m_txErrorCallback;
-    /// Timer for neighbor's list. Schedule Purge().
+    /// Expire time and address of a neighbor
+    typedef std::pair<Time, Ipv4Address> Expiry;
+
+    /// Timer for neighbor's list. Schedule Purge() at the earliest expire time.
     Timer m_ntimer;
-    /// vector of entries
-    std::vector<Neighbor> m_nb;
+    /// Entries, keyed by neighbor IPv4 address
+    std::unordered_map<Ipv4Address, Neighbor, Ipv4AddressHash> m_nb;
+    /// Entries ordered by expire time, the earliest first
+    std::set<Expiry> m_expiry;
+    /// Neighbor IPv4 addresses, keyed by hardware address
+    std::unordered_multimap<uint64_t, Ipv4Address> m_macIndex;
+    /// Neighbors marked as closed by layer 2 notifications
+    std::vector<Ipv4Address> m_closed;
     /// list of ARP cached to be used for layer 2 notifications processing
     std::vector<Ptr<ArpCache>> m_arp;
+    /// Number of additions and removals of neighbors
+    uint32_t m_changes;
+    /// Smoothed SNR of the packets received from every node, kept when the neighbor is lost
+    std::unordered_map<Ipv4Address, double, Ipv4AddressHash> m_snr;
 
     /**
      * Find MAC address by IP using list of ARP caches
@@ -167,6 +230,22 @@ class Neighbors
      * \param hdr header of the packet
      */
     void ProcessTxError(const WifiMacHeader& hdr);
+    /**
+     * Get the key of a hardware address in m_macIndex
+     * \param addr the MAC address
+     * \returns the key
+     */
+    static uint64_t GetMacKey(Mac48Address addr);
+    /**
+     * Arm m_ntimer for given expire time, unless it already expires earlier
+     * \param expire the absolute expire time
+     */
+    void ScheduleExpiry(Time expire);
+    /**
+     * Remove entry from all indexes
+     * \param addr the IP address of the neighbor node
+     */
+    void Erase(Ipv4Address addr);
 };
 
 } // namespace raodv
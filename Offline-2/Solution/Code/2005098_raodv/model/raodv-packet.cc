@@ -17,6 +17,7 @@
 
 #include "ns3/address-utils.h"
 #include "ns3/packet.h"
+#include "ns3/socket.h"
 
 namespace ns3
 {
@@ -145,7 +146,8 @@ RreqHeader::RreqHeader(uint8_t flags,
       m_dst(dst),
       m_dstSeqNo(dstSeqNo),
       m_origin(origin),
-      m_originSeqNo(originSeqNo)
+      m_originSeqNo(originSeqNo),
+      m_cost(0)
 {
 }
 
@@ -170,7 +172,7 @@ RreqHeader::GetInstanceTypeId() const
 uint32_t
 RreqHeader::GetSerializedSize() const
 {
-    return 23;
+    return 23 + 13 * m_destinations.size() + (HasCost() ? 2 : 0);
 }
 
 void
@@ -184,6 +186,17 @@ RreqHeader::Serialize(Buffer::Iterator i) const
     i.WriteHtonU32(m_dstSeqNo);
     WriteTo(i, m_origin);
     i.WriteHtonU32(m_originSeqNo);
+    for (auto j = m_destinations.begin(); j != m_destinations.end(); ++j)
+    {
+        WriteTo(i, j->m_dst);
+        i.WriteHtonU32(j->m_id);
+        i.WriteHtonU32(j->m_dstSeqNo);
+        i.WriteU8(j->m_unknownSeqNo ? (1 << 3) : 0);
+    }
+    if (HasCost())
+    {
+        i.WriteHtonU16(m_cost);
+    }
 }
 
 uint32_t
@@ -198,6 +211,17 @@ RreqHeader::Deserialize(Buffer::Iterator start)
     m_dstSeqNo = i.ReadNtohU32();
     ReadFrom(i, m_origin);
     m_originSeqNo = i.ReadNtohU32();
+    m_destinations.clear();
+    for (uint8_t k = 0; k < m_reserved; ++k)
+    {
+        Destination d;
+        ReadFrom(i, d.m_dst);
+        d.m_id = i.ReadNtohU32();
+        d.m_dstSeqNo = i.ReadNtohU32();
+        d.m_unknownSeqNo = (i.ReadU8() & (1 << 3));
+        m_destinations.push_back(d);
+    }
+    m_cost = HasCost() ? i.ReadNtohU16() : 0;
 
     uint32_t dist = i.GetDistanceFrom(start);
     NS_ASSERT(dist == GetSerializedSize());
@@ -212,6 +236,11 @@ RreqHeader::Print(std::ostream& os) const
        << " flags:"
        << " Gratuitous RREP " << (*this).GetGratuitousRrep() << " Destination only "
        << (*this).GetDestinationOnly() << " Unknown sequence number " << (*this).GetUnknownSeqno();
+    for (auto j = m_destinations.begin(); j != m_destinations.end(); ++j)
+    {
+        os << " also destination: ipv4 " << j->m_dst << " RREQ ID " << j->m_id
+           << " sequence number " << j->m_dstSeqNo << " unknown " << j->m_unknownSeqNo;
+    }
 }
 
 std::ostream&
@@ -278,12 +307,58 @@ RreqHeader::GetUnknownSeqno() const
     return (m_flags & (1 << 3));
 }
 
+bool
+RreqHeader::AddDestination(const Destination& dst)
+{
+    if (m_destinations.size() == 255)
+    {
+        return false;
+    }
+    m_destinations.push_back(dst);
+    m_reserved = m_destinations.size();
+    return true;
+}
+
+void
+RreqHeader::ClearDestinations()
+{
+    m_destinations.clear();
+    m_reserved = 0;
+}
+
+void
+RreqHeader::SetCost(uint16_t cost)
+{
+    m_flags |= (1 << 2);
+    m_cost = cost;
+}
+
+bool
+RreqHeader::HasCost() const
+{
+    return (m_flags & (1 << 2));
+}
+
 bool
 RreqHeader::operator==(const RreqHeader& o) const
 {
+    if (m_destinations.size() != o.m_destinations.size())
+    {
+        return false;
+    }
+    for (uint32_t k = 0; k < m_destinations.size(); ++k)
+    {
+        const Destination& a = m_destinations[k];
+        const Destination& b = o.m_destinations[k];
+        if (a.m_dst != b.m_dst || a.m_id != b.m_id || a.m_dstSeqNo != b.m_dstSeqNo ||
+            a.m_unknownSeqNo != b.m_unknownSeqNo)
+        {
+            return false;
+        }
+    }
     return (m_flags == o.m_flags && m_reserved == o.m_reserved && m_hopCount == o.m_hopCount &&
             m_requestID == o.m_requestID && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo &&
-            m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo);
+            m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo && m_cost == o.m_cost);
 }
 
 
@@ -464,7 +539,8 @@ RrepHeader::RrepHeader(uint8_t prefixSize,
       m_hopCount(hopCount),
       m_dst(dst),
       m_dstSeqNo(dstSeqNo),
-      m_origin(origin)
+      m_origin(origin),
+      m_cost(0)
 {
     m_lifeTime = uint32_t(lifeTime.GetMilliSeconds());
 }
@@ -490,7 +566,7 @@ RrepHeader::GetInstanceTypeId() const
 uint32_t
 RrepHeader::GetSerializedSize() const
 {
-    return 19;
+    return HasCost() ? 21 : 19;
 }
 
 void
@@ -503,6 +579,10 @@ RrepHeader::Serialize(Buffer::Iterator i) const
     i.WriteHtonU32(m_dstSeqNo);
     WriteTo(i, m_origin);
     i.WriteHtonU32(m_lifeTime);
+    if (HasCost())
+    {
+        i.WriteHtonU16(m_cost);
+    }
 }
 
 uint32_t
@@ -517,6 +597,7 @@ RrepHeader::Deserialize(Buffer::Iterator start)
     m_dstSeqNo = i.ReadNtohU32();
     ReadFrom(i, m_origin);
     m_lifeTime = i.ReadNtohU32();
+    m_cost = HasCost() ? i.ReadNtohU16() : 0;
 
     uint32_t dist = i.GetDistanceFrom(start);
     NS_ASSERT(dist == GetSerializedSize());
@@ -584,7 +665,20 @@ RrepHeader::operator==(const RrepHeader& o) const
 {
     return (m_flags == o.m_flags && m_prefixSize == o.m_prefixSize && m_hopCount == o.m_hopCount &&
             m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo && m_origin == o.m_origin &&
-            m_lifeTime == o.m_lifeTime);
+            m_lifeTime == o.m_lifeTime && m_cost == o.m_cost);
+}
+
+void
+RrepHeader::SetCost(uint16_t cost)
+{
+    m_flags |= (1 << 5);
+    m_cost = cost;
+}
+
+bool
+RrepHeader::HasCost() const
+{
+    return (m_flags & (1 << 5));
 }
 
 void
@@ -834,5 +928,23 @@ operator<<(std::ostream& os, const RerrHeader& h)
     h.Print(os);
     return os;
 }
+
+ControlMessage::ControlMessage(const Header& header, MessageType type)
+    : m_wire(Create<Packet>())
+{
+    m_wire->AddHeader(header);
+    m_wire->AddHeader(TypeHeader(type));
+}
+
+Ptr<Packet>
+ControlMessage::CreatePacket(uint8_t ttl) const
+{
+    Ptr<Packet> packet = m_wire->Copy();
+    SocketIpTtlTag tag;
+    tag.SetTtl(ttl);
+    packet->AddPacketTag(tag);
+    return packet;
+}
+
 } // namespace raodv
 } // namespace ns3
@@ -20,9 +20,11 @@
 #include "ns3/header.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
+#include "ns3/packet.h"
 
 #include <iostream>
 #include <map>
+#include <vector>
 
 namespace ns3
 {
@@ -122,11 +124,30 @@ std::ostream& operator<<(std::ostream& os, const TypeHeader& h);
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                  Originator Sequence Number                   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |  Additional Destinations (optional), 13 octets each:          |
+  |  Destination IP Address, RREQ ID, Destination Sequence Number |
+  |  and a flags octet carrying the U flag                        |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |      Path Cost (optional)     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+
+  The Reserved octet following the flags holds the number of additional destinations, so a
+  RREQ searching a single destination is the plain RFC message. The path cost is present if
+  the C flag, following the U flag, is set.
 */
 class RreqHeader : public Header
 {
   public:
+    /// An additional destination searched by the same RREQ
+    struct Destination
+    {
+        Ipv4Address m_dst;   ///< Destination IP Address
+        uint32_t m_id;       ///< RREQ ID used for this destination
+        uint32_t m_dstSeqNo; ///< Destination Sequence Number
+        bool m_unknownSeqNo; ///< Unknown sequence number flag
+    };
+
     /**
      * constructor
      *
@@ -300,6 +321,44 @@ class RreqHeader : public Header
      */
     bool GetUnknownSeqno() const;
 
+    /**
+     * \brief Add a destination searched by the same RREQ
+     * \param dst the destination
+     * \return false if the maximum number of additional destinations is reached
+     */
+    bool AddDestination(const Destination& dst);
+    /**
+     * \brief Get the additional destinations
+     * \return the additional destinations, in the order they were added
+     */
+    const std::vector<Destination>& GetDestinations() const
+    {
+        return m_destinations;
+    }
+
+    /// Remove all additional destinations
+    void ClearDestinations();
+
+    /**
+     * \brief Set the path cost, which makes the message carry it
+     * \param cost the path cost from the node which generated the message
+     */
+    void SetCost(uint16_t cost);
+    /**
+     * \brief Get the path cost
+     * \return the path cost, 0 if the message carries none
+     */
+    uint16_t GetCost() const
+    {
+        return m_cost;
+    }
+
+    /**
+     * \brief Check whether the message carries a path cost
+     * \return true if it does
+     */
+    bool HasCost() const;
+
     /**
      * \brief Comparison operator
      * \param o RREQ header to compare
@@ -309,13 +368,15 @@ class RreqHeader : public Header
 
   private:
     uint8_t m_flags;        ///< |J|R|G|D|U| bit flags, see RFC
-    uint8_t m_reserved;     ///< Not used (must be 0)
+    uint8_t m_reserved;     ///< Number of additional destinations
     uint8_t m_hopCount;     ///< Hop Count
     uint32_t m_requestID;   ///< RREQ ID
     Ipv4Address m_dst;      ///< Destination IP Address
     uint32_t m_dstSeqNo;    ///< Destination Sequence Number
     Ipv4Address m_origin;   ///< Originator IP Address
     uint32_t m_originSeqNo; ///< Source Sequence Number
+    std::vector<Destination> m_destinations; ///< Additional destinations
+    uint16_t m_cost;                         ///< Path cost, if the C flag is set
 };
 
 /**
@@ -342,7 +403,11 @@ std::ostream& operator<<(std::ostream& os, const RreqHeader&);
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                           Lifetime                            |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |      Path Cost (optional)     |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+
+  The path cost is present if the C flag, following the A flag, is set.
 */
 class RrepHeader : public Header
 {
@@ -489,6 +554,26 @@ class RrepHeader : public Header
      */
     void SetHello(Ipv4Address src, uint32_t srcSeqNo, Time lifetime);
 
+    /**
+     * \brief Set the path cost, which makes the message carry it
+     * \param cost the path cost from the node which generated the message
+     */
+    void SetCost(uint16_t cost);
+    /**
+     * \brief Get the path cost
+     * \return the path cost, 0 if the message carries none
+     */
+    uint16_t GetCost() const
+    {
+        return m_cost;
+    }
+
+    /**
+     * \brief Check whether the message carries a path cost
+     * \return true if it does
+     */
+    bool HasCost() const;
+
     /**
      * \brief Comparison operator
      * \param o RREP header to compare
@@ -504,6 +589,7 @@ class RrepHeader : public Header
     uint32_t m_dstSeqNo;  ///< Destination Sequence Number
     Ipv4Address m_origin; ///< Source IP Address
     uint32_t m_lifeTime;  ///< Lifetime (in milliseconds)
+    uint16_t m_cost;      ///< Path cost, if the C flag is set
 };
 
 /**
@@ -851,6 +937,41 @@ class RevRreqHeader : public Header
 
 std::ostream& operator<<(std::ostream& os, const RevRreqHeader&);
 
+/**
+ * \ingroup raodv
+ * \brief Wire image of a raodv control message
+ *
+ * The message header and its type header are serialized once; the packets created from the
+ * image share that buffer copy-on-write and only differ by their TTL tag.
+ */
+class ControlMessage
+{
+  public:
+    /**
+     * constructor
+     * \param header the message header
+     * \param type the message type
+     */
+    ControlMessage(const Header& header, MessageType type);
+
+    /**
+     * Create a packet carrying the message
+     * \param ttl the IP TTL of the packet
+     * \returns the packet
+     */
+    Ptr<Packet> CreatePacket(uint8_t ttl) const;
+
+    /**
+     * \returns the serialized size of the message
+     */
+    uint32_t GetSize() const
+    {
+        return m_wire->GetSize();
+    }
+
+  private:
+    Ptr<Packet> m_wire; ///< Serialized type header and message header
+};
 
 
 } // namespace raodv
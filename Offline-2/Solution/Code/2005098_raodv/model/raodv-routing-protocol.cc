@@ -1,3 +1,50 @@
+    /*
+     *  Node checks to determine whether it has received a RREQ with the same Originator IP Address
+     * and RREQ ID. If such a RREQ has been received, the node silently discards the newly received
+     * RREQ. A multi-destination RREQ is handled as one RREQ per destination sharing the reverse
+     * route, so each destination is checked on its own RREQ ID and only a RREQ whose destinations
+     * have all been seen is discarded.
+     */
+    std::vector<RreqHeader::Destination> requests;
+    if (!CountDuplicate(m_rreqIdCache.IsDuplicate(origin, id)))
+    {
+        requests.push_back({rreqHeader.GetDst(),
+                            rreqHeader.GetId(),
+                            rreqHeader.GetDstSeqno(),
+                            rreqHeader.GetUnknownSeqno()});
+    }
+    else
+    {
+        NS_LOG_DEBUG("Ignoring destination " << rreqHeader.GetDst() << " of RREQ due to duplicate");
+    }
+    const std::vector<RreqHeader::Destination>& extra = rreqHeader.GetDestinations();
+    for (auto i = extra.begin(); i != extra.end(); ++i)
+    {
+        if (CountDuplicate(m_rreqIdCache.IsDuplicate(origin, i->m_id)))
+        {
+            NS_LOG_DEBUG("Ignoring destination " << i->m_dst << " of RREQ due to duplicate");
+            continue;
+        }
+        requests.push_back(*i);
+    }
+    uint16_t cost = m_linkCostMetric ? AddLinkCost(rreqHeader.GetCost(), src) : 0;
+    if (requests.empty())
+    {
+        NS_LOG_DEBUG("Ignoring RREQ due to duplicate");
+        CountMessage(RAODVTYPE_RREQ, MESSAGE_SUPPRESSED);
+        if (m_linkCostMetric)
+        {
+            // A later copy may still have come through a cheaper path
+            ImproveRoute(origin,
+                         rreqHeader.GetOriginSeqno(),
+                         src,
+                         in,
+                         rreqHeader.GetHopCount() + 1,
+                         cost);
+        }
+        return;
+    }
+
 /*
  * Copyright (c) 2009 IITP RAS
  *
@@ -34,6 +81,7 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/wifi-mpdu.h"
 #include "ns3/wifi-net-device.h"
+#include "ns3/wifi-phy.h"
 
 #include <algorithm>
 #include <limits>
@@ -155,6 +203,19 @@ RoutingProtocol::RoutingProtocol()
       m_destinationOnly(false),
       m_gratuitousReply(true),
       m_enableHello(false),
+      m_revRreqCounterThreshold(0),
+      m_revRreqAssessmentDelay(MilliSeconds(10)),
+      m_revRreqAggregation(false),
+      m_revRreqSuppressAnswered(false),
+      m_adaptiveHello(false),
+      m_maxHelloInterval(Seconds(8)),
+      m_currentHelloInterval(Seconds(1)),
+      m_helloNbChanges(0),
+      m_queueReleaseInterval(Seconds(0)),
+      m_maxRreqDestinations(1),
+      m_linkCostMetric(false),
+      m_lastRxSnr(0),
+      m_lastRxTime(Seconds(-1)),
       m_routingTable(m_deletePeriod),
       m_queue(m_maxQueueLen, m_maxQueueTime),
       m_requestId(0),
@@ -164,12 +225,21 @@ RoutingProtocol::RoutingProtocol()
       m_nb(m_helloInterval),
       m_rreqCount(0),
       m_rerrCount(0),
+      m_answeredRreqCache(m_netTraversalTime),
       m_htimer(Timer::CANCEL_ON_DESTROY),
       m_rreqRateLimitTimer(Timer::CANCEL_ON_DESTROY),
       m_rerrRateLimitTimer(Timer::CANCEL_ON_DESTROY),
-      m_lastBcastTime(Seconds(0))
+      m_lastBcastTime(Seconds(0)),
+      m_txScheduler(Seconds(0)),
+      m_stats(),
+      m_histogramBinWidth(MilliSeconds(10)),
+      m_routingTableSize(0)
 {
     m_nb.SetCallback(MakeCallback(&RoutingProtocol::SendRerrWhenBreaksLinkToNextHop, this));
+    m_txScheduler.SetSendCallback(MakeCallback(&RoutingProtocol::SendTo, this));
+    m_queue.SetDropCallback(MakeCallback(&RoutingProtocol::NotifyQueueDrop, this));
+    m_routingTable.SetSizeCallback(MakeCallback(&RoutingProtocol::NotifyRoutingTableSize, this));
+    SetHistogramBinWidth(m_histogramBinWidth);
 }
 
 TypeId
@@ -217,6 +287,13 @@ RoutingProtocol::GetTypeId()
                           UintegerValue(10),
                           MakeUintegerAccessor(&RoutingProtocol::m_rreqRateLimit),
                           MakeUintegerChecker<uint32_t>())
+            .AddAttribute("MaxRreqDestinations",
+                          "Maximum number of destinations searched by one RREQ. Above 1, the "
+                          "route discoveries held back by RreqRateLimit are batched into "
+                          "multi-destination RREQs when the rate limit window ends.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&RoutingProtocol::m_maxRreqDestinations),
+                          MakeUintegerChecker<uint32_t>(1, 256))
             .AddAttribute("RerrRateLimit",
                           "Maximum number of RERR per second.",
                           UintegerValue(10),
@@ -321,14 +398,131 @@ RoutingProtocol::GetTypeId()
                           MakeBooleanAccessor(&RoutingProtocol::SetBroadcastEnable,
                                               &RoutingProtocol::GetBroadcastEnable),
                           MakeBooleanChecker())
+            .AddAttribute("MultipathAlternates",
+                          "Number of alternate next hops kept per destination from the copies of "
+                          "reverse RREQs. On a link break, routes fail over to an alternate "
+                          "instead of being invalidated. 0 disables multipath.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::SetMultipathAlternates,
+                                               &RoutingProtocol::GetMultipathAlternates),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RevRreqCounterThreshold",
+                          "Number of copies of a reverse RREQ heard during the assessment delay "
+                          "after which its rebroadcast is cancelled. 0 disables counter-based "
+                          "suppression.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&RoutingProtocol::m_revRreqCounterThreshold),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("RevRreqAssessmentDelay",
+                          "Time a reverse RREQ rebroadcast is held for counting copies and "
+                          "merging, when counter-based suppression or aggregation is enabled.",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&RoutingProtocol::m_revRreqAssessmentDelay),
+                          MakeTimeChecker())
+            .AddAttribute("RevRreqAggregation",
+                          "Indicates whether reverse RREQs for the same origin and destination "
+                          "held during the assessment delay are merged into one rebroadcast.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_revRreqAggregation),
+                          MakeBooleanChecker())
+            .AddAttribute("RevRreqSuppressAnswered",
+                          "Indicates whether a node which has sent or forwarded a RREP for a route "
+                          "discovery stops rebroadcasting reverse RREQs of this discovery.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_revRreqSuppressAnswered),
+                          MakeBooleanChecker())
+            .AddAttribute("AdaptiveHello",
+                          "Indicates whether the hello interval doubles, up to MaxHelloInterval, "
+                          "while the neighbor set is stable. Received control messages then also "
+                          "count as hellos from their sender.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_adaptiveHello),
+                          MakeBooleanChecker())
+            .AddAttribute("MaxHelloInterval",
+                          "Upper bound of the hello interval in adaptive hello mode.",
+                          TimeValue(Seconds(8)),
+                          MakeTimeAccessor(&RoutingProtocol::m_maxHelloInterval),
+                          MakeTimeChecker())
+            .AddAttribute("ControlTxSlot",
+                          "Jittered control packet sends are rounded up to a multiple of this "
+                          "slot and the sends of a slot share one simulator event. 0 keeps the "
+                          "exact jitter and only merges sends due at the same time.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RoutingProtocol::SetControlTxSlot,
+                                           &RoutingProtocol::GetControlTxSlot),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("QueueReleaseInterval",
+                          "Spacing of the packets released from the queue when a route is "
+                          "found, so that a large backlog does not flood the MAC queue at once. "
+                          "The first packet is always sent immediately. 0 releases the whole "
+                          "backlog at once.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RoutingProtocol::m_queueReleaseInterval),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("LinkCostMetric",
+                          "Choose routes by the sum of ETX-like link costs, estimated from the "
+                          "SNR of the frames received from every neighbor and from layer 2 "
+                          "transmission failures, rather than by hop count. Only effective "
+                          "before the interfaces go up.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&RoutingProtocol::m_linkCostMetric),
+                          MakeBooleanChecker())
+            .AddAttribute("HistogramBinWidth",
+                          "Bin width of the route discovery latency and queue wait histograms. "
+                          "Only effective before the first sample.",
+                          TimeValue(MilliSeconds(10)),
+                          MakeTimeAccessor(&RoutingProtocol::SetHistogramBinWidth,
+                                           &RoutingProtocol::GetHistogramBinWidth),
+                          MakeTimeChecker(TimeStep(1)))
             .AddAttribute("UniformRv",
                           "Access to the underlying UniformRandomVariable",
                           StringValue("ns3::UniformRandomVariable"),
                           MakePointerAccessor(&RoutingProtocol::m_uniformRandomVariable),
-                          MakePointerChecker<UniformRandomVariable>());
+                          MakePointerChecker<UniformRandomVariable>())
+            .AddTraceSource("ControlMessage",
+                            "A control message was sent, received or suppressed.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_controlMessageTrace),
+                            "ns3::raodv::RoutingProtocol::ControlMessageTracedCallback")
+            .AddTraceSource("RouteDiscoveryLatency",
+                            "A route discovery completed, with the time since the first "
+                            "packet to the destination was queued.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_routeDiscoveryTrace),
+                            "ns3::raodv::RoutingProtocol::RouteDiscoveryTracedCallback")
+            .AddTraceSource("QueueWait",
+                            "A queued packet was sent once its route was found.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_queueWaitTrace),
+                            "ns3::raodv::RoutingProtocol::QueueWaitTracedCallback")
+            .AddTraceSource("QueueDrop",
+                            "A packet was dropped from the queue.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_queueDropTrace),
+                            "ns3::raodv::RoutingProtocol::QueueDropTracedCallback")
+            .AddTraceSource("RoutingTableSize",
+                            "Number of routing table entries.",
+                            MakeTraceSourceAccessor(&RoutingProtocol::m_routingTableSize),
+                            "ns3::TracedValueCallback::Uint32");
     return tid;
 }
 
+void
+RoutingProtocol::SetHistogramBinWidth(Time width)
+{
+    m_histogramBinWidth = width;
+    m_stats.m_discoveryLatency.SetDefaultBinWidth(width.GetSeconds());
+    m_stats.m_queueWait.SetDefaultBinWidth(width.GetSeconds());
+}
+
+void
+RoutingProtocol::NotifyQueueDrop(const QueueEntry& entry, RequestQueue::DropReason reason)
+{
+    m_queueDropTrace(entry.GetPacket(), reason);
+}
+
+void
+RoutingProtocol::NotifyRoutingTableSize(uint32_t size)
+{
+    m_routingTableSize = size;
+}
+
 void
 RoutingProtocol::SetMaxQueueLen(uint32_t len)
 {
@@ -351,18 +545,24 @@ void
 RoutingProtocol::DoDispose()
 {
     m_ipv4 = nullptr;
-    for (auto iter = m_socketAddresses.begin(); iter != m_socketAddresses.end(); iter++)
+    for (auto iter = m_interfaces.begin(); iter != m_interfaces.end(); iter++)
+    {
+        iter->second.m_socket->Close();
+        iter->second.m_broadcastSocket->Close();
+    }
+    m_interfaces.clear();
+    m_socketInterfaces.clear();
+    for (auto iter = m_pendingRevRreq.begin(); iter != m_pendingRevRreq.end(); iter++)
     {
-        iter->first->Close();
+        iter->second.m_event.Cancel();
     }
-    m_socketAddresses.clear();
-    for (auto iter = m_socketSubnetBroadcastAddresses.begin();
-         iter != m_socketSubnetBroadcastAddresses.end();
-         iter++)
+    m_pendingRevRreq.clear();
+    for (auto iter = m_queueReleases.begin(); iter != m_queueReleases.end(); iter++)
     {
-        iter->first->Close();
+        iter->second.m_event.Cancel();
     }
-    m_socketSubnetBroadcastAddresses.clear();
+    m_queueReleases.clear();
+    m_txScheduler.Clear();
     Ipv4RoutingProtocol::DoDispose();
 }
 
@@ -386,10 +586,23 @@ RoutingProtocol::AssignStreams(int64_t stream)
     return 1;
 }
 
+bool
+RoutingProtocol::IsLocalNode() const
+{
+    Ptr<Node> node = GetObject<Node>();
+    return !node || node->GetSystemId() == Simulator::GetSystemId();
+}
+
 void
 RoutingProtocol::Start()
 {
     NS_LOG_FUNCTION(this);
+    if (!IsLocalNode())
+    {
+        NS_LOG_LOGIC("Node belongs to system " << GetObject<Node>()->GetSystemId()
+                                               << ", not starting");
+        return;
+    }
     if (m_enableHello)
     {
         m_nb.ScheduleTimer();
@@ -413,7 +626,7 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
         NS_LOG_DEBUG("Packet is == 0");
         return LoopbackRoute(header, oif); // later
     }
-    if (m_socketAddresses.empty())
+    if (m_interfaces.empty())
     {
         sockerr = Socket::ERROR_NOROUTETOHOST;
         NS_LOG_LOGIC("No raodv interfaces");
@@ -423,10 +636,10 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
     sockerr = Socket::ERROR_NOTERROR;
     Ptr<Ipv4Route> route;
     Ipv4Address dst = header.GetDestination();
-    RoutingTableEntry rt;
-    if (m_routingTable.LookupValidRoute(dst, rt))
+    RoutingTableEntry* rt = m_routingTable.FindValidRoute(dst);
+    if (rt)
     {
-        route = rt.GetRoute();
+        route = rt->GetRoute();
         NS_ASSERT(route);
         NS_LOG_DEBUG("Exist route to " << route->GetDestination() << " from interface "
                                        << route->GetSource());
@@ -436,7 +649,7 @@ RoutingProtocol::RouteOutput(Ptr<Packet> p,
             sockerr = Socket::ERROR_NOROUTETOHOST;
             return Ptr<Ipv4Route>();
         }
-        UpdateRouteLifeTime(dst, m_activeRouteTimeout);
+        m_routingTable.RefreshLifeTime(*rt, m_activeRouteTimeout);
         UpdateRouteLifeTime(route->GetGateway(), m_activeRouteTimeout);
         return route;
     }
@@ -474,6 +687,7 @@ RoutingProtocol::DeferredRouteOutput(Ptr<const Packet> p,
         if (!result || ((rt.GetFlag() != IN_SEARCH) && result))
         {
             NS_LOG_LOGIC("Send new RREQ for outbound packet to " << header.GetDestination());
+            m_discoveryStart.emplace(header.GetDestination(), Simulator::Now());
             SendRequest(header.GetDestination());
         }
     }
@@ -489,7 +703,7 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
                             const ErrorCallback& ecb)
 {
     NS_LOG_FUNCTION(this << p->GetUid() << header.GetDestination() << idev->GetAddress());
-    if (m_socketAddresses.empty())
+    if (m_interfaces.empty())
     {
         NS_LOG_LOGIC("No raodv interfaces");
         return false;
@@ -527,79 +741,78 @@ RoutingProtocol::RouteInput(Ptr<const Packet> p,
     }
 
     // Broadcast local delivery/forwarding
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    auto in = m_interfaces.find(iif);
+    if (in != m_interfaces.end())
     {
-        Ipv4InterfaceAddress iface = j->second;
-        if (m_ipv4->GetInterfaceForAddress(iface.GetLocal()) == iif)
+        Ipv4InterfaceAddress iface = in->second.m_iface;
+        if (dst == iface.GetBroadcast() || dst.IsBroadcast())
         {
-            if (dst == iface.GetBroadcast() || dst.IsBroadcast())
+            if (CountDuplicate(m_dpd.IsDuplicate(p, header)))
             {
-                if (m_dpd.IsDuplicate(p, header))
-                {
-                    NS_LOG_DEBUG("Duplicated packet " << p->GetUid() << " from " << origin
-                                                      << ". Drop.");
-                    return true;
-                }
-                UpdateRouteLifeTime(origin, m_activeRouteTimeout);
-                Ptr<Packet> packet = p->Copy();
-                if (!lcb.IsNull())
-                {
-                    NS_LOG_LOGIC("Broadcast local delivery to " << iface.GetLocal());
-                    lcb(p, header, iif);
-                    // Fall through to additional processing
-                }
-                else
-                {
-                    NS_LOG_ERROR("Unable to deliver packet locally due to null callback "
-                                 << p->GetUid() << " from " << origin);
-                    ecb(p, header, Socket::ERROR_NOROUTETOHOST);
-                }
-                if (!m_enableBroadcast)
+                NS_LOG_DEBUG("Duplicated packet " << p->GetUid() << " from " << origin
+                                                  << ". Drop.");
+                return true;
+            }
+            UpdateRouteLifeTime(origin, m_activeRouteTimeout);
+            Ptr<Packet> packet = p->Copy();
+            if (!lcb.IsNull())
+            {
+                NS_LOG_LOGIC("Broadcast local delivery to " << iface.GetLocal());
+                lcb(p, header, iif);
+                // Fall through to additional processing
+            }
+            else
+            {
+                NS_LOG_ERROR("Unable to deliver packet locally due to null callback "
+                             << p->GetUid() << " from " << origin);
+                ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+            }
+            if (!m_enableBroadcast)
+            {
+                return true;
+            }
+            if (header.GetProtocol() == UdpL4Protocol::PROT_NUMBER)
+            {
+                UdpHeader udpHeader;
+                p->PeekHeader(udpHeader);
+                if (udpHeader.GetDestinationPort() == RAODV_PORT)
                 {
+                    // raodv packets sent in broadcast are already managed
                     return true;
                 }
-                if (header.GetProtocol() == UdpL4Protocol::PROT_NUMBER)
-                {
-                    UdpHeader udpHeader;
-                    p->PeekHeader(udpHeader);
-                    if (udpHeader.GetDestinationPort() == RAODV_PORT)
-                    {
-                        // raodv packets sent in broadcast are already managed
-                        return true;
-                    }
-                }
-                if (header.GetTtl() > 1)
+            }
+            if (header.GetTtl() > 1)
+            {
+                NS_LOG_LOGIC("Forward broadcast. TTL " << (uint16_t)header.GetTtl());
+                RoutingTableEntry toBroadcast;
+                if (m_routingTable.LookupRoute(dst, toBroadcast))
                 {
-                    NS_LOG_LOGIC("Forward broadcast. TTL " << (uint16_t)header.GetTtl());
-                    RoutingTableEntry toBroadcast;
-                    if (m_routingTable.LookupRoute(dst, toBroadcast))
-                    {
-                        Ptr<Ipv4Route> route = toBroadcast.GetRoute();
-                        ucb(route, packet, header);
-                    }
-                    else
-                    {
-                        NS_LOG_DEBUG("No route to forward broadcast. Drop packet " << p->GetUid());
-                    }
+                    Ptr<Ipv4Route> route = toBroadcast.GetRoute();
+                    ucb(route, packet, header);
                 }
                 else
                 {
-                    NS_LOG_DEBUG("TTL exceeded. Drop packet " << p->GetUid());
+                    NS_LOG_DEBUG("No route to forward broadcast. Drop packet " << p->GetUid());
                 }
-                return true;
             }
+            else
+            {
+                NS_LOG_DEBUG("TTL exceeded. Drop packet " << p->GetUid());
+            }
+            return true;
         }
     }
 
     // Unicast local delivery
     if (m_ipv4->IsDestinationAddress(dst, iif))
     {
-        UpdateRouteLifeTime(origin, m_activeRouteTimeout);
-        RoutingTableEntry toOrigin;
-        if (m_routingTable.LookupValidRoute(origin, toOrigin))
+        const RoutingTableEntry* toOrigin =
+            m_routingTable.TouchValidRoute(origin, m_activeRouteTimeout);
+        if (toOrigin)
         {
-            UpdateRouteLifeTime(toOrigin.GetNextHop(), m_activeRouteTimeout);
-            m_nb.Update(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            Ipv4Address prevHop = toOrigin->GetNextHop();
+            UpdateRouteLifeTime(prevHop, m_activeRouteTimeout);
+            m_nb.Update(prevHop, m_activeRouteTimeout);
         }
         if (!lcb.IsNull())
         {
@@ -636,13 +849,14 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
     NS_LOG_FUNCTION(this);
     Ipv4Address dst = header.GetDestination();
     Ipv4Address origin = header.GetSource();
-    m_routingTable.Purge();
-    RoutingTableEntry toDst;
-    if (m_routingTable.LookupRoute(dst, toDst))
+    // The entries are used in place and each one is looked up once: its lifetime is refreshed
+    // before the next lookup, which may purge the routing table
+    RoutingTableEntry* toDst = m_routingTable.FindRoute(dst);
+    if (toDst)
     {
-        if (toDst.GetFlag() == VALID)
+        if (toDst->GetFlag() == VALID)
         {
-            Ptr<Ipv4Route> route = toDst.GetRoute();
+            Ptr<Ipv4Route> route = toDst->GetRoute();
             NS_LOG_LOGIC(route->GetSource() << " forwarding to " << dst << " from " << origin
                                             << " packet " << p->GetUid());
 
@@ -652,8 +866,17 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
              *  path to the destination is updated to be no less than the current
              *  time plus ActiveRouteTimeout.
              */
-            UpdateRouteLifeTime(origin, m_activeRouteTimeout);
-            UpdateRouteLifeTime(dst, m_activeRouteTimeout);
+            m_routingTable.RefreshLifeTime(*toDst, m_activeRouteTimeout);
+            RoutingTableEntry* toOrigin = m_routingTable.FindRoute(origin);
+            Ipv4Address prevHop;
+            if (toOrigin)
+            {
+                if (toOrigin->GetFlag() == VALID)
+                {
+                    m_routingTable.RefreshLifeTime(*toOrigin, m_activeRouteTimeout);
+                }
+                prevHop = toOrigin->GetNextHop();
+            }
             UpdateRouteLifeTime(route->GetGateway(), m_activeRouteTimeout);
             /*
              *  Since the route between each originator and destination pair is expected to be
@@ -661,21 +884,19 @@ RoutingProtocol::Forwarding(Ptr<const Packet> p,
              * back to the IP source, is also updated to be no less than the current time plus
              * ActiveRouteTimeout
              */
-            RoutingTableEntry toOrigin;
-            m_routingTable.LookupRoute(origin, toOrigin);
-            UpdateRouteLifeTime(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            UpdateRouteLifeTime(prevHop, m_activeRouteTimeout);
 
             m_nb.Update(route->GetGateway(), m_activeRouteTimeout);
-            m_nb.Update(toOrigin.GetNextHop(), m_activeRouteTimeout);
+            m_nb.Update(prevHop, m_activeRouteTimeout);
 
             ucb(route, p, header);
             return true;
         }
         else
         {
-            if (toDst.GetValidSeqNo())
+            if (toDst->GetValidSeqNo())
             {
-                SendRerrWhenNoRouteToForward(dst, toDst.GetSeqNo(), origin);
+                SendRerrWhenNoRouteToForward(dst, toDst->GetSeqNo(), origin);
                 NS_LOG_DEBUG("Drop packet " << p->GetUid() << " because no route to forward it.");
                 return false;
             }
@@ -730,37 +951,7 @@ RoutingProtocol::NotifyInterfaceUp(uint32_t i)
         return;
     }
 
-    // Create a socket to listen only on this interface
-    Ptr<Socket> socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
-    NS_ASSERT(socket);
-    socket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
-    socket->BindToNetDevice(l3->GetNetDevice(i));
-    socket->Bind(InetSocketAddress(iface.GetLocal(), RAODV_PORT));
-    socket->SetAllowBroadcast(true);
-    socket->SetIpRecvTtl(true);
-    m_socketAddresses.insert(std::make_pair(socket, iface));
-
-    // create also a subnet broadcast socket
-    socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
-    NS_ASSERT(socket);
-    socket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
-    socket->BindToNetDevice(l3->GetNetDevice(i));
-    socket->Bind(InetSocketAddress(iface.GetBroadcast(), RAODV_PORT));
-    socket->SetAllowBroadcast(true);
-    socket->SetIpRecvTtl(true);
-    m_socketSubnetBroadcastAddresses.insert(std::make_pair(socket, iface));
-
-    // Add local broadcast record to the routing table
-    Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(iface.GetLocal()));
-    RoutingTableEntry rt(/*dev=*/dev,
-                         /*dst=*/iface.GetBroadcast(),
-                         /*vSeqNo=*/true,
-                         /*seqNo=*/0,
-                         /*iface=*/iface,
-                         /*hops=*/1,
-                         /*nextHop=*/iface.GetBroadcast(),
-                         /*lifetime=*/Simulator::GetMaximumSimulationTime());
-    m_routingTable.AddRoute(rt);
+    AddInterface(i);
 
     if (l3->GetInterface(i)->GetArpCache())
     {
@@ -768,7 +959,7 @@ RoutingProtocol::NotifyInterfaceUp(uint32_t i)
     }
 
     // Allow neighbor manager use this interface for layer 2 feedback if possible
-    Ptr<WifiNetDevice> wifi = dev->GetObject<WifiNetDevice>();
+    Ptr<WifiNetDevice> wifi = l3->GetNetDevice(i)->GetObject<WifiNetDevice>();
     if (!wifi)
     {
         return;
@@ -781,12 +972,35 @@ RoutingProtocol::NotifyInterfaceUp(uint32_t i)
 
     mac->TraceConnectWithoutContext("DroppedMpdu",
                                     MakeCallback(&RoutingProtocol::NotifyTxError, this));
+    if (m_linkCostMetric)
+    {
+        wifi->GetPhy()->TraceConnectWithoutContext(
+            "MonitorSnifferRx",
+            MakeCallback(&RoutingProtocol::NotifyRxSnr, this));
+    }
 }
 
 void
 RoutingProtocol::NotifyTxError(WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu)
 {
     m_nb.GetTxErrorCallback()(mpdu->GetHeader());
+    if (m_adaptiveHello)
+    {
+        ResetHelloInterval();
+    }
+}
+
+void
+RoutingProtocol::NotifyRxSnr(Ptr<const Packet> packet,
+                             uint16_t channelFreqMhz,
+                             WifiTxVector txVector,
+                             MpduInfo aMpdu,
+                             SignalNoiseDbm signalNoise,
+                             uint16_t staId)
+{
+    // A received control packet reaches RecvRaodv within the event of its frame reception
+    m_lastRxSnr = signalNoise.signal - signalNoise.noise;
+    m_lastRxTime = Simulator::Now();
 }
 
 void
@@ -805,23 +1019,19 @@ RoutingProtocol::NotifyInterfaceDown(uint32_t i)
         {
             mac->TraceDisconnectWithoutContext("DroppedMpdu",
                                                MakeCallback(&RoutingProtocol::NotifyTxError, this));
+            if (m_linkCostMetric)
+            {
+                wifi->GetPhy()->TraceDisconnectWithoutContext(
+                    "MonitorSnifferRx",
+                    MakeCallback(&RoutingProtocol::NotifyRxSnr, this));
+            }
             m_nb.DelArpCache(l3->GetInterface(i)->GetArpCache());
         }
     }
 
-    // Close socket
-    Ptr<Socket> socket = FindSocketWithInterfaceAddress(m_ipv4->GetAddress(i, 0));
-    NS_ASSERT(socket);
-    socket->Close();
-    m_socketAddresses.erase(socket);
+    RemoveInterface(i);
 
-    // Close socket
-    socket = FindSubnetBroadcastSocketWithInterfaceAddress(m_ipv4->GetAddress(i, 0));
-    NS_ASSERT(socket);
-    socket->Close();
-    m_socketSubnetBroadcastAddresses.erase(socket);
-
-    if (m_socketAddresses.empty())
+    if (m_interfaces.empty())
     {
         NS_LOG_LOGIC("No raodv interfaces");
         m_htimer.Cancel();
@@ -843,46 +1053,13 @@ RoutingProtocol::NotifyAddAddress(uint32_t i, Ipv4InterfaceAddress address)
     }
     if (l3->GetNAddresses(i) == 1)
     {
-        Ipv4InterfaceAddress iface = l3->GetAddress(i, 0);
-        Ptr<Socket> socket = FindSocketWithInterfaceAddress(iface);
-        if (!socket)
+        if (m_interfaces.find(i) == m_interfaces.end())
         {
-            if (iface.GetLocal() == Ipv4Address("127.0.0.1"))
+            if (l3->GetAddress(i, 0).GetLocal() == Ipv4Address("127.0.0.1"))
             {
                 return;
             }
-            // Create a socket to listen only on this interface
-            Ptr<Socket> socket =
-                Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
-            NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
-            socket->BindToNetDevice(l3->GetNetDevice(i));
-            socket->Bind(InetSocketAddress(iface.GetLocal(), RAODV_PORT));
-            socket->SetAllowBroadcast(true);
-            m_socketAddresses.insert(std::make_pair(socket, iface));
-
-            // create also a subnet directed broadcast socket
-            socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
-            NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
-            socket->BindToNetDevice(l3->GetNetDevice(i));
-            socket->Bind(InetSocketAddress(iface.GetBroadcast(), RAODV_PORT));
-            socket->SetAllowBroadcast(true);
-            socket->SetIpRecvTtl(true);
-            m_socketSubnetBroadcastAddresses.insert(std::make_pair(socket, iface));
-
-            // Add local broadcast record to the routing table
-            Ptr<NetDevice> dev =
-                m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(iface.GetLocal()));
-            RoutingTableEntry rt(/*dev=*/dev,
-                                 /*dst=*/iface.GetBroadcast(),
-                                 /*vSeqNo=*/true,
-                                 /*seqNo=*/0,
-                                 /*iface=*/iface,
-                                 /*hops=*/1,
-                                 /*nextHop=*/iface.GetBroadcast(),
-                                 /*lifetime=*/Simulator::GetMaximumSimulationTime());
-            m_routingTable.AddRoute(rt);
+            AddInterface(i);
         }
     }
     else
@@ -896,60 +1073,18 @@ void
 RoutingProtocol::NotifyRemoveAddress(uint32_t i, Ipv4InterfaceAddress address)
 {
     NS_LOG_FUNCTION(this);
-    Ptr<Socket> socket = FindSocketWithInterfaceAddress(address);
-    if (socket)
+    auto in = m_interfaces.find(i);
+    if (in != m_interfaces.end() && in->second.m_iface == address)
     {
         m_routingTable.DeleteAllRoutesFromInterface(address);
-        socket->Close();
-        m_socketAddresses.erase(socket);
-
-        Ptr<Socket> unicastSocket = FindSubnetBroadcastSocketWithInterfaceAddress(address);
-        if (unicastSocket)
-        {
-            unicastSocket->Close();
-            m_socketAddresses.erase(unicastSocket);
-        }
+        RemoveInterface(i);
 
         Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol>();
         if (l3->GetNAddresses(i))
         {
-            Ipv4InterfaceAddress iface = l3->GetAddress(i, 0);
-            // Create a socket to listen only on this interface
-            Ptr<Socket> socket =
-                Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
-            NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
-            // Bind to any IP address so that broadcasts can be received
-            socket->BindToNetDevice(l3->GetNetDevice(i));
-            socket->Bind(InetSocketAddress(iface.GetLocal(), RAODV_PORT));
-            socket->SetAllowBroadcast(true);
-            socket->SetIpRecvTtl(true);
-            m_socketAddresses.insert(std::make_pair(socket, iface));
-
-            // create also a unicast socket
-            socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
-            NS_ASSERT(socket);
-            socket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
-            socket->BindToNetDevice(l3->GetNetDevice(i));
-            socket->Bind(InetSocketAddress(iface.GetBroadcast(), RAODV_PORT));
-            socket->SetAllowBroadcast(true);
-            socket->SetIpRecvTtl(true);
-            m_socketSubnetBroadcastAddresses.insert(std::make_pair(socket, iface));
-
-            // Add local broadcast record to the routing table
-            Ptr<NetDevice> dev =
-                m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(iface.GetLocal()));
-            RoutingTableEntry rt(/*dev=*/dev,
-                                 /*dst=*/iface.GetBroadcast(),
-                                 /*vSeqNo=*/true,
-                                 /*seqNo=*/0,
-                                 /*iface=*/iface,
-                                 /*hops=*/1,
-                                 /*nextHop=*/iface.GetBroadcast(),
-                                 /*lifetime=*/Simulator::GetMaximumSimulationTime());
-            m_routingTable.AddRoute(rt);
-        }
-        if (m_socketAddresses.empty())
+            AddInterface(i);
+        }
+        if (m_interfaces.empty())
         {
             NS_LOG_LOGIC("No raodv interfaces");
             m_htimer.Cancel();
@@ -964,13 +1099,67 @@ RoutingProtocol::NotifyRemoveAddress(uint32_t i, Ipv4InterfaceAddress address)
     }
 }
 
+void
+RoutingProtocol::AddInterface(uint32_t i)
+{
+    NS_LOG_FUNCTION(this << i);
+    Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol>();
+    InterfaceSockets& in = m_interfaces[i];
+    in.m_iface = l3->GetAddress(i, 0);
+    in.m_device = l3->GetNetDevice(i);
+
+    // Create a socket to listen only on this interface
+    in.m_socket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
+    NS_ASSERT(in.m_socket);
+    in.m_socket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
+    in.m_socket->BindToNetDevice(in.m_device);
+    in.m_socket->Bind(InetSocketAddress(in.m_iface.GetLocal(), RAODV_PORT));
+    in.m_socket->SetAllowBroadcast(true);
+    in.m_socket->SetIpRecvTtl(true);
+    m_socketInterfaces[in.m_socket] = i;
+
+    // create also a subnet broadcast socket
+    in.m_broadcastSocket = Socket::CreateSocket(GetObject<Node>(), UdpSocketFactory::GetTypeId());
+    NS_ASSERT(in.m_broadcastSocket);
+    in.m_broadcastSocket->SetRecvCallback(MakeCallback(&RoutingProtocol::RecvRaodv, this));
+    in.m_broadcastSocket->BindToNetDevice(in.m_device);
+    in.m_broadcastSocket->Bind(InetSocketAddress(in.m_iface.GetBroadcast(), RAODV_PORT));
+    in.m_broadcastSocket->SetAllowBroadcast(true);
+    in.m_broadcastSocket->SetIpRecvTtl(true);
+    m_socketInterfaces[in.m_broadcastSocket] = i;
+
+    // Add local broadcast record to the routing table
+    RoutingTableEntry rt(/*dev=*/in.m_device,
+                         /*dst=*/in.m_iface.GetBroadcast(),
+                         /*vSeqNo=*/true,
+                         /*seqNo=*/0,
+                         /*iface=*/in.m_iface,
+                         /*hops=*/1,
+                         /*nextHop=*/in.m_iface.GetBroadcast(),
+                         /*lifetime=*/Simulator::GetMaximumSimulationTime());
+    m_routingTable.AddRoute(rt);
+}
+
+void
+RoutingProtocol::RemoveInterface(uint32_t i)
+{
+    NS_LOG_FUNCTION(this << i);
+    auto in = m_interfaces.find(i);
+    NS_ASSERT(in != m_interfaces.end());
+    in->second.m_socket->Close();
+    m_socketInterfaces.erase(in->second.m_socket);
+    in->second.m_broadcastSocket->Close();
+    m_socketInterfaces.erase(in->second.m_broadcastSocket);
+    m_interfaces.erase(in);
+}
+
 bool
 RoutingProtocol::IsMyOwnAddress(Ipv4Address src)
 {
     NS_LOG_FUNCTION(this << src);
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
     {
-        Ipv4InterfaceAddress iface = j->second;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
         if (src == iface.GetLocal())
         {
             return true;
@@ -1002,24 +1191,22 @@ RoutingProtocol::LoopbackRoute(const Ipv4Header& hdr, Ptr<NetDevice> oif) const
     // If RouteOutput() caller specified an outgoing interface, that
     // further constrains the selection of source address
     //
-    auto j = m_socketAddresses.begin();
+    auto j = m_interfaces.begin();
     if (oif)
     {
         // Iterate to find an address on the oif device
-        for (j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+        for (j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
         {
-            Ipv4Address addr = j->second.GetLocal();
-            int32_t interface = m_ipv4->GetInterfaceForAddress(addr);
-            if (oif == m_ipv4->GetNetDevice(static_cast<uint32_t>(interface)))
+            if (oif == j->second.m_device)
             {
-                rt->SetSource(addr);
+                rt->SetSource(j->second.m_iface.GetLocal());
                 break;
             }
         }
     }
     else
     {
-        rt->SetSource(j->second.GetLocal());
+        rt->SetSource(j->second.m_iface.GetLocal());
     }
     NS_ASSERT_MSG(rt->GetSource() != Ipv4Address(), "Valid raodv source address not found");
     rt->SetGateway(Ipv4Address("127.0.0.1"));
@@ -1034,6 +1221,16 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     // A node SHOULD NOT originate more than RREQ_RATELIMIT RREQ messages per second.
     if (m_rreqCount == m_rreqRateLimit)
     {
+        if (m_maxRreqDestinations > 1)
+        {
+            // Held until the rate limit window ends, then batched with the others
+            if (std::find(m_pendingRreqDst.begin(), m_pendingRreqDst.end(), dst) ==
+                m_pendingRreqDst.end())
+            {
+                m_pendingRreqDst.push_back(dst);
+            }
+            return;
+        }
         Simulator::Schedule(m_rreqRateLimitTimer.GetDelayLeft() + MicroSeconds(100),
                             &RoutingProtocol::SendRequest,
                             this,
@@ -1044,9 +1241,128 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     {
         m_rreqCount++;
     }
-    // Create RREQ header
+    SendMultiRequest(std::vector<Ipv4Address>(1, dst));
+}
+
+void
+RoutingProtocol::SendMultiRequest(const std::vector<Ipv4Address>& dsts)
+{
+    NS_LOG_FUNCTION(this << dsts.size());
+    NS_ASSERT(!dsts.empty());
+    // Create RREQ header, the first destination in the RFC fields
     RreqHeader rreqHeader;
-    rreqHeader.SetDst(dst);
+    uint16_t ttl = 0;
+    std::vector<uint32_t> ids;
+    for (auto i = dsts.begin(); i != dsts.end(); ++i)
+    {
+        RreqHeader::Destination request;
+        ttl = std::max(ttl, StartRouteDiscovery(*i, request));
+        m_requestId++;
+        request.m_id = m_requestId;
+        ids.push_back(m_requestId);
+        if (i == dsts.begin())
+        {
+            rreqHeader.SetDst(request.m_dst);
+            rreqHeader.SetDstSeqno(request.m_dstSeqNo);
+            rreqHeader.SetUnknownSeqno(request.m_unknownSeqNo);
+            rreqHeader.SetId(request.m_id);
+        }
+        else
+        {
+            rreqHeader.AddDestination(request);
+        }
+    }
+
+    if (m_gratuitousReply)
+    {
+        rreqHeader.SetGratuitousRrep(true);
+    }
+    if (m_destinationOnly)
+    {
+        rreqHeader.SetDestinationOnly(true);
+    }
+
+    if (m_linkCostMetric)
+    {
+        rreqHeader.SetCost(0);
+    }
+
+    m_seqNo++;
+    rreqHeader.SetOriginSeqno(m_seqNo);
+
+    // Send RREQ as subnet directed broadcast from each interface used by raodv
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
+    {
+        Ptr<Socket> socket = j->second.m_socket;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
+
+        rreqHeader.SetOrigin(iface.GetLocal());
+        for (auto id = ids.begin(); id != ids.end(); ++id)
+        {
+            m_rreqIdCache.IsDuplicate(iface.GetLocal(), *id);
+        }
+
+        Ptr<Packet> packet = Create<Packet>();
+        SocketIpTtlTag tag;
+        tag.SetTtl(ttl);
+        packet->AddPacketTag(tag);
+        packet->AddHeader(rreqHeader);
+        TypeHeader tHeader(RAODVTYPE_RREQ);
+        packet->AddHeader(tHeader);
+        // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+        Ipv4Address destination;
+        if (iface.GetMask() == Ipv4Mask::GetOnes())
+        {
+            destination = Ipv4Address("255.255.255.255");
+        }
+        else
+        {
+            destination = iface.GetBroadcast();
+        }
+        NS_LOG_DEBUG("Send RREQ with id " << rreqHeader.GetId() << " to socket");
+        m_lastBcastTime = Simulator::Now();
+        m_txScheduler.Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                               socket,
+                               packet,
+                               destination);
+    }
+    for (auto i = dsts.begin(); i != dsts.end(); ++i)
+    {
+        ScheduleRreqRetry(*i);
+    }
+}
+
+void
+RoutingProtocol::SendPendingRequests()
+{
+    NS_LOG_FUNCTION(this << m_pendingRreqDst.size());
+    auto i = m_pendingRreqDst.begin();
+    while (i != m_pendingRreqDst.end() && m_rreqCount < m_rreqRateLimit)
+    {
+        std::vector<Ipv4Address> dsts;
+        for (; i != m_pendingRreqDst.end() && dsts.size() < m_maxRreqDestinations; ++i)
+        {
+            // Routes found meanwhile, e.g. from the discovery of another node, need no RREQ
+            if (!m_routingTable.FindValidRoute(*i))
+            {
+                dsts.push_back(*i);
+            }
+        }
+        if (!dsts.empty())
+        {
+            m_rreqCount++;
+            SendMultiRequest(dsts);
+        }
+    }
+    m_pendingRreqDst.erase(m_pendingRreqDst.begin(), i);
+}
+
+uint16_t
+RoutingProtocol::StartRouteDiscovery(Ipv4Address dst, RreqHeader::Destination& request)
+{
+    request.m_dst = dst;
+    request.m_dstSeqNo = 0;
+    request.m_unknownSeqNo = false;
 
     RoutingTableEntry rt;
     // Using the Hop field in Routing Table to manage the expanding ring search
@@ -1071,11 +1387,11 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
         }
         if (rt.GetValidSeqNo())
         {
-            rreqHeader.SetDstSeqno(rt.GetSeqNo());
+            request.m_dstSeqNo = rt.GetSeqNo();
         }
         else
         {
-            rreqHeader.SetUnknownSeqno(true);
+            request.m_unknownSeqNo = true;
         }
         rt.SetHop(ttl);
         rt.SetFlag(IN_SEARCH);
@@ -1084,7 +1400,7 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
     }
     else
     {
-        rreqHeader.SetUnknownSeqno(true);
+        request.m_unknownSeqNo = true;
         Ptr<NetDevice> dev = nullptr;
         RoutingTableEntry newEntry(/*dev=*/dev,
                                    /*dst=*/dst,
@@ -1102,62 +1418,31 @@ RoutingProtocol::SendRequest(Ipv4Address dst)
         newEntry.SetFlag(IN_SEARCH);
         m_routingTable.AddRoute(newEntry);
     }
+    return ttl;
+}
 
-    if (m_gratuitousReply)
-    {
-        rreqHeader.SetGratuitousRrep(true);
-    }
-    if (m_destinationOnly)
-    {
-        rreqHeader.SetDestinationOnly(true);
-    }
-
-    m_seqNo++;
-    rreqHeader.SetOriginSeqno(m_seqNo);
-    m_requestId++;
-    rreqHeader.SetId(m_requestId);
-
-    // Send RREQ as subnet directed broadcast from each interface used by raodv
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
-    {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
-
-        rreqHeader.SetOrigin(iface.GetLocal());
-        m_rreqIdCache.IsDuplicate(iface.GetLocal(), m_requestId);
-
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag tag;
-        tag.SetTtl(ttl);
-        packet->AddPacketTag(tag);
-        packet->AddHeader(rreqHeader);
-        TypeHeader tHeader(RAODVTYPE_RREQ);
-        packet->AddHeader(tHeader);
-        // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
-        Ipv4Address destination;
-        if (iface.GetMask() == Ipv4Mask::GetOnes())
-        {
-            destination = Ipv4Address("255.255.255.255");
-        }
-        else
-        {
-            destination = iface.GetBroadcast();
-        }
-        NS_LOG_DEBUG("Send RREQ with id " << rreqHeader.GetId() << " to socket");
-        m_lastBcastTime = Simulator::Now();
-        Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
-                            &RoutingProtocol::SendTo,
-                            this,
-                            socket,
-                            packet,
-                            destination);
-    }
-    ScheduleRreqRetry(dst);
+RreqHeader
+RoutingProtocol::GetSingleRequest(const RreqHeader& rreqHeader,
+                                  const RreqHeader::Destination& request)
+{
+    RreqHeader single = rreqHeader;
+    single.ClearDestinations();
+    single.SetDst(request.m_dst);
+    single.SetId(request.m_id);
+    single.SetDstSeqno(request.m_dstSeqNo);
+    single.SetUnknownSeqno(request.m_unknownSeqNo);
+    return single;
 }
 
 void
 RoutingProtocol::SendTo(Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination)
 {
+    TypeHeader tHeader;
+    packet->PeekHeader(tHeader);
+    if (tHeader.IsValid())
+    {
+        CountMessage(tHeader.Get(), MESSAGE_SENT);
+    }
     socket->SendTo(packet, 0, InetSocketAddress(destination, RAODV_PORT));
 }
 
@@ -1199,25 +1484,29 @@ RoutingProtocol::RecvRaodv(Ptr<Socket> socket)
     Ptr<Packet> packet = socket->RecvFrom(sourceAddress);
     InetSocketAddress inetSourceAddr = InetSocketAddress::ConvertFrom(sourceAddress);
     Ipv4Address sender = inetSourceAddr.GetIpv4();
-    Ipv4Address receiver;
 
-    if (m_socketAddresses.find(socket) != m_socketAddresses.end())
-    {
-        receiver = m_socketAddresses[socket].GetLocal();
-    }
-    else if (m_socketSubnetBroadcastAddresses.find(socket) !=
-             m_socketSubnetBroadcastAddresses.end())
+    // Resolve the receiving interface once, the handlers get it from here
+    auto index = m_socketInterfaces.find(socket);
+    NS_ASSERT_MSG(index != m_socketInterfaces.end(), "Received a packet from an unknown socket");
+    const InterfaceSockets& in = m_interfaces.find(index->second)->second;
+    NS_LOG_DEBUG("raodv node " << this << " received a raodv packet from " << sender << " to "
+                              << in.m_iface.GetLocal());
+    if (m_linkCostMetric && m_lastRxTime == Simulator::Now())
     {
-        receiver = m_socketSubnetBroadcastAddresses[socket].GetLocal();
+        m_nb.UpdateSnr(sender, m_lastRxSnr);
     }
-    else
+
+    UpdateRouteToNeighbor(sender, in);
+    if (m_enableHello && m_adaptiveHello)
     {
-        NS_ASSERT_MSG(false, "Received a packet from an unknown socket");
+        // Any control message is an implicit hello from its sender, valid as long as the hellos
+        // of the current interval
+        if (!m_nb.IsNeighbor(sender))
+        {
+            ResetHelloInterval();
+        }
+        m_nb.Update(sender, Time(m_allowedHelloLoss * m_currentHelloInterval));
     }
-    NS_LOG_DEBUG("raodv node " << this << " received a raodv packet from " << sender << " to "
-                              << receiver);
-
-    UpdateRouteToNeighbor(sender, receiver);
     TypeHeader tHeader(RAODVTYPE_RREQ);
     packet->RemoveHeader(tHeader);
     if (!tHeader.IsValid())
@@ -1226,14 +1515,15 @@ RoutingProtocol::RecvRaodv(Ptr<Socket> socket)
                                      << tHeader.Get() << ". Drop");
         return; // drop
     }
+    CountMessage(tHeader.Get(), MESSAGE_RECEIVED);
     switch (tHeader.Get())
     {
     case RAODVTYPE_RREQ: {
-        RecvRequest(packet, receiver, sender);
+        RecvRequest(packet, in, sender);
         break;
     }
     case RAODVTYPE_RREP: {
-        RecvReply(packet, receiver, sender);
+        RecvReply(packet, in, sender);
         break;
     }
     case RAODVTYPE_RERR: {
@@ -1245,7 +1535,7 @@ RoutingProtocol::RecvRaodv(Ptr<Socket> socket)
         break;
     }
     case RAODVTYPE_R_RREQ: {
-        RevRecvRequest(packet, receiver, sender);
+        RevRecvRequest(packet, in, sender);
         break;
     }
     }
@@ -1255,35 +1545,28 @@ bool
 RoutingProtocol::UpdateRouteLifeTime(Ipv4Address addr, Time lifetime)
 {
     NS_LOG_FUNCTION(this << addr << lifetime);
-    RoutingTableEntry rt;
-    if (m_routingTable.LookupRoute(addr, rt))
+    if (m_routingTable.RefreshLifeTime(addr, lifetime))
     {
-        if (rt.GetFlag() == VALID)
-        {
-            NS_LOG_DEBUG("Updating VALID route");
-            rt.SetRreqCnt(0);
-            rt.SetLifeTime(std::max(lifetime, rt.GetLifeTime()));
-            m_routingTable.Update(rt);
-            return true;
-        }
+        NS_LOG_DEBUG("Updating VALID route");
+        return true;
     }
     return false;
 }
 
 void
-RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver)
+RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, const InterfaceSockets& in)
 {
-    NS_LOG_FUNCTION(this << "sender " << sender << " receiver " << receiver);
+    NS_LOG_FUNCTION(this << "sender " << sender << " receiver " << in.m_iface.GetLocal());
     RoutingTableEntry toNeighbor;
     if (!m_routingTable.LookupRoute(sender, toNeighbor))
     {
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+        Ptr<NetDevice> dev = in.m_device;
         RoutingTableEntry newEntry(
             /*dev=*/dev,
             /*dst=*/sender,
             /*vSeqNo=*/false,
             /*seqNo=*/0,
-            /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+            /*iface=*/in.m_iface,
             /*hops=*/1,
             /*nextHop=*/sender,
             /*lifetime=*/m_activeRouteTimeout);
@@ -1291,7 +1574,7 @@ RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver)
     }
     else
     {
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+        Ptr<NetDevice> dev = in.m_device;
         if (toNeighbor.GetValidSeqNo() && (toNeighbor.GetHop() == 1) &&
             (toNeighbor.GetOutputDevice() == dev))
         {
@@ -1304,7 +1587,7 @@ RoutingProtocol::UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver)
                 /*dst=*/sender,
                 /*vSeqNo=*/false,
                 /*seqNo=*/0,
-                /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+                /*iface=*/in.m_iface,
                 /*hops=*/1,
                 /*nextHop=*/sender,
                 /*lifetime=*/std::max(m_activeRouteTimeout, toNeighbor.GetLifeTime()));
@@ -1328,6 +1611,7 @@ RoutingProtocol::RevSendReply(const RreqHeader& rreqHeader, const RoutingTableEn
     {
         m_seqNo++;
     }
+    m_answeredRreqCache.IsDuplicate(rreqHeader.GetOrigin(), rreqHeader.GetDst(), m_seqNo);
 
    
         
@@ -1340,26 +1624,17 @@ RoutingProtocol::RevSendReply(const RreqHeader& rreqHeader, const RoutingTableEn
                        rreqHeader.GetOrigin(),
                        rreqHeader.GetOriginSeqno());
 
-    // Create a TypeHeader for RREP
-    TypeHeader tHeader(RAODVTYPE_R_RREQ);
+    // Serialize the reverse RREQ once, the packets of all interfaces share it
+    ControlMessage message(rrepHeader, RAODVTYPE_R_RREQ);
 
     // Iterate over all socket addresses to perform broadcast on each interface
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
-
-        // Create a new packet for each broadcast
-        Ptr<Packet> packet = Create<Packet>();
+        Ptr<Socket> socket = j->second.m_socket;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
 
-        // Set the TTL tag, decrementing if necessary
-        SocketIpTtlTag ttl;
-        ttl.SetTtl(/* Set appropriate TTL value, e.g., */ 1); 
-        packet->AddPacketTag(ttl);
-
-        // Add the RREP header and TypeHeader to the packet
-        packet->AddHeader(rrepHeader);
-        packet->AddHeader(tHeader);
+        // Create a new packet for each broadcast, with TTL 1
+        Ptr<Packet> packet = message.CreatePacket(1);
 
         // Determine the broadcast destination based on the interface's subnet mask
         Ipv4Address destination;
@@ -1378,21 +1653,17 @@ RoutingProtocol::RevSendReply(const RreqHeader& rreqHeader, const RoutingTableEn
         m_lastBcastTime = Simulator::Now();
 
         // Schedule the packet to be sent, optionally introducing a small random delay
-        Simulator::Schedule(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10)),
-                            &RoutingProtocol::SendTo,
-                            this,
-                            socket,
-                            packet,
-                            destination);
+        m_txScheduler.Schedule(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10)),
+                               socket,
+                               packet,
+                               destination);
 
         NS_LOG_INFO("Broadcasted RREP to " << destination);
     }
 }
 
-
-
 void
-RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
+RoutingProtocol::RevRecvRequest(Ptr<Packet> p, const InterfaceSockets& in, Ipv4Address src)
 {
     NS_LOG_FUNCTION(this);
     RevRreqHeader rreqHeader;
@@ -1412,14 +1683,40 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
     uint32_t id = rreqHeader.GetId();
     Ipv4Address origin = rreqHeader.GetOrigin();
 
+    /*
+     * Every copy of the reverse flood, duplicates included, shows a path to the destination which
+     * started it through the node it came from.
+     */
+    if (m_routingTable.GetMaxAlternates() > 0 && !IsMyOwnAddress(rreqHeader.GetDst()))
+    {
+        m_routingTable.AddAlternate(rreqHeader.GetDst(),
+                                    src,
+                                    rreqHeader.GetHopCount() + 1,
+                                    in.m_iface,
+                                    in.m_device,
+                                    m_activeRouteTimeout);
+    }
+
+    // Copies of a reverse RREQ held for rebroadcast count towards its suppression
+    auto pending = m_pendingRevRreq.find(std::make_pair(origin, rreqHeader.GetDst()));
+    if (pending != m_pendingRevRreq.end() && pending->second.m_header.GetId() == id)
+    {
+        pending->second.m_copies++;
+        NS_LOG_DEBUG("Ignoring RREQ due to duplicate, " << pending->second.m_copies
+                                                        << " copies heard");
+        CountMessage(RAODVTYPE_R_RREQ, MESSAGE_SUPPRESSED);
+        return;
+    }
+
     /*
      * Node checks to determine whether it has received a RREQ with the same Originator IP Address
      * and RREQ ID. If such a RREQ has been received, the node silently discards the newly received
      * RREQ.
      */
-    if (m_rreqIdCache.IsDuplicate(origin, id))
+    if (CountDuplicate(m_rreqIdCache.IsDuplicate(origin, id)))
     {
         NS_LOG_DEBUG("Ignoring RREQ due to duplicate");
+        CountMessage(RAODVTYPE_R_RREQ, MESSAGE_SUPPRESSED);
         return;
     }
 
@@ -1438,13 +1735,13 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
     RoutingTableEntry toOrigin;
     if (!m_routingTable.LookupRoute(origin, toOrigin))
     {
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+        Ptr<NetDevice> dev = in.m_device;
         RoutingTableEntry newEntry(
             /*dev=*/dev,
             /*dst=*/origin,
             /*vSeqNo=*/true,
             /*seqNo=*/rreqHeader.GetOriginSeqno(),
-            /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+            /*iface=*/in.m_iface,
             /*hops=*/hop,
             /*nextHop=*/src,
             /*lifetime=*/Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime));
@@ -1465,8 +1762,8 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
         }
         toOrigin.SetValidSeqNo(true);
         toOrigin.SetNextHop(src);
-        toOrigin.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
-        toOrigin.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
+        toOrigin.SetOutputDevice(in.m_device);
+        toOrigin.SetInterface(in.m_iface);
         toOrigin.SetHop(hop);
         toOrigin.SetLifeTime(std::max(Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime),
                                       toOrigin.GetLifeTime()));
@@ -1474,11 +1771,9 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
         // m_nb.Update (src, Time (AllowedHelloLoss * HelloInterval));
     }
 
-   
-   
     m_nb.Update(src, Time(m_allowedHelloLoss * m_helloInterval));
 
-    NS_LOG_LOGIC(receiver << " received RREQ with hop count "
+    NS_LOG_LOGIC(in.m_iface.GetLocal() << " received RREQ with hop count "
                           << static_cast<uint32_t>(rreqHeader.GetHopCount()) << " ID "
                           << rreqHeader.GetId() << " to destination " << rreqHeader.GetDst());
 
@@ -1520,20 +1815,14 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
                        rreqHeader.GetOrigin(),
                        rreqHeader.GetOriginSeqno());
 
-            TypeHeader tHeader(RAODVTYPE_R_RREQ);
-
-            Ptr<Packet> packet = Create<Packet>();
-            SocketIpTtlTag ttlTag;
-            ttlTag.SetTtl(toOrigin.GetHop());
-            packet->AddPacketTag(ttlTag);
-            packet->AddHeader(rrepHeader);
-            packet->AddHeader(tHeader);
+            Ptr<Packet> packet =
+                ControlMessage(rrepHeader, RAODVTYPE_R_RREQ).CreatePacket(toOrigin.GetHop());
 
             Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
             NS_ASSERT(socket);
 
             // Unicast the RREP to the originator
-            socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), RAODV_PORT));
+            SendTo(socket, packet, toOrigin.GetNextHop());
 
             NS_LOG_INFO("Unicasted RREP to " << toOrigin.GetNextHop());
         }
@@ -1557,27 +1846,27 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
                        rreqHeader.GetOrigin(),
                        rreqHeader.GetOriginSeqno());
 
-            TypeHeader tHeader(RAODVTYPE_R_RREQ);
+            // The rebroadcast goes one hop less far than the received reverse RREQ
+            SocketIpTtlTag tag;
+            p->PeekPacketTag(tag);
+            if (tag.GetTtl() < 2)
+            {
+                NS_LOG_DEBUG("TTL exceeded. Drop RREQ origin " << src << " destination "
+                                                               << rreqHeader.GetDst());
+                return;
+            }
+
+            // Serialize the reverse RREQ once, the packets of all interfaces share it
+            ControlMessage message(rrepHeader, RAODVTYPE_R_RREQ);
 
             // Iterate over all socket addresses to perform broadcast on each interface
-            for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+            for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
             {
-                Ptr<Socket> socket = j->first;
-                Ipv4InterfaceAddress iface = j->second;
+                Ptr<Socket> socket = j->second.m_socket;
+                Ipv4InterfaceAddress iface = j->second.m_iface;
 
                 // Create a new packet for each broadcast
-                Ptr<Packet> packet = Create<Packet>();
-                SocketIpTtlTag tag;
-
-                // Set the TTL tag, typically 1 for local broadcast
-                SocketIpTtlTag ttlTag;
-                //ttlTag.SetTtl(1); 
-                ttlTag.SetTtl(tag.GetTtl()-1);
-                packet->AddPacketTag(ttlTag);
-
-                // Add headers to the packet
-                packet->AddHeader(rrepHeader);
-                packet->AddHeader(tHeader);
+                Ptr<Packet> packet = message.CreatePacket(tag.GetTtl() - 1);
 
                 // Determine the broadcast destination based on the interface's subnet mask
                 Ipv4Address destination;
@@ -1596,14 +1885,10 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
                 m_lastBcastTime = Simulator::Now();
 
                 // Schedule the packet to be sent, optionally introducing a small random delay
-                Simulator::Schedule(
-                    MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10)),
-                    &RoutingProtocol::SendTo,
-                    this,
-                    socket,
-                    packet,
-                    destination
-                );
+                m_txScheduler.Schedule(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10)),
+                                       socket,
+                                       packet,
+                                       destination);
 
                 NS_LOG_INFO("Broadcasted RREP to " << destination);
             }
@@ -1661,21 +1946,103 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
         return;
     }
 
-    /*
-     * **Original RREQ Broadcast Logic Starts Here**
-     * The node rebroadcasts the RREQ if it has not already generated a RREP.
-     */
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    // The node rebroadcasts the RREQ if it has not already generated a RREP.
+    ForwardRevRreq(rreqHeader, tag.GetTtl() - 1);
+}
+
+void
+RoutingProtocol::ForwardRevRreq(const RevRreqHeader& rreqHeader, uint8_t ttl)
+{
+    NS_LOG_FUNCTION(this << rreqHeader.GetOrigin() << rreqHeader.GetDst());
+    Ipv4Address origin = rreqHeader.GetOrigin();
+    Ipv4Address dst = rreqHeader.GetDst();
+    if (m_revRreqSuppressAnswered &&
+        m_answeredRreqCache.Contains(origin, dst, rreqHeader.GetDstSeqno()))
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag ttl;
-        ttl.SetTtl(tag.GetTtl() - 1);
-        packet->AddPacketTag(ttl);
-        packet->AddHeader(rreqHeader);
-        TypeHeader tHeader(RAODVTYPE_R_RREQ);
-        packet->AddHeader(tHeader);
+        NS_LOG_DEBUG("Suppress RREQ origin " << origin << " destination " << dst
+                                             << ", already answered");
+        CountMessage(RAODVTYPE_R_RREQ, MESSAGE_SUPPRESSED);
+        return;
+    }
+    if (m_revRreqCounterThreshold == 0 && !m_revRreqAggregation)
+    {
+        BroadcastRevRreq(rreqHeader, ttl);
+        return;
+    }
+
+    auto key = std::make_pair(origin, dst);
+    auto i = m_pendingRevRreq.find(key);
+    if (i != m_pendingRevRreq.end())
+    {
+        if (m_revRreqAggregation)
+        {
+            // Merge into the held rebroadcast, keeping the most recent discovery
+            PendingRevRreq& pending = i->second;
+            if (int32_t(rreqHeader.GetId() - pending.m_header.GetId()) > 0)
+            {
+                pending.m_header = rreqHeader;
+                pending.m_copies = 0;
+            }
+            pending.m_ttl = std::max(pending.m_ttl, ttl);
+            NS_LOG_DEBUG("Merge RREQ origin " << origin << " destination " << dst << " ID "
+                                              << rreqHeader.GetId());
+            CountMessage(RAODVTYPE_R_RREQ, MESSAGE_SUPPRESSED);
+            return;
+        }
+        // A newer discovery ends the assessment of the previous one
+        i->second.m_event.Cancel();
+        RevRreqAssessmentExpire(origin, dst);
+    }
+    PendingRevRreq& pending = m_pendingRevRreq[key];
+    pending.m_header = rreqHeader;
+    pending.m_ttl = ttl;
+    pending.m_copies = 0;
+    pending.m_event = Simulator::Schedule(m_revRreqAssessmentDelay,
+                                          &RoutingProtocol::RevRreqAssessmentExpire,
+                                          this,
+                                          origin,
+                                          dst);
+}
+
+void
+RoutingProtocol::RevRreqAssessmentExpire(Ipv4Address origin, Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << origin << dst);
+    auto i = m_pendingRevRreq.find(std::make_pair(origin, dst));
+    if (i == m_pendingRevRreq.end())
+    {
+        return;
+    }
+    PendingRevRreq pending = i->second;
+    m_pendingRevRreq.erase(i);
+    if (m_revRreqCounterThreshold > 0 && pending.m_copies >= m_revRreqCounterThreshold)
+    {
+        NS_LOG_DEBUG("Suppress RREQ origin " << origin << " destination " << dst << ", "
+                                             << pending.m_copies << " copies heard");
+        CountMessage(RAODVTYPE_R_RREQ, MESSAGE_SUPPRESSED);
+        return;
+    }
+    if (m_revRreqSuppressAnswered &&
+        m_answeredRreqCache.Contains(origin, dst, pending.m_header.GetDstSeqno()))
+    {
+        NS_LOG_DEBUG("Suppress RREQ origin " << origin << " destination " << dst
+                                             << ", already answered");
+        CountMessage(RAODVTYPE_R_RREQ, MESSAGE_SUPPRESSED);
+        return;
+    }
+    BroadcastRevRreq(pending.m_header, pending.m_ttl);
+}
+
+void
+RoutingProtocol::BroadcastRevRreq(const RevRreqHeader& rreqHeader, uint8_t ttl)
+{
+    NS_LOG_FUNCTION(this << rreqHeader.GetOrigin() << rreqHeader.GetDst());
+    ControlMessage message(rreqHeader, RAODVTYPE_R_RREQ);
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
+    {
+        Ptr<Socket> socket = j->second.m_socket;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
+        Ptr<Packet> packet = message.CreatePacket(ttl);
         // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
         Ipv4Address destination;
         if (iface.GetMask() == Ipv4Mask::GetOnes())
@@ -1687,23 +2054,18 @@ RoutingProtocol::RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address
             destination = iface.GetBroadcast();
         }
         m_lastBcastTime = Simulator::Now();
-        Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
-                            &RoutingProtocol::SendTo,
-                            this,
-                            socket,
-                            packet,
-                            destination);
+        m_txScheduler.Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                               socket,
+                               packet,
+                               destination);
     }
-    /*
-     * **Original RREQ Broadcast Logic Ends Here**
-     */
 }
 
 
 
 
 void
-RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src)
+RoutingProtocol::RecvRequest(Ptr<Packet> p, const InterfaceSockets& in, Ipv4Address src)
 {
     NS_LOG_FUNCTION(this);
     RreqHeader rreqHeader;
@@ -1728,15 +2090,31 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
      * and RREQ ID. If such a RREQ has been received, the node silently discards the newly received
      * RREQ.
      */
-    if (m_rreqIdCache.IsDuplicate(origin, id))
+    uint16_t cost = m_linkCostMetric ? AddLinkCost(rreqHeader.GetCost(), src) : 0;
+    if (CountDuplicate(m_rreqIdCache.IsDuplicate(origin, id)))
     {
         NS_LOG_DEBUG("Ignoring RREQ due to duplicate");
+        CountMessage(RAODVTYPE_RREQ, MESSAGE_SUPPRESSED);
+        if (m_linkCostMetric)
+        {
+            // A later copy may still have come through a cheaper path
+            ImproveRoute(origin,
+                         rreqHeader.GetOriginSeqno(),
+                         src,
+                         in,
+                         rreqHeader.GetHopCount() + 1,
+                         cost);
+        }
         return;
     }
 
     // Increment RREQ hop count
     uint8_t hop = rreqHeader.GetHopCount() + 1;
     rreqHeader.SetHopCount(hop);
+    if (m_linkCostMetric)
+    {
+        rreqHeader.SetCost(cost);
+    }
 
     /*
      *  When the reverse route is created or updated, the following actions on the route are also
@@ -1752,16 +2130,17 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
     RoutingTableEntry toOrigin;
     if (!m_routingTable.LookupRoute(origin, toOrigin))
     {
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+        Ptr<NetDevice> dev = in.m_device;
         RoutingTableEntry newEntry(
             /*dev=*/dev,
             /*dst=*/origin,
             /*vSeqNo=*/true,
             /*seqNo=*/rreqHeader.GetOriginSeqno(),
-            /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+            /*iface=*/in.m_iface,
             /*hops=*/hop,
             /*nextHop=*/src,
             /*lifetime=*/Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime));
+        newEntry.SetCost(cost);
         m_routingTable.AddRoute(newEntry);
     }
     else
@@ -1779,9 +2158,10 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         }
         toOrigin.SetValidSeqNo(true);
         toOrigin.SetNextHop(src);
-        toOrigin.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
-        toOrigin.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
+        toOrigin.SetOutputDevice(in.m_device);
+        toOrigin.SetInterface(in.m_iface);
         toOrigin.SetHop(hop);
+        toOrigin.SetCost(cost);
         toOrigin.SetLifeTime(std::max(Time(2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime),
                                       toOrigin.GetLifeTime()));
         m_routingTable.Update(toOrigin);
@@ -1792,12 +2172,12 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
     if (!m_routingTable.LookupRoute(src, toNeighbor))
     {
         NS_LOG_DEBUG("Neighbor:" << src << " not found in routing table. Creating an entry");
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+        Ptr<NetDevice> dev = in.m_device;
         RoutingTableEntry newEntry(dev,
                                    src,
                                    false,
                                    rreqHeader.GetOriginSeqno(),
-                                   m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+                                   in.m_iface,
                                    1,
                                    src,
                                    m_activeRouteTimeout);
@@ -1809,27 +2189,89 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         toNeighbor.SetValidSeqNo(false);
         toNeighbor.SetSeqNo(rreqHeader.GetOriginSeqno());
         toNeighbor.SetFlag(VALID);
-        toNeighbor.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
-        toNeighbor.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
+        toNeighbor.SetOutputDevice(in.m_device);
+        toNeighbor.SetInterface(in.m_iface);
         toNeighbor.SetHop(1);
         toNeighbor.SetNextHop(src);
         m_routingTable.Update(toNeighbor);
     }
     m_nb.Update(src, Time(m_allowedHelloLoss * m_helloInterval));
 
-    NS_LOG_LOGIC(receiver << " receive RREQ with hop count "
+    NS_LOG_LOGIC(in.m_iface.GetLocal() << " receive RREQ with hop count "
                           << static_cast<uint32_t>(rreqHeader.GetHopCount()) << " ID "
                           << rreqHeader.GetId() << " to destination " << rreqHeader.GetDst());
 
+    // The destinations answered here are removed from the rebroadcast, as are the ones already
+    // handled through another copy
+    std::vector<RreqHeader::Destination> forward;
+    for (auto i = requests.begin(); i != requests.end(); ++i)
+    {
+        if (HandleRequest(GetSingleRequest(rreqHeader, *i), src, origin, *i))
+        {
+            forward.push_back(*i);
+        }
+    }
+    if (forward.empty())
+    {
+        return;
+    }
+
+    SocketIpTtlTag tag;
+    p->RemovePacketTag(tag);
+    if (tag.GetTtl() < 2)
+    {
+        NS_LOG_DEBUG("TTL exceeded. Drop RREQ origin " << src << " destination "
+                                                       << forward.front().m_dst);
+        return;
+    }
+    rreqHeader = GetSingleRequest(rreqHeader, forward.front());
+    for (auto i = forward.begin() + 1; i != forward.end(); ++i)
+    {
+        rreqHeader.AddDestination(*i);
+    }
+
+    // The forwarded RREQ is the same on every interface, serialize it once
+    ControlMessage message(rreqHeader, RAODVTYPE_RREQ);
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
+    {
+        Ptr<Socket> socket = j->second.m_socket;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
+        Ptr<Packet> packet = message.CreatePacket(tag.GetTtl() - 1);
+        // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+        Ipv4Address destination;
+        if (iface.GetMask() == Ipv4Mask::GetOnes())
+        {
+            destination = Ipv4Address("255.255.255.255");
+        }
+        else
+        {
+            destination = iface.GetBroadcast();
+        }
+        m_lastBcastTime = Simulator::Now();
+        m_txScheduler.Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                               socket,
+                               packet,
+                               destination);
+    }
+}
+
+bool
+RoutingProtocol::HandleRequest(const RreqHeader& rreqHeader,
+                               Ipv4Address src,
+                               Ipv4Address origin,
+                               RreqHeader::Destination& request)
+{
+    NS_LOG_FUNCTION(this << request.m_dst);
+    RoutingTableEntry toOrigin;
     //  A node generates a RREP if either:
     //  (i)  it is itself the destination,
-    if (IsMyOwnAddress(rreqHeader.GetDst()))
+    if (IsMyOwnAddress(request.m_dst))
     {
         m_routingTable.LookupRoute(origin, toOrigin);
         NS_LOG_DEBUG("Send reply since I am the destination");
         // SendReply(rreqHeader, toOrigin);
         RevSendReply(rreqHeader, toOrigin);
-        return;
+        return false;
     }
     /*
      * (ii) or it has an active route to the destination, the destination sequence number in the
@@ -1837,8 +2279,7 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
      * the Destination Sequence Number of the RREQ, and the "destination only" flag is NOT set.
      */
     RoutingTableEntry toDst;
-    Ipv4Address dst = rreqHeader.GetDst();
-    if (m_routingTable.LookupRoute(dst, toDst))
+    if (m_routingTable.LookupRoute(request.m_dst, toDst))
     {
         /*
          * Drop RREQ, This node RREP will make a loop.
@@ -1846,7 +2287,7 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
         if (toDst.GetNextHop() == src)
         {
             NS_LOG_DEBUG("Drop RREQ from " << src << ", dest next hop " << toDst.GetNextHop());
-            return;
+            return false;
         }
         /*
          * The Destination Sequence number for the requested destination is set to the maximum of
@@ -1856,58 +2297,67 @@ RoutingProtocol::RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sr
          * the value received in the incoming RREQ is larger than the value currently maintained by
          * the forwarding node.
          */
-        if ((rreqHeader.GetUnknownSeqno() ||
-             (int32_t(toDst.GetSeqNo()) - int32_t(rreqHeader.GetDstSeqno()) >= 0)) &&
+        if ((request.m_unknownSeqNo ||
+             (int32_t(toDst.GetSeqNo()) - int32_t(request.m_dstSeqNo) >= 0)) &&
             toDst.GetValidSeqNo())
         {
             if (!rreqHeader.GetDestinationOnly() && toDst.GetFlag() == VALID)
             {
                 m_routingTable.LookupRoute(origin, toOrigin);
                 SendReplyByIntermediateNode(toDst, toOrigin, rreqHeader.GetGratuitousRrep());
-                return;
+                return false;
             }
-            rreqHeader.SetDstSeqno(toDst.GetSeqNo());
-            rreqHeader.SetUnknownSeqno(false);
+            request.m_dstSeqNo = toDst.GetSeqNo();
+            request.m_unknownSeqNo = false;
         }
     }
+    return true;
+}
 
-    SocketIpTtlTag tag;
-    p->RemovePacketTag(tag);
-    if (tag.GetTtl() < 2)
+void
+RoutingProtocol::ImproveRoute(Ipv4Address dst,
+                              uint32_t seqNo,
+                              Ipv4Address nextHop,
+                              const InterfaceSockets& in,
+                              uint16_t hop,
+                              uint32_t cost)
+{
+    NS_LOG_FUNCTION(this << dst << nextHop << cost);
+    RoutingTableEntry rt;
+    if (!m_routingTable.LookupRoute(dst, rt) || rt.GetFlag() != VALID || rt.GetSeqNo() != seqNo ||
+        rt.GetNextHop() == nextHop || cost >= GetPathCost(rt))
     {
-        NS_LOG_DEBUG("TTL exceeded. Drop RREQ origin " << src << " destination " << dst);
         return;
     }
+    NS_LOG_LOGIC("Route to " << dst << " moves from " << rt.GetNextHop() << " to " << nextHop
+                             << ", cost " << GetPathCost(rt) << " -> " << cost);
+    rt.SetNextHop(nextHop);
+    rt.SetOutputDevice(in.m_device);
+    rt.SetInterface(in.m_iface);
+    rt.SetHop(hop);
+    rt.SetCost(cost);
+    m_routingTable.Update(rt);
+}
 
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+uint32_t
+RoutingProtocol::GetPathCost(const RoutingTableEntry& rt)
+{
+    if (rt.GetCost() != 0)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag ttl;
-        ttl.SetTtl(tag.GetTtl() - 1);
-        packet->AddPacketTag(ttl);
-        packet->AddHeader(rreqHeader);
-        TypeHeader tHeader(RAODVTYPE_RREQ);
-        packet->AddHeader(tHeader);
-        // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
-        Ipv4Address destination;
-        if (iface.GetMask() == Ipv4Mask::GetOnes())
-        {
-            destination = Ipv4Address("255.255.255.255");
-        }
-        else
-        {
-            destination = iface.GetBroadcast();
-        }
-        m_lastBcastTime = Simulator::Now();
-        Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
-                            &RoutingProtocol::SendTo,
-                            this,
-                            socket,
-                            packet,
-                            destination);
+        return rt.GetCost();
     }
+    if (rt.GetHop() == 1)
+    {
+        return m_nb.GetLinkCost(rt.GetNextHop());
+    }
+    return rt.GetHop() * Neighbors::LINK_COST_UNIT;
+}
+
+uint16_t
+RoutingProtocol::AddLinkCost(uint32_t cost, Ipv4Address neighbor) const
+{
+    return std::min<uint32_t>(cost + m_nb.GetLinkCost(neighbor),
+                              std::numeric_limits<uint16_t>::max());
 }
 
 void
@@ -1929,16 +2379,15 @@ RoutingProtocol::SendReply(const RreqHeader& rreqHeader, const RoutingTableEntry
                           /*dstSeqNo=*/m_seqNo,
                           /*origin=*/toOrigin.GetDestination(),
                           /*lifetime=*/m_myRouteTimeout);
-    Ptr<Packet> packet = Create<Packet>();
-    SocketIpTtlTag tag;
-    tag.SetTtl(toOrigin.GetHop());
-    packet->AddPacketTag(tag);
-    packet->AddHeader(rrepHeader);
-    TypeHeader tHeader(RAODVTYPE_RREP);
-    packet->AddHeader(tHeader);
+    if (m_linkCostMetric)
+    {
+        rrepHeader.SetCost(0);
+    }
+    m_answeredRreqCache.IsDuplicate(toOrigin.GetDestination(), rreqHeader.GetDst(), m_seqNo);
+    Ptr<Packet> packet = ControlMessage(rrepHeader, RAODVTYPE_RREP).CreatePacket(toOrigin.GetHop());
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
     NS_ASSERT(socket);
-    socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), RAODV_PORT));
+    SendTo(socket, packet, toOrigin.GetNextHop());
 }
 
 void
@@ -1953,6 +2402,11 @@ RoutingProtocol::SendReplyByIntermediateNode(RoutingTableEntry& toDst,
                           /*dstSeqNo=*/toDst.GetSeqNo(),
                           /*origin=*/toOrigin.GetDestination(),
                           /*lifetime=*/toDst.GetLifeTime());
+    if (m_linkCostMetric)
+    {
+        rrepHeader.SetCost(
+            std::min<uint32_t>(GetPathCost(toDst), std::numeric_limits<uint16_t>::max()));
+    }
     /* If the node we received a RREQ for is a neighbor we are
      * probably facing a unidirectional link... Better request a RREP-ack
      */
@@ -1969,17 +2423,14 @@ RoutingProtocol::SendReplyByIntermediateNode(RoutingTableEntry& toDst,
     toOrigin.InsertPrecursor(toDst.GetNextHop());
     m_routingTable.Update(toDst);
     m_routingTable.Update(toOrigin);
+    m_answeredRreqCache.IsDuplicate(toOrigin.GetDestination(),
+                                    toDst.GetDestination(),
+                                    toDst.GetSeqNo());
 
-    Ptr<Packet> packet = Create<Packet>();
-    SocketIpTtlTag tag;
-    tag.SetTtl(toOrigin.GetHop());
-    packet->AddPacketTag(tag);
-    packet->AddHeader(rrepHeader);
-    TypeHeader tHeader(RAODVTYPE_RREP);
-    packet->AddHeader(tHeader);
+    Ptr<Packet> packet = ControlMessage(rrepHeader, RAODVTYPE_RREP).CreatePacket(toOrigin.GetHop());
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
     NS_ASSERT(socket);
-    socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), RAODV_PORT));
+    SendTo(socket, packet, toOrigin.GetNextHop());
 
     // Generating gratuitous RREPs
     if (gratRep)
@@ -1990,17 +2441,12 @@ RoutingProtocol::SendReplyByIntermediateNode(RoutingTableEntry& toDst,
                                  /*dstSeqNo=*/toOrigin.GetSeqNo(),
                                  /*origin=*/toDst.GetDestination(),
                                  /*lifetime=*/toOrigin.GetLifeTime());
-        Ptr<Packet> packetToDst = Create<Packet>();
-        SocketIpTtlTag gratTag;
-        gratTag.SetTtl(toDst.GetHop());
-        packetToDst->AddPacketTag(gratTag);
-        packetToDst->AddHeader(gratRepHeader);
-        TypeHeader type(RAODVTYPE_RREP);
-        packetToDst->AddHeader(type);
+        Ptr<Packet> packetToDst =
+            ControlMessage(gratRepHeader, RAODVTYPE_RREP).CreatePacket(toDst.GetHop());
         Ptr<Socket> socket = FindSocketWithInterfaceAddress(toDst.GetInterface());
         NS_ASSERT(socket);
         NS_LOG_LOGIC("Send gratuitous RREP " << packet->GetUid());
-        socket->SendTo(packetToDst, 0, InetSocketAddress(toDst.GetNextHop(), RAODV_PORT));
+        SendTo(socket, packetToDst, toDst.GetNextHop());
     }
 }
 
@@ -2020,11 +2466,11 @@ RoutingProtocol::SendReplyAck(Ipv4Address neighbor)
     m_routingTable.LookupRoute(neighbor, toNeighbor);
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(toNeighbor.GetInterface());
     NS_ASSERT(socket);
-    socket->SendTo(packet, 0, InetSocketAddress(neighbor, RAODV_PORT));
+    SendTo(socket, packet, neighbor);
 }
 
 void
-RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sender)
+RoutingProtocol::RecvReply(Ptr<Packet> p, const InterfaceSockets& in, Ipv4Address sender)
 {
     NS_LOG_FUNCTION(this << " src " << sender);
     RrepHeader rrepHeader;
@@ -2038,9 +2484,15 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
     // If RREP is Hello message
     if (dst == rrepHeader.GetOrigin())
     {
-        ProcessHello(rrepHeader, receiver);
+        ProcessHello(rrepHeader, in);
         return;
     }
+    uint16_t cost = 0;
+    if (m_linkCostMetric)
+    {
+        cost = AddLinkCost(rrepHeader.GetCost(), sender);
+        rrepHeader.SetCost(cost);
+    }
 
     /*
      * If the route table entry to the destination is created or updated, then the following actions
@@ -2055,16 +2507,17 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
      * -  and the destination sequence number is the Destination Sequence Number in the RREP
      * message.
      */
-    Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+    Ptr<NetDevice> dev = in.m_device;
     RoutingTableEntry newEntry(
         /*dev=*/dev,
         /*dst=*/dst,
         /*vSeqNo=*/true,
         /*seqNo=*/rrepHeader.GetDstSeqno(),
-        /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+        /*iface=*/in.m_iface,
         /*hops=*/hop,
         /*nextHop=*/sender,
         /*lifetime=*/rrepHeader.GetLifeTime());
+    newEntry.SetCost(cost);
     RoutingTableEntry toDst;
     if (m_routingTable.LookupRoute(dst, toDst))
     {
@@ -2082,8 +2535,9 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
             (rrepHeader.GetDstSeqno() == toDst.GetSeqNo() && toDst.GetFlag() != VALID) ||
 
             // (iv) the sequence numbers are the same, and the New Hop Count is smaller than the
-            // hop count in route table entry.
-            (rrepHeader.GetDstSeqno() == toDst.GetSeqNo() && hop < toDst.GetHop()))
+            // hop count in route table entry, or the path cost if link costs are used.
+            (rrepHeader.GetDstSeqno() == toDst.GetSeqNo() &&
+             (m_linkCostMetric ? cost < GetPathCost(toDst) : hop < toDst.GetHop())))
         {
             m_routingTable.Update(newEntry);
         }
@@ -2100,7 +2554,7 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
         SendReplyAck(sender);
         rrepHeader.SetAckRequired(false);
     }
-    NS_LOG_LOGIC("receiver " << receiver << " origin " << rrepHeader.GetOrigin());
+    NS_LOG_LOGIC("receiver " << in.m_iface.GetLocal() << " origin " << rrepHeader.GetOrigin());
     if (IsMyOwnAddress(rrepHeader.GetOrigin()))
     {
         if (toDst.GetFlag() == IN_SEARCH)
@@ -2150,17 +2604,13 @@ RoutingProtocol::RecvReply(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address send
                                                             << rrepHeader.GetOrigin());
         return;
     }
+    m_answeredRreqCache.IsDuplicate(rrepHeader.GetOrigin(), dst, rrepHeader.GetDstSeqno());
 
-    Ptr<Packet> packet = Create<Packet>();
-    SocketIpTtlTag ttl;
-    ttl.SetTtl(tag.GetTtl() - 1);
-    packet->AddPacketTag(ttl);
-    packet->AddHeader(rrepHeader);
-    TypeHeader tHeader(RAODVTYPE_RREP);
-    packet->AddHeader(tHeader);
+    Ptr<Packet> packet =
+        ControlMessage(rrepHeader, RAODVTYPE_RREP).CreatePacket(tag.GetTtl() - 1);
     Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
     NS_ASSERT(socket);
-    socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), RAODV_PORT));
+    SendTo(socket, packet, toOrigin.GetNextHop());
 }
 
 void
@@ -2177,7 +2627,7 @@ RoutingProtocol::RecvReplyAck(Ipv4Address neighbor)
 }
 
 void
-RoutingProtocol::ProcessHello(const RrepHeader& rrepHeader, Ipv4Address receiver)
+RoutingProtocol::ProcessHello(const RrepHeader& rrepHeader, const InterfaceSockets& in)
 {
     NS_LOG_FUNCTION(this << "from " << rrepHeader.GetDst());
     /*
@@ -2185,16 +2635,22 @@ RoutingProtocol::ProcessHello(const RrepHeader& rrepHeader, Ipv4Address receiver
      * SHOULD make sure that it has an active route to the neighbor, and
      * create one if necessary.
      */
+    Time lifetime = Time(m_allowedHelloLoss * m_helloInterval);
+    if (m_adaptiveHello)
+    {
+        // The neighbor announces how long its hello is valid, which grows with its interval
+        lifetime = std::max(lifetime, rrepHeader.GetLifeTime());
+    }
     RoutingTableEntry toNeighbor;
     if (!m_routingTable.LookupRoute(rrepHeader.GetDst(), toNeighbor))
     {
-        Ptr<NetDevice> dev = m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver));
+        Ptr<NetDevice> dev = in.m_device;
         RoutingTableEntry newEntry(
             /*dev=*/dev,
             /*dst=*/rrepHeader.GetDst(),
             /*vSeqNo=*/true,
             /*seqNo=*/rrepHeader.GetDstSeqno(),
-            /*iface=*/m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0),
+            /*iface=*/in.m_iface,
             /*hops=*/1,
             /*nextHop=*/rrepHeader.GetDst(),
             /*lifetime=*/rrepHeader.GetLifeTime());
@@ -2202,20 +2658,19 @@ RoutingProtocol::ProcessHello(const RrepHeader& rrepHeader, Ipv4Address receiver
     }
     else
     {
-        toNeighbor.SetLifeTime(
-            std::max(Time(m_allowedHelloLoss * m_helloInterval), toNeighbor.GetLifeTime()));
+        toNeighbor.SetLifeTime(std::max(lifetime, toNeighbor.GetLifeTime()));
         toNeighbor.SetSeqNo(rrepHeader.GetDstSeqno());
         toNeighbor.SetValidSeqNo(true);
         toNeighbor.SetFlag(VALID);
-        toNeighbor.SetOutputDevice(m_ipv4->GetNetDevice(m_ipv4->GetInterfaceForAddress(receiver)));
-        toNeighbor.SetInterface(m_ipv4->GetAddress(m_ipv4->GetInterfaceForAddress(receiver), 0));
+        toNeighbor.SetOutputDevice(in.m_device);
+        toNeighbor.SetInterface(in.m_iface);
         toNeighbor.SetHop(1);
         toNeighbor.SetNextHop(rrepHeader.GetDst());
         m_routingTable.Update(toNeighbor);
     }
     if (m_enableHello)
     {
-        m_nb.Update(rrepHeader.GetDst(), Time(m_allowedHelloLoss * m_helloInterval));
+        m_nb.Update(rrepHeader.GetDst(), lifetime);
     }
 }
 
@@ -2245,14 +2700,7 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
     {
         if (!rerrHeader.AddUnDestination(i->first, i->second))
         {
-            TypeHeader typeHeader(RAODVTYPE_RERR);
-            Ptr<Packet> packet = Create<Packet>();
-            SocketIpTtlTag tag;
-            tag.SetTtl(1);
-            packet->AddPacketTag(tag);
-            packet->AddHeader(rerrHeader);
-            packet->AddHeader(typeHeader);
-            SendRerrMessage(packet, precursors);
+            SendRerrMessage(ControlMessage(rerrHeader, RAODVTYPE_RERR), precursors);
             rerrHeader.Clear();
         }
         else
@@ -2265,16 +2713,13 @@ RoutingProtocol::RecvError(Ptr<Packet> p, Ipv4Address src)
     }
     if (rerrHeader.GetDestCount() != 0)
     {
-        TypeHeader typeHeader(RAODVTYPE_RERR);
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag tag;
-        tag.SetTtl(1);
-        packet->AddPacketTag(tag);
-        packet->AddHeader(rerrHeader);
-        packet->AddHeader(typeHeader);
-        SendRerrMessage(packet, precursors);
+        SendRerrMessage(ControlMessage(rerrHeader, RAODVTYPE_RERR), precursors);
     }
     m_routingTable.InvalidateRoutesWithDst(unreachable);
+    for (auto i = unreachable.begin(); i != unreachable.end(); ++i)
+    {
+        StopQueueRelease(i->first);
+    }
 }
 
 void
@@ -2303,6 +2748,7 @@ RoutingProtocol::RouteRequestTimerExpire(Ipv4Address dst)
         m_routingTable.DeleteRoute(dst);
         NS_LOG_DEBUG("Route not found. Drop all packets with dst " << dst);
         m_queue.DropPacketWithDst(dst);
+        m_discoveryStart.erase(dst);
         return;
     }
 
@@ -2317,6 +2763,7 @@ RoutingProtocol::RouteRequestTimerExpire(Ipv4Address dst)
         m_addressReqTimer.erase(dst);
         m_routingTable.DeleteRoute(dst);
         m_queue.DropPacketWithDst(dst);
+        m_discoveryStart.erase(dst);
     }
 }
 
@@ -2324,6 +2771,21 @@ void
 RoutingProtocol::HelloTimerExpire()
 {
     NS_LOG_FUNCTION(this);
+    if (m_adaptiveHello)
+    {
+        // Back off while the neighbor set is stable, start over once it changed
+        if (m_nb.GetChangeCount() == m_helloNbChanges)
+        {
+            m_currentHelloInterval =
+                std::min(Time(2 * m_currentHelloInterval), m_maxHelloInterval);
+        }
+        else
+        {
+            m_currentHelloInterval = m_helloInterval;
+            m_helloNbChanges = m_nb.GetChangeCount();
+        }
+        NS_LOG_DEBUG("Hello interval " << m_currentHelloInterval.As(Time::S));
+    }
     Time offset = Time(Seconds(0));
     if (m_lastBcastTime > Time(Seconds(0)))
     {
@@ -2335,17 +2797,37 @@ RoutingProtocol::HelloTimerExpire()
         SendHello();
     }
     m_htimer.Cancel();
-    Time diff = m_helloInterval - offset;
+    Time diff = m_currentHelloInterval - offset;
     m_htimer.Schedule(std::max(Time(Seconds(0)), diff));
     m_lastBcastTime = Time(Seconds(0));
 }
 
+void
+RoutingProtocol::ResetHelloInterval()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_currentHelloInterval == m_helloInterval)
+    {
+        return;
+    }
+    m_currentHelloInterval = m_helloInterval;
+    if (m_htimer.IsRunning() && m_htimer.GetDelayLeft() > m_helloInterval)
+    {
+        m_htimer.Cancel();
+        m_htimer.Schedule(m_helloInterval);
+    }
+}
+
 void
 RoutingProtocol::RreqRateLimitTimerExpire()
 {
     NS_LOG_FUNCTION(this);
     m_rreqCount = 0;
     m_rreqRateLimitTimer.Schedule(Seconds(1));
+    if (!m_pendingRreqDst.empty())
+    {
+        SendPendingRequests();
+    }
 }
 
 void
@@ -2353,6 +2835,21 @@ RoutingProtocol::RerrRateLimitTimerExpire()
 {
     NS_LOG_FUNCTION(this);
     m_rerrCount = 0;
+    if (m_rerrBatch.GetDestCount() != 0)
+    {
+        // The batch goes to its originator if there is only one, broadcast otherwise
+        Ipv4Address origin = Ipv4Address::GetAny();
+        if (m_rerrBatchOrigins.size() == 1)
+        {
+            origin = *m_rerrBatchOrigins.begin();
+        }
+        NS_LOG_LOGIC("Send RERR batch with " << static_cast<uint32_t>(m_rerrBatch.GetDestCount())
+                                             << " unreachable destinations");
+        SendRerrToOrigin(m_rerrBatch, origin);
+        m_rerrBatch.Clear();
+        m_rerrBatchOrigins.clear();
+        m_rerrCount++;
+    }
     m_rerrRateLimitTimer.Schedule(Seconds(1));
 }
 
@@ -2372,17 +2869,18 @@ RoutingProtocol::SendHello()
      *   Destination Sequence Number    The node's latest sequence number.
      *   Hop Count                      0
      *   Lifetime                       AllowedHelloLoss * HelloInterval
+     * In adaptive hello mode the lifetime covers the current, backed off, interval.
      */
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = j->second.m_socket;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
         RrepHeader helloHeader(/*prefixSize=*/0,
                                /*hopCount=*/0,
                                /*dst=*/iface.GetLocal(),
                                /*dstSeqNo=*/m_seqNo,
                                /*origin=*/iface.GetLocal(),
-                               /*lifetime=*/Time(m_allowedHelloLoss * m_helloInterval));
+                               /*lifetime=*/Time(m_allowedHelloLoss * m_currentHelloInterval));
         Ptr<Packet> packet = Create<Packet>();
         SocketIpTtlTag tag;
         tag.SetTtl(1);
@@ -2401,7 +2899,7 @@ RoutingProtocol::SendHello()
             destination = iface.GetBroadcast();
         }
         Time jitter = Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10)));
-        Simulator::Schedule(jitter, &RoutingProtocol::SendTo, this, socket, packet, destination);
+        m_txScheduler.Schedule(jitter, socket, packet, destination);
     }
 }
 
@@ -2409,24 +2907,128 @@ void
 RoutingProtocol::SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route)
 {
     NS_LOG_FUNCTION(this);
-    QueueEntry queueEntry;
-    while (m_queue.Dequeue(dst, queueEntry))
+    auto start = m_discoveryStart.find(dst);
+    if (start != m_discoveryStart.end())
     {
-        DeferredRouteOutputTag tag;
-        Ptr<Packet> p = ConstCast<Packet>(queueEntry.GetPacket());
-        if (p->RemovePacketTag(tag) && tag.GetInterface() != -1 &&
-            tag.GetInterface() != m_ipv4->GetInterfaceForDevice(route->GetOutputDevice()))
+        Time latency = Simulator::Now() - start->second;
+        m_discoveryStart.erase(start);
+        m_stats.m_discoveries++;
+        m_stats.m_discoveryLatencySum += latency;
+        m_stats.m_discoveryLatency.AddValue(latency.GetSeconds());
+        m_routeDiscoveryTrace(dst, latency);
+    }
+    auto pending = m_queueReleases.find(dst);
+    if (pending != m_queueReleases.end())
+    {
+        // A paced release is in progress: queue behind it
+        m_queue.DequeueAll(dst, pending->second.m_entries);
+        return;
+    }
+    std::vector<QueueEntry> queueEntries;
+    if (!m_queue.DequeueAll(dst, queueEntries))
+    {
+        return;
+    }
+    if (!m_queueReleaseInterval.IsStrictlyPositive() || queueEntries.size() == 1)
+    {
+        for (auto i = queueEntries.begin(); i != queueEntries.end(); ++i)
         {
-            NS_LOG_DEBUG("Output device doesn't match. Dropped.");
-            return;
+            SendQueueEntry(*i, route);
         }
-        UnicastForwardCallback ucb = queueEntry.GetUnicastForwardCallback();
-        Ipv4Header header = queueEntry.GetIpv4Header();
-        header.SetSource(route->GetSource());
-        header.SetTtl(header.GetTtl() +
-                      1); // compensate extra TTL decrement by fake loopback routing
-        ucb(route, p, header);
+        return;
+    }
+    QueueRelease& release = m_queueReleases[dst];
+    release.m_entries = std::move(queueEntries);
+    release.m_next = 0;
+    ReleaseQueued(dst);
+}
+
+void
+RoutingProtocol::ReleaseQueued(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    auto i = m_queueReleases.find(dst);
+    NS_ASSERT(i != m_queueReleases.end());
+    // The route may have been invalidated or expired since the previous packet
+    RoutingTableEntry toDst;
+    if (!m_routingTable.LookupValidRoute(dst, toDst))
+    {
+        NS_LOG_LOGIC("Route to " << dst << " lost during the paced release");
+        StopQueueRelease(dst);
+        return;
+    }
+    QueueRelease& release = i->second;
+    // Packets out of the queue still time out: requeueing an expired one drops it
+    while (release.m_next < release.m_entries.size() &&
+           release.m_entries[release.m_next].GetExpireTime() < Seconds(0))
+    {
+        m_queue.Requeue(release.m_entries[release.m_next++]);
+    }
+    if (release.m_next < release.m_entries.size())
+    {
+        SendQueueEntry(release.m_entries[release.m_next++], toDst.GetRoute());
+    }
+    if (release.m_next == release.m_entries.size())
+    {
+        m_queueReleases.erase(i);
+        return;
+    }
+    release.m_event =
+        Simulator::Schedule(m_queueReleaseInterval, &RoutingProtocol::ReleaseQueued, this, dst);
+}
+
+void
+RoutingProtocol::StopQueueRelease(Ipv4Address dst)
+{
+    NS_LOG_FUNCTION(this << dst);
+    auto i = m_queueReleases.find(dst);
+    if (i == m_queueReleases.end())
+    {
+        return;
+    }
+    QueueRelease& release = i->second;
+    release.m_event.Cancel();
+    for (std::size_t n = release.m_next; n < release.m_entries.size(); n++)
+    {
+        m_queue.Requeue(release.m_entries[n]);
+    }
+    m_queueReleases.erase(i);
+    if (!m_queue.Find(dst))
+    {
+        return;
     }
+    // As for a newly deferred packet, start a route discovery unless one is in progress
+    RoutingTableEntry rt;
+    bool result = m_routingTable.LookupRoute(dst, rt);
+    if (!result || rt.GetFlag() != IN_SEARCH)
+    {
+        NS_LOG_LOGIC("Send new RREQ for the requeued packets to " << dst);
+        m_discoveryStart.emplace(dst, Simulator::Now());
+        SendRequest(dst);
+    }
+}
+
+void
+RoutingProtocol::SendQueueEntry(const QueueEntry& entry, Ptr<Ipv4Route> route)
+{
+    Time wait = m_maxQueueTime - entry.GetExpireTime();
+    m_stats.m_queuedSent++;
+    m_stats.m_queueWaitSum += wait;
+    m_stats.m_queueWait.AddValue(wait.GetSeconds());
+    m_queueWaitTrace(entry.GetPacket(), wait);
+    DeferredRouteOutputTag tag;
+    Ptr<Packet> p = ConstCast<Packet>(entry.GetPacket());
+    if (p->RemovePacketTag(tag) && tag.GetInterface() != -1 &&
+        tag.GetInterface() != m_ipv4->GetInterfaceForDevice(route->GetOutputDevice()))
+    {
+        NS_LOG_DEBUG("Output device doesn't match. Dropped.");
+        return;
+    }
+    UnicastForwardCallback ucb = entry.GetUnicastForwardCallback();
+    Ipv4Header header = entry.GetIpv4Header();
+    header.SetSource(route->GetSource());
+    header.SetTtl(header.GetTtl() + 1); // compensate extra TTL decrement by fake loopback routing
+    ucb(route, p, header);
 }
 
 void
@@ -2445,19 +3047,14 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
     toNextHop.GetPrecursors(precursors);
     rerrHeader.AddUnDestination(nextHop, toNextHop.GetSeqNo());
     m_routingTable.GetListOfDestinationWithNextHop(nextHop, unreachable);
+    // Routes with an alternate next hop survive the break and need no RERR nor rediscovery
+    m_routingTable.FailOverRoutesWithNextHop(nextHop, unreachable);
     for (auto i = unreachable.begin(); i != unreachable.end();)
     {
         if (!rerrHeader.AddUnDestination(i->first, i->second))
         {
             NS_LOG_LOGIC("Send RERR message with maximum size.");
-            TypeHeader typeHeader(RAODVTYPE_RERR);
-            Ptr<Packet> packet = Create<Packet>();
-            SocketIpTtlTag tag;
-            tag.SetTtl(1);
-            packet->AddPacketTag(tag);
-            packet->AddHeader(rerrHeader);
-            packet->AddHeader(typeHeader);
-            SendRerrMessage(packet, precursors);
+            SendRerrMessage(ControlMessage(rerrHeader, RAODVTYPE_RERR), precursors);
             rerrHeader.Clear();
         }
         else
@@ -2470,17 +3067,14 @@ RoutingProtocol::SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop)
     }
     if (rerrHeader.GetDestCount() != 0)
     {
-        TypeHeader typeHeader(RAODVTYPE_RERR);
-        Ptr<Packet> packet = Create<Packet>();
-        SocketIpTtlTag tag;
-        tag.SetTtl(1);
-        packet->AddPacketTag(tag);
-        packet->AddHeader(rerrHeader);
-        packet->AddHeader(typeHeader);
-        SendRerrMessage(packet, precursors);
+        SendRerrMessage(ControlMessage(rerrHeader, RAODVTYPE_RERR), precursors);
     }
     unreachable.insert(std::make_pair(nextHop, toNextHop.GetSeqNo()));
     m_routingTable.InvalidateRoutesWithDst(unreachable);
+    for (auto i = unreachable.begin(); i != unreachable.end(); ++i)
+    {
+        StopQueueRelease(i->first);
+    }
 }
 
 void
@@ -2494,34 +3088,48 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
     {
         // Just make sure that the RerrRateLimit timer is running and will expire
         NS_ASSERT(m_rerrRateLimitTimer.IsRunning());
-        // discard the packet and return
+        // can't support more than 255 destinations in single RERR
+        if (m_rerrBatch.GetDestCount() == 255)
+        {
+            NS_LOG_LOGIC("RerrRateLimit reached and RERR batch is full; suppressing RERR");
+            CountMessage(RAODVTYPE_RERR, MESSAGE_SUPPRESSED);
+            return;
+        }
+        // hold the destination back for the RERR sent when the timer expires
         NS_LOG_LOGIC("RerrRateLimit reached at "
                      << Simulator::Now().As(Time::S) << " with timer delay left "
-                     << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S) << "; suppressing RERR");
+                     << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S) << "; batching RERR");
+        m_rerrBatch.AddUnDestination(dst, dstSeqNo);
+        m_rerrBatchOrigins.insert(origin);
         return;
     }
     RerrHeader rerrHeader;
     rerrHeader.AddUnDestination(dst, dstSeqNo);
+    SendRerrToOrigin(rerrHeader, origin);
+}
+
+void
+RoutingProtocol::SendRerrToOrigin(const RerrHeader& rerrHeader, Ipv4Address origin)
+{
+    NS_LOG_FUNCTION(this << origin);
+    ControlMessage message(rerrHeader, RAODVTYPE_RERR);
     RoutingTableEntry toOrigin;
-    Ptr<Packet> packet = Create<Packet>();
-    SocketIpTtlTag tag;
-    tag.SetTtl(1);
-    packet->AddPacketTag(tag);
-    packet->AddHeader(rerrHeader);
-    packet->AddHeader(TypeHeader(RAODVTYPE_RERR));
-    if (m_routingTable.LookupValidRoute(origin, toOrigin))
+    if (origin != Ipv4Address::GetAny() && m_routingTable.LookupValidRoute(origin, toOrigin))
     {
         Ptr<Socket> socket = FindSocketWithInterfaceAddress(toOrigin.GetInterface());
         NS_ASSERT(socket);
         NS_LOG_LOGIC("Unicast RERR to the source of the data transmission");
-        socket->SendTo(packet, 0, InetSocketAddress(toOrigin.GetNextHop(), RAODV_PORT));
+        m_txScheduler.Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                               socket,
+                               message.CreatePacket(1),
+                               toOrigin.GetNextHop());
     }
     else
     {
-        for (auto i = m_socketAddresses.begin(); i != m_socketAddresses.end(); ++i)
+        for (auto i = m_interfaces.begin(); i != m_interfaces.end(); ++i)
         {
-            Ptr<Socket> socket = i->first;
-            Ipv4InterfaceAddress iface = i->second;
+            Ptr<Socket> socket = i->second.m_socket;
+            Ipv4InterfaceAddress iface = i->second.m_iface;
             NS_ASSERT(socket);
             NS_LOG_LOGIC("Broadcast RERR message from interface " << iface.GetLocal());
             // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
@@ -2534,13 +3142,17 @@ RoutingProtocol::SendRerrWhenNoRouteToForward(Ipv4Address dst,
             {
                 destination = iface.GetBroadcast();
             }
-            socket->SendTo(packet->Copy(), 0, InetSocketAddress(destination, RAODV_PORT));
+            m_txScheduler.Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                                   socket,
+                                   message.CreatePacket(1),
+                                   destination);
         }
     }
 }
 
 void
-RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> precursors)
+RoutingProtocol::SendRerrMessage(const ControlMessage& message,
+                                 std::vector<Ipv4Address> precursors)
 {
     NS_LOG_FUNCTION(this);
 
@@ -2558,6 +3170,7 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
         NS_LOG_LOGIC("RerrRateLimit reached at "
                      << Simulator::Now().As(Time::S) << " with timer delay left "
                      << m_rerrRateLimitTimer.GetDelayLeft().As(Time::S) << "; suppressing RERR");
+        CountMessage(RAODVTYPE_RERR, MESSAGE_SUPPRESSED);
         return;
     }
     // If there is only one precursor, RERR SHOULD be unicast toward that precursor
@@ -2571,12 +3184,10 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
             NS_LOG_LOGIC("one precursor => unicast RERR to "
                          << toPrecursor.GetDestination() << " from "
                          << toPrecursor.GetInterface().GetLocal());
-            Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
-                                &RoutingProtocol::SendTo,
-                                this,
-                                socket,
-                                packet,
-                                precursors.front());
+            m_txScheduler.Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                                   socket,
+                                   message.CreatePacket(1),
+                                   precursors.front());
             m_rerrCount++;
         }
         return;
@@ -2602,7 +3213,7 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
         NS_LOG_LOGIC("Broadcast RERR message from interface " << i->GetLocal());
         // std::cout << "Broadcast RERR message from interface " << i->GetLocal () << std::endl;
         // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
-        Ptr<Packet> p = packet->Copy();
+        Ptr<Packet> p = message.CreatePacket(1);
         Ipv4Address destination;
         if (i->GetMask() == Ipv4Mask::GetOnes())
         {
@@ -2612,12 +3223,10 @@ RoutingProtocol::SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> pr
         {
             destination = i->GetBroadcast();
         }
-        Simulator::Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
-                            &RoutingProtocol::SendTo,
-                            this,
-                            socket,
-                            p,
-                            destination);
+        m_txScheduler.Schedule(Time(MilliSeconds(m_uniformRandomVariable->GetInteger(0, 10))),
+                               socket,
+                               p,
+                               destination);
     }
 }
 
@@ -2625,10 +3234,10 @@ Ptr<Socket>
 RoutingProtocol::FindSocketWithInterfaceAddress(Ipv4InterfaceAddress addr) const
 {
     NS_LOG_FUNCTION(this << addr);
-    for (auto j = m_socketAddresses.begin(); j != m_socketAddresses.end(); ++j)
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = j->second.m_socket;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
         if (iface == addr)
         {
             return socket;
@@ -2642,12 +3251,10 @@ Ptr<Socket>
 RoutingProtocol::FindSubnetBroadcastSocketWithInterfaceAddress(Ipv4InterfaceAddress addr) const
 {
     NS_LOG_FUNCTION(this << addr);
-    for (auto j = m_socketSubnetBroadcastAddresses.begin();
-         j != m_socketSubnetBroadcastAddresses.end();
-         ++j)
+    for (auto j = m_interfaces.begin(); j != m_interfaces.end(); ++j)
     {
-        Ptr<Socket> socket = j->first;
-        Ipv4InterfaceAddress iface = j->second;
+        Ptr<Socket> socket = j->second.m_broadcastSocket;
+        Ipv4InterfaceAddress iface = j->second.m_iface;
         if (iface == addr)
         {
             return socket;
@@ -2662,7 +3269,10 @@ RoutingProtocol::DoInitialize()
 {
     NS_LOG_FUNCTION(this);
     uint32_t startTime;
-    if (m_enableHello)
+    m_currentHelloInterval = m_helloInterval;
+    m_answeredRreqCache.SetLifetime(m_netTraversalTime);
+    m_txScheduler.SetRandomVariable(m_uniformRandomVariable);
+    if (m_enableHello && IsLocalNode())
     {
         m_htimer.SetFunction(&RoutingProtocol::HelloTimerExpire, this);
         startTime = m_uniformRandomVariable->GetInteger(0, 100);
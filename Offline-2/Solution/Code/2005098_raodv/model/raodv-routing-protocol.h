@@ -21,20 +21,29 @@
 #include "raodv-packet.h"
 #include "raodv-rqueue.h"
 #include "raodv-rtable.h"
+#include "raodv-tx-scheduler.h"
 
+#include "ns3/histogram.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/node.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 
 #include <map>
+#include <set>
+#include <utility>
 
 namespace ns3
 {
 
 class WifiMpdu;
+class WifiTxVector;
+struct MpduInfo;
+struct SignalNoiseDbm;
 enum WifiMacDropReason : uint8_t; // opaque enum declaration
 
 namespace raodv
@@ -54,6 +63,64 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     static TypeId GetTypeId();
     static const uint32_t RAODV_PORT;
 
+    /// What happened to a control message, for the statistics
+    enum MessageEvent
+    {
+        MESSAGE_SENT = 0,       //!< Sent to a neighbor or broadcast
+        MESSAGE_RECEIVED = 1,   //!< Received
+        MESSAGE_SUPPRESSED = 2, //!< Not sent or forwarded: duplicate, rate limited or flood control
+        MESSAGE_EVENTS = 3,     //!< Number of events
+    };
+
+    /// Counters and histograms of the protocol operation
+    struct Statistics
+    {
+        /// Control messages by MessageType and MessageEvent
+        uint64_t m_messages[RAODVTYPE_R_RREQ + 1][MESSAGE_EVENTS];
+        uint64_t m_duplicateChecks;   ///< Lookups of received RREQs and broadcasts in the
+                                      ///< duplicate caches
+        uint64_t m_duplicateHits;     ///< Lookups that found a duplicate
+        uint64_t m_discoveries;       ///< Route discoveries that found a route
+        Time m_discoveryLatencySum;   ///< Sum of the route discovery latencies
+        Histogram m_discoveryLatency; ///< Route discovery latency (s)
+        uint64_t m_queuedSent;        ///< Queued packets sent once a route was found
+        Time m_queueWaitSum;          ///< Sum of the queue waits of these packets
+        Histogram m_queueWait;        ///< Queue wait of these packets (s)
+    };
+
+    /**
+     * TracedCallback signature for control message events.
+     *
+     * \param [in] type The message type.
+     * \param [in] event What happened to the message.
+     */
+    typedef void (*ControlMessageTracedCallback)(MessageType type, MessageEvent event);
+
+    /**
+     * TracedCallback signature for a completed route discovery.
+     *
+     * \param [in] dst The destination.
+     * \param [in] latency Time from the first queued packet to the route.
+     */
+    typedef void (*RouteDiscoveryTracedCallback)(Ipv4Address dst, Time latency);
+
+    /**
+     * TracedCallback signature for the queue wait of a packet sent once a route was found.
+     *
+     * \param [in] packet The packet.
+     * \param [in] wait Time the packet was queued.
+     */
+    typedef void (*QueueWaitTracedCallback)(Ptr<const Packet> packet, Time wait);
+
+    /**
+     * TracedCallback signature for a packet dropped from the queue.
+     *
+     * \param [in] packet The packet.
+     * \param [in] reason The drop reason.
+     */
+    typedef void (*QueueDropTracedCallback)(Ptr<const Packet> packet,
+                                            RequestQueue::DropReason reason);
+
     /// constructor
     RoutingProtocol();
     ~RoutingProtocol() override;
@@ -182,6 +249,85 @@ class RoutingProtocol : public Ipv4RoutingProtocol
         return m_enableBroadcast;
     }
 
+    /**
+     * Set the number of alternate next hops kept per destination
+     * \param n the number of alternate next hops, 0 disables multipath
+     */
+    void SetMultipathAlternates(uint32_t n)
+    {
+        m_routingTable.SetMaxAlternates(n);
+    }
+
+    /**
+     * Get the number of alternate next hops kept per destination
+     * \returns the number of alternate next hops
+     */
+    uint32_t GetMultipathAlternates() const
+    {
+        return m_routingTable.GetMaxAlternates();
+    }
+
+    /**
+     * Set the slot length of the control packet send scheduler
+     * \param slot the slot length
+     */
+    void SetControlTxSlot(Time slot)
+    {
+        m_txScheduler.SetSlot(slot);
+    }
+
+    /**
+     * Get the slot length of the control packet send scheduler
+     * \returns the slot length
+     */
+    Time GetControlTxSlot() const
+    {
+        return m_txScheduler.GetSlot();
+    }
+
+    /**
+     * Set the bin width of the latency histograms
+     * \param width the bin width
+     */
+    void SetHistogramBinWidth(Time width);
+
+    /**
+     * Get the bin width of the latency histograms
+     * \returns the bin width
+     */
+    Time GetHistogramBinWidth() const
+    {
+        return m_histogramBinWidth;
+    }
+
+    /**
+     * Get the counters and histograms
+     * \returns the statistics
+     */
+    const Statistics& GetStatistics() const
+    {
+        return m_stats;
+    }
+
+    /**
+     * Get the number of packets dropped from the queue for a reason
+     * \param reason the drop reason
+     * \returns the number of dropped packets
+     */
+    uint64_t GetQueueDropCount(RequestQueue::DropReason reason) const
+    {
+        return m_queue.GetDropCount(reason);
+    }
+
+    /**
+     * Get the number of routing table entries
+     * \returns the routing table size
+     */
+    uint32_t GetRoutingTableSize() const
+    {
+        return m_routingTable.GetSize();
+    }
+
     /**
      * Assign a fixed random variable stream number to the random variables
      * used by this model.  Return the number of streams (possibly zero) that
@@ -203,6 +349,22 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param mpdu the dropped MPDU
      */
     void NotifyTxError(WifiMacDropReason reason, Ptr<const WifiMpdu> mpdu);
+    /**
+     * Notify that the PHY received a frame, to record its SNR.
+     *
+     * \param packet the frame
+     * \param channelFreqMhz the channel frequency
+     * \param txVector the TX vector of the frame
+     * \param aMpdu the A-MPDU information
+     * \param signalNoise the signal and noise power
+     * \param staId the station ID
+     */
+    void NotifyRxSnr(Ptr<const Packet> packet,
+                     uint16_t channelFreqMhz,
+                     WifiTxVector txVector,
+                     MpduInfo aMpdu,
+                     SignalNoiseDbm signalNoise,
+                     uint16_t staId);
 
     // Protocol parameters.
     uint32_t m_rreqRetries; ///< Maximum number of retransmissions of RREQ with TTL = NetDiameter to
@@ -249,14 +411,44 @@ class RoutingProtocol : public Ipv4RoutingProtocol
                              ///< originated route discovery.
     bool m_enableHello;      ///< Indicates whether a hello messages enable
     bool m_enableBroadcast;  ///< Indicates whether a a broadcast data packets forwarding enable
+    uint32_t m_revRreqCounterThreshold; ///< Number of reverse RREQ copies heard during the
+                                        ///< assessment delay that cancels a rebroadcast, 0 disables
+    Time m_revRreqAssessmentDelay;      ///< Time a reverse RREQ rebroadcast is held when reverse
+                                        ///< RREQ flood control is enabled
+    bool m_revRreqAggregation;          ///< Indicates whether reverse RREQs held for the same
+                                        ///< origin and destination are merged
+    bool m_revRreqSuppressAnswered;     ///< Indicates whether a node stops rebroadcasting reverse
+                                        ///< RREQs for a discovery it has already answered
+    bool m_adaptiveHello;               ///< Indicates whether the hello interval backs off while
+                                        ///< the neighbor set is stable
+    Time m_maxHelloInterval;            ///< Upper bound of the backed off hello interval
+    Time m_currentHelloInterval;        ///< Interval until the next hello
+    uint32_t m_helloNbChanges;          ///< Neighbor set change count at the last interval reset
+    Time m_queueReleaseInterval;        ///< Spacing of the queued packets released when a route
+                                        ///< is found, 0 releases them all at once
+    uint32_t m_maxRreqDestinations;     ///< Maximum number of destinations searched by one RREQ,
+                                        ///< 1 disables multi-destination RREQs
+    bool m_linkCostMetric;              ///< Indicates whether routes are chosen by the sum of
+                                        ///< the SNR based link costs rather than by hop count
+    double m_lastRxSnr;                 ///< SNR (dB) of the last frame received by the PHY
+    Time m_lastRxTime;                  ///< Reception time of the last frame received by the PHY
 
     /// IP protocol
     Ptr<Ipv4> m_ipv4;
-    /// Raw unicast socket per each IP interface, map socket -> iface address (IP + mask)
-    std::map<Ptr<Socket>, Ipv4InterfaceAddress> m_socketAddresses;
-    /// Raw subnet directed broadcast socket per each IP interface, map socket -> iface address (IP
-    /// + mask)
-    std::map<Ptr<Socket>, Ipv4InterfaceAddress> m_socketSubnetBroadcastAddresses;
+
+    /// Sockets, address and device of an IP interface used by raodv
+    struct InterfaceSockets
+    {
+        Ptr<Socket> m_socket;          ///< Unicast socket, bound to the interface address
+        Ptr<Socket> m_broadcastSocket; ///< Subnet directed broadcast socket
+        Ipv4InterfaceAddress m_iface;  ///< Interface address (IP + mask)
+        Ptr<NetDevice> m_device;       ///< Device of the interface
+    };
+
+    /// raodv interfaces, by IP interface index
+    std::map<uint32_t, InterfaceSockets> m_interfaces;
+    /// IP interface index of every raodv socket, unicast and subnet directed broadcast
+    std::map<Ptr<Socket>, uint32_t> m_socketInterfaces;
     /// Loopback device used to defer RREQ until packet will be fully formed
     Ptr<NetDevice> m_lo;
 
@@ -277,12 +469,44 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     Neighbors m_nb;
     /// Number of RREQs used for RREQ rate control
     uint16_t m_rreqCount;
+    /// Destinations whose RREQ was held back by the rate limit, the earliest first
+    std::vector<Ipv4Address> m_pendingRreqDst;
     /// Number of RERRs used for RERR rate control
     uint16_t m_rerrCount;
+    /// Route discoveries (origin, destination, destination sequence number) this node has sent
+    /// or forwarded a reply for
+    IdCache m_answeredRreqCache;
+    /// Unreachable destinations held back by the RERR rate limit, sent as one RERR
+    RerrHeader m_rerrBatch;
+    /// Originators of the data packets which caused the RERRs in m_rerrBatch
+    std::set<Ipv4Address> m_rerrBatchOrigins;
+
+    /// Reverse RREQ rebroadcast held for the assessment delay
+    struct PendingRevRreq
+    {
+        /// Header to rebroadcast
+        RevRreqHeader m_header;
+        /// TTL of the rebroadcast
+        uint8_t m_ttl;
+        /// Number of copies of the reverse RREQ heard since it was held
+        uint32_t m_copies;
+        /// Assessment delay expiration event
+        EventId m_event;
+    };
+
+    /// Held reverse RREQ rebroadcasts, keyed by (origin, destination)
+    std::map<std::pair<Ipv4Address, Ipv4Address>, PendingRevRreq> m_pendingRevRreq;
 
   private:
     /// Start protocol operation
     void Start();
+    /**
+     * Check whether the node of this agent is simulated by this simulator instance.
+     * Under the distributed simulator every rank creates all the nodes, but the nodes of
+     * the other ranks are only placeholders whose agents must stay silent.
+     * \returns true if the node belongs to this rank
+     */
+    bool IsLocalNode() const;
     /**
      * Queue packet and send route request
      *
@@ -323,12 +547,22 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \return true if route to destination address addr exist
      */
     bool UpdateRouteLifeTime(Ipv4Address addr, Time lt);
+    /**
+     * Open the sockets of an interface and add its local broadcast route
+     * \param i the IP interface index
+     */
+    void AddInterface(uint32_t i);
+    /**
+     * Close the sockets of an interface
+     * \param i the IP interface index
+     */
+    void RemoveInterface(uint32_t i);
     /**
      * Update neighbor record.
-     * \param receiver is supposed to be my interface
+     * \param in is supposed to be my interface
      * \param sender is supposed to be IP address of my neighbor.
      */
-    void UpdateRouteToNeighbor(Ipv4Address sender, Ipv4Address receiver);
+    void UpdateRouteToNeighbor(Ipv4Address sender, const InterfaceSockets& in);
     /**
      * Test whether the provided address is assigned to an interface on this node
      * \param src the source IP address
@@ -353,9 +587,9 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * Process hello message
      *
      * \param rrepHeader RREP message header
-     * \param receiverIfaceAddr receiver interface IP address
+     * \param in receiver interface
      */
-    void ProcessHello(const RrepHeader& rrepHeader, Ipv4Address receiverIfaceAddr);
+    void ProcessHello(const RrepHeader& rrepHeader, const InterfaceSockets& in);
     /**
      * Create loopback route for given header
      *
@@ -377,17 +611,57 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     /**
      * Receive RREQ
      * \param p packet
-     * \param receiver receiver address
+     * \param in receiver interface
      * \param src sender address
      */
-    void RecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src);
+    void RecvRequest(Ptr<Packet> p, const InterfaceSockets& in, Ipv4Address src);
+    /**
+     * Answer a RREQ for one destination if possible
+     * \param rreqHeader the RREQ, searching that destination only
+     * \param src sender address
+     * \param origin originator address
+     * \param request the destination, its sequence number updated if it is rebroadcast
+     * \returns true if the RREQ for this destination is to be rebroadcast
+     */
+    bool HandleRequest(const RreqHeader& rreqHeader,
+                       Ipv4Address src,
+                       Ipv4Address origin,
+                       RreqHeader::Destination& request);
+    /**
+     * Move a valid route to a cheaper next hop heard from a copy of a control message
+     * \param dst the destination of the route
+     * \param seqNo the destination sequence number of the copy
+     * \param nextHop the sender of the copy
+     * \param in the interface the copy was received on
+     * \param hop the hop count through nextHop
+     * \param cost the path cost through nextHop
+     */
+    void ImproveRoute(Ipv4Address dst,
+                      uint32_t seqNo,
+                      Ipv4Address nextHop,
+                      const InterfaceSockets& in,
+                      uint16_t hop,
+                      uint32_t cost);
+    /**
+     * Get the path cost of a route, estimated from its hop count if it carries none
+     * \param rt the route
+     * \returns the path cost
+     */
+    uint32_t GetPathCost(const RoutingTableEntry& rt);
+    /**
+     * Add the cost of the link from a neighbor to a path cost carried by a message
+     * \param cost the path cost carried by the message
+     * \param neighbor the neighbor the message was received from
+     * \returns the path cost through the neighbor, saturated to the message field
+     */
+    uint16_t AddLinkCost(uint32_t cost, Ipv4Address neighbor) const;
     /**
      * Receive RREP
      * \param p packet
-     * \param my destination address
+     * \param in receiver interface
      * \param src sender address
      */
-    void RecvReply(Ptr<Packet> p, Ipv4Address my, Ipv4Address src);
+    void RecvReply(Ptr<Packet> p, const InterfaceSockets& in, Ipv4Address src);
     /**
      * Receive RREP_ACK
      * \param neighbor neighbor address
@@ -411,12 +685,46 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param route route to use
      */
     void SendPacketFromQueue(Ipv4Address dst, Ptr<Ipv4Route> route);
+    /** Send the next packet of the paced release of a destination, through its current route
+     * \param dst destination address
+     */
+    void ReleaseQueued(Ipv4Address dst);
+    /** Stop the paced release of a destination whose route is lost, if any. The packets not
+     * sent yet go back to the queue and start a new route discovery.
+     * \param dst destination address
+     */
+    void StopQueueRelease(Ipv4Address dst);
+    /** Forward a packet taken from the route request queue
+     * \param entry the queue entry
+     * \param route route to use
+     */
+    void SendQueueEntry(const QueueEntry& entry, Ptr<Ipv4Route> route);
     /// Send hello
     void SendHello();
     /** Send RREQ
      * \param dst destination address
      */
     void SendRequest(Ipv4Address dst);
+    /** Send one RREQ searching several destinations
+     * \param dsts destination addresses, at most MaxRreqDestinations
+     */
+    void SendMultiRequest(const std::vector<Ipv4Address>& dsts);
+    /** Send the RREQs held back by the rate limit, as many destinations per RREQ as allowed
+     */
+    void SendPendingRequests();
+    /** Prepare the routing table entry of a destination for a new route discovery
+     * \param dst destination address
+     * \param request the destination fields of the RREQ to fill
+     * \returns the TTL of the RREQ, following the expanding ring search
+     */
+    uint16_t StartRouteDiscovery(Ipv4Address dst, RreqHeader::Destination& request);
+    /** Get the RREQ for one of the destinations searched by a RREQ
+     * \param rreqHeader the RREQ
+     * \param request the destination
+     * \returns a RREQ searching that destination only
+     */
+    static RreqHeader GetSingleRequest(const RreqHeader& rreqHeader,
+                                       const RreqHeader::Destination& request);
     /** Send RREP
      * \param rreqHeader route request header
      * \param toOrigin routing table entry to originator
@@ -439,10 +747,10 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      */
     void SendRerrWhenBreaksLinkToNextHop(Ipv4Address nextHop);
     /** Forward RERR
-     * \param packet packet
+     * \param message the RERR message
      * \param precursors list of addresses of the visited nodes
      */
-    void SendRerrMessage(Ptr<Packet> packet, std::vector<Ipv4Address> precursors);
+    void SendRerrMessage(const ControlMessage& message, std::vector<Ipv4Address> precursors);
     /**
      * Send RERR message when no route to forward input packet. Unicast if there is reverse route to
      * originating node, broadcast otherwise.
@@ -451,6 +759,13 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param origin originating node IP address
      */
     void SendRerrWhenNoRouteToForward(Ipv4Address dst, uint32_t dstSeqNo, Ipv4Address origin);
+    /**
+     * Send RERR message towards the originator of a data transmission. Unicast if there is a valid
+     * route to it, broadcast otherwise.
+     * \param rerrHeader the RERR header
+     * \param origin originating node IP address, or Ipv4Address::GetAny() to broadcast
+     */
+    void SendRerrToOrigin(const RerrHeader& rerrHeader, Ipv4Address origin);
     /** @} */
 
     /**
@@ -460,21 +775,45 @@ class RoutingProtocol : public Ipv4RoutingProtocol
      * \param destination destination node IP address
      */
     void SendTo(Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination);
-    void RevRecvRequest(Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src);
+    void RevRecvRequest(Ptr<Packet> p, const InterfaceSockets& in, Ipv4Address src);
     void RevSendReply(const RreqHeader& rreqHeader, const RoutingTableEntry& toOrigin);
+    /**
+     * Rebroadcast reverse RREQ from each interface
+     * \param rreqHeader reverse RREQ header
+     * \param ttl TTL of the rebroadcast
+     */
+    void BroadcastRevRreq(const RevRreqHeader& rreqHeader, uint8_t ttl);
+    /**
+     * Rebroadcast reverse RREQ subject to counter-based suppression, suppression of answered
+     * discoveries and aggregation, as configured.
+     * \param rreqHeader reverse RREQ header
+     * \param ttl TTL of the rebroadcast
+     */
+    void ForwardRevRreq(const RevRreqHeader& rreqHeader, uint8_t ttl);
+    /**
+     * Rebroadcast or suppress a held reverse RREQ once its assessment delay is over
+     * \param origin originator of the route discovery
+     * \param dst destination of the route discovery
+     */
+    void RevRreqAssessmentExpire(Ipv4Address origin, Ipv4Address dst);
    
 
     /// Hello timer
     Timer m_htimer;
     /// Schedule next send of hello message
     void HelloTimerExpire();
+    /// Go back to the HelloInterval after a change of the neighbor set or a link layer failure
+    void ResetHelloInterval();
     /// RREQ rate limit timer
     Timer m_rreqRateLimitTimer;
     /// Reset RREQ count and schedule RREQ rate limit timer with delay 1 sec.
     void RreqRateLimitTimerExpire();
     /// RERR rate limit timer
     Timer m_rerrRateLimitTimer;
-    /// Reset RERR count and schedule RERR rate limit timer with delay 1 sec.
+    /**
+     * Reset RERR count, send the RERR batch held back by the rate limit and schedule RERR rate
+     * limit timer with delay 1 sec.
+     */
     void RerrRateLimitTimerExpire();
     /// Map IP address + RREQ timer.
     std::map<Ipv4Address, Timer> m_addressReqTimer;
@@ -495,6 +834,71 @@ class RoutingProtocol : public Ipv4RoutingProtocol
     Ptr<UniformRandomVariable> m_uniformRandomVariable;
     /// Keep track of the last bcast time
     Time m_lastBcastTime;
+    /// Coalesces the jittered control packet sends
+    TxScheduler m_txScheduler;
+
+    /// Counters and histograms
+    Statistics m_stats;
+    /// Bin width of the latency histograms
+    Time m_histogramBinWidth;
+    /// Start of the route discovery of every destination with queued packets
+    std::map<Ipv4Address, Time> m_discoveryStart;
+
+    /// Queued packets of a destination released one every QueueReleaseInterval
+    struct QueueRelease
+    {
+        std::vector<QueueEntry> m_entries; ///< Packets, the earliest first
+        uint32_t m_next;                   ///< Index of the next packet to send
+        EventId m_event;                   ///< Next release event
+    };
+
+    /// Paced releases in progress, by destination
+    std::map<Ipv4Address, QueueRelease> m_queueReleases;
+    /// Number of routing table entries
+    TracedValue<uint32_t> m_routingTableSize;
+    /// Control message events
+    TracedCallback<MessageType, MessageEvent> m_controlMessageTrace;
+    /// Completed route discoveries
+    TracedCallback<Ipv4Address, Time> m_routeDiscoveryTrace;
+    /// Queue waits of the packets sent once a route was found
+    TracedCallback<Ptr<const Packet>, Time> m_queueWaitTrace;
+    /// Packets dropped from the queue
+    TracedCallback<Ptr<const Packet>, RequestQueue::DropReason> m_queueDropTrace;
+
+    /**
+     * Count a control message event
+     * \param type the message type
+     * \param event what happened to the message
+     */
+    void CountMessage(MessageType type, MessageEvent event)
+    {
+        m_stats.m_messages[type][event]++;
+        m_controlMessageTrace(type, event);
+    }
+
+    /**
+     * Count a lookup in a duplicate cache
+     * \param duplicate whether the lookup found a duplicate
+     * \returns duplicate
+     */
+    bool CountDuplicate(bool duplicate)
+    {
+        m_stats.m_duplicateChecks++;
+        m_stats.m_duplicateHits += duplicate ? 1 : 0;
+        return duplicate;
+    }
+
+    /**
+     * Notify a packet dropped from the queue
+     * \param entry the dropped entry
+     * \param reason the drop reason
+     */
+    void NotifyQueueDrop(const QueueEntry& entry, RequestQueue::DropReason reason);
+    /**
+     * Notify a change of the number of routing table entries
+     * \param size the number of entries
+     */
+    void NotifyRoutingTableSize(uint32_t size);
 };
 
 } // namespace raodv
@@ -20,7 +20,7 @@
 #include "ns3/socket.h"
 
 #include <algorithm>
-#include <functional>
+#include <iterator>
 
 namespace ns3
 {
@@ -40,21 +40,18 @@ bool
 RequestQueue::Enqueue(QueueEntry& entry)
 {
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    Ipv4Address dst = entry.GetIpv4Header().GetDestination();
+    if (!m_uids.insert(std::make_pair(entry.GetPacket()->GetUid(), dst)).second)
     {
-        if ((i->GetPacket()->GetUid() == entry.GetPacket()->GetUid()) &&
-            (i->GetIpv4Header().GetDestination() == entry.GetIpv4Header().GetDestination()))
-        {
-            return false;
-        }
+        return false;
     }
     entry.SetExpireTime(m_queueTimeout);
-    if (m_queue.size() == m_maxLen)
+    if (m_queue.size() >= m_maxLen && !m_queue.empty())
     {
-        Drop(m_queue.front(), "Drop the most aged packet"); // Drop the most aged packet
-        m_queue.erase(m_queue.begin());
+        Drop(PopFront(), DROP_QUEUE_FULL); // Drop the most aged packet
     }
     m_queue.push_back(entry);
+    m_dstQueue[dst].push_back(std::prev(m_queue.end()));
     return true;
 }
 
@@ -63,83 +60,154 @@ RequestQueue::DropPacketWithDst(Ipv4Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    auto d = m_dstQueue.find(dst);
+    if (d == m_dstQueue.end())
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            Drop(*i, "DropPacketWithDst ");
-        }
+        return;
+    }
+    std::deque<EntryIterator> entries = std::move(d->second);
+    m_dstQueue.erase(d);
+    for (auto i = entries.begin(); i != entries.end(); ++i)
+    {
+        Drop(Take(*i), DROP_NO_ROUTE);
     }
-    auto new_end = std::remove_if(m_queue.begin(), m_queue.end(), [&](const QueueEntry& en) {
-        return en.GetIpv4Header().GetDestination() == dst;
-    });
-    m_queue.erase(new_end, m_queue.end());
 }
 
 bool
 RequestQueue::Dequeue(Ipv4Address dst, QueueEntry& entry)
 {
     Purge();
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    auto d = m_dstQueue.find(dst);
+    if (d == m_dstQueue.end())
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            entry = *i;
-            m_queue.erase(i);
-            return true;
-        }
+        return false;
     }
-    return false;
+    EntryIterator i = d->second.front();
+    d->second.pop_front();
+    if (d->second.empty())
+    {
+        m_dstQueue.erase(d);
+    }
+    entry = Take(i);
+    return true;
 }
 
 bool
-RequestQueue::Find(Ipv4Address dst)
+RequestQueue::DequeueAll(Ipv4Address dst, std::vector<QueueEntry>& entries)
 {
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    Purge();
+    auto d = m_dstQueue.find(dst);
+    if (d == m_dstQueue.end())
     {
-        if (i->GetIpv4Header().GetDestination() == dst)
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+    entries.reserve(entries.size() + d->second.size());
+    for (auto i = d->second.begin(); i != d->second.end(); ++i)
+    {
+        entries.push_back(Take(*i));
+    }
+    m_dstQueue.erase(d);
+    return true;
 }
 
-/**
- * \brief IsExpired structure
- */
-struct IsExpired
+bool
+RequestQueue::Requeue(const QueueEntry& entry)
 {
-    /**
-     * Check if the entry is expired
-     *
-     * \param e QueueEntry entry
-     * \return true if expired, false otherwise
-     */
-    bool operator()(const QueueEntry& e) const
+    Purge();
+    if (entry.GetExpireTime() < Seconds(0))
+    {
+        Drop(entry, DROP_TIMEOUT);
+        return false;
+    }
+    Ipv4Address dst = entry.GetIpv4Header().GetDestination();
+    if (!m_uids.insert(std::make_pair(entry.GetPacket()->GetUid(), dst)).second)
     {
-        return (e.GetExpireTime() < Seconds(0));
+        return false;
     }
-};
+    // Keep both the queue and the destination index in expiration order. A requeued entry is
+    // among the most aged ones, so it usually goes near the front.
+    auto expiresLater = [&entry](const QueueEntry& e) {
+        return e.GetExpireTime() > entry.GetExpireTime();
+    };
+    EntryIterator i =
+        m_queue.insert(std::find_if(m_queue.begin(), m_queue.end(), expiresLater), entry);
+    std::deque<EntryIterator>& entries = m_dstQueue[dst];
+    entries.insert(std::find_if(entries.begin(),
+                                entries.end(),
+                                [&expiresLater](EntryIterator e) { return expiresLater(*e); }),
+                   i);
+    if (m_queue.size() > m_maxLen)
+    {
+        Drop(PopFront(), DROP_QUEUE_FULL); // Drop the most aged packet
+    }
+    return true;
+}
+
+bool
+RequestQueue::Find(Ipv4Address dst)
+{
+    return m_dstQueue.find(dst) != m_dstQueue.end();
+}
 
 void
 RequestQueue::Purge()
 {
-    IsExpired pred;
-    for (auto i = m_queue.begin(); i != m_queue.end(); ++i)
+    // All entries share the same timeout, so they expire in queue order
+    while (!m_queue.empty() && m_queue.front().GetExpireTime() < Seconds(0))
+    {
+        Drop(PopFront(), DROP_TIMEOUT);
+    }
+}
+
+QueueEntry
+RequestQueue::PopFront()
+{
+    EntryIterator i = m_queue.begin();
+    auto d = m_dstQueue.find(i->GetIpv4Header().GetDestination());
+    NS_ASSERT(d != m_dstQueue.end() && d->second.front() == i);
+    d->second.pop_front();
+    if (d->second.empty())
     {
-        if (pred(*i))
-        {
-            Drop(*i, "Drop outdated packet ");
-        }
+        m_dstQueue.erase(d);
+    }
+    return Take(i);
+}
+
+QueueEntry
+RequestQueue::Take(EntryIterator i)
+{
+    m_uids.erase(std::make_pair(i->GetPacket()->GetUid(), i->GetIpv4Header().GetDestination()));
+    QueueEntry entry = std::move(*i);
+    m_queue.erase(i);
+    return entry;
+}
+
+std::string
+RequestQueue::GetDropReasonName(DropReason reason)
+{
+    switch (reason)
+    {
+    case DROP_QUEUE_FULL:
+        return "QueueFull";
+    case DROP_NO_ROUTE:
+        return "NoRoute";
+    case DROP_TIMEOUT:
+        return "Timeout";
+    default:
+        return "Unknown";
     }
-    m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(), pred), m_queue.end());
 }
 
 void
-RequestQueue::Drop(QueueEntry en, std::string reason)
+RequestQueue::Drop(QueueEntry en, DropReason reason)
 {
-    NS_LOG_LOGIC(reason << en.GetPacket()->GetUid() << " " << en.GetIpv4Header().GetDestination());
+    NS_LOG_LOGIC("Drop (" << GetDropReasonName(reason) << ") " << en.GetPacket()->GetUid() << " "
+                          << en.GetIpv4Header().GetDestination());
+    m_drops[reason]++;
+    if (!m_dropCallback.IsNull())
+    {
+        m_dropCallback(en, reason);
+    }
     en.GetErrorCallback()(en.GetPacket(), en.GetIpv4Header(), Socket::ERROR_NOROUTETOHOST);
 }
 
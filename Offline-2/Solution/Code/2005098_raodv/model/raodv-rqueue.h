@@ -19,6 +19,13 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/simulator.h"
 
+#include <array>
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace ns3
@@ -181,10 +188,26 @@ class QueueEntry
  * \brief raodv route request queue
  *
  * Since raodv is an on demand routing we queue requests while looking for route.
+ *
+ * Entries are kept in a single list ordered by age, which serves the eviction of the
+ * most aged packet and the timeout purge, and are indexed per destination by a FIFO of
+ * list iterators so that dequeue and drop by destination never scan unrelated packets.
  */
 class RequestQueue
 {
   public:
+    /// Reasons for which a queued packet is dropped
+    enum DropReason
+    {
+        DROP_QUEUE_FULL = 0, //!< The queue is full and the packet is the most aged one
+        DROP_NO_ROUTE = 1,   //!< The route discovery for the destination failed
+        DROP_TIMEOUT = 2,    //!< The packet waited longer than the queue timeout
+        DROP_REASONS = 3,    //!< Number of drop reasons
+    };
+
+    /// Callback notified of every dropped entry
+    typedef Callback<void, const QueueEntry&, DropReason> DropCallback;
+
     /**
      * constructor
      *
@@ -193,7 +216,8 @@ class RequestQueue
      */
     RequestQueue(uint32_t maxLen, Time routeToQueueTimeout)
         : m_maxLen(maxLen),
-          m_queueTimeout(routeToQueueTimeout)
+          m_queueTimeout(routeToQueueTimeout),
+          m_drops{}
     {
     }
 
@@ -212,6 +236,22 @@ class RequestQueue
      * \returns true if the entry is dequeued
      */
     bool Dequeue(Ipv4Address dst, QueueEntry& entry);
+    /**
+     * Remove all entries for given destination, the earliest first
+     *
+     * \param dst the destination IP address
+     * \param entries the vector the entries are appended to
+     * \returns true if at least one entry is dequeued
+     */
+    bool DequeueAll(Ipv4Address dst, std::vector<QueueEntry>& entries);
+    /**
+     * Put back an entry taken from the queue, keeping its expiration time. The entry is
+     * dropped if it expired meanwhile.
+     *
+     * \param entry the queue entry
+     * \returns true if the entry is queued
+     */
+    bool Requeue(const QueueEntry& entry);
     /**
      * Remove all packets with destination IP address dst
      * \param dst the destination IP address
@@ -258,7 +298,8 @@ class RequestQueue
     }
 
     /**
-     * Set queue timeout
+     * Set queue timeout. Entries are expected to expire in queue order, so the
+     * timeout should only be set before packets are queued.
      * \param t The queue timeout
      */
     void SetQueueTimeout(Time t)
@@ -266,22 +307,70 @@ class RequestQueue
         m_queueTimeout = t;
     }
 
+    /**
+     * Get the number of entries dropped for a reason
+     * \param reason the drop reason
+     * \returns the number of dropped entries
+     */
+    uint64_t GetDropCount(DropReason reason) const
+    {
+        return m_drops[reason];
+    }
+
+    /**
+     * Set the callback notified of every dropped entry
+     * \param cb the callback
+     */
+    void SetDropCallback(DropCallback cb)
+    {
+        m_dropCallback = cb;
+    }
+
+    /**
+     * Get the name of a drop reason
+     * \param reason the drop reason
+     * \returns the name
+     */
+    static std::string GetDropReasonName(DropReason reason);
+
   private:
-    /// The queue
-    std::vector<QueueEntry> m_queue;
+    /// Iterator to a queue entry
+    typedef std::list<QueueEntry>::iterator EntryIterator;
+
+    /// The queue, the most aged entry first
+    std::list<QueueEntry> m_queue;
+    /// Entries of every destination, the most aged first
+    std::map<Ipv4Address, std::deque<EntryIterator>> m_dstQueue;
+    /// Packet UID and destination of every queued entry
+    std::set<std::pair<uint64_t, Ipv4Address>> m_uids;
     /// Remove all expired entries
     void Purge();
+    /**
+     * Remove the most aged entry
+     * \returns the removed entry
+     */
+    QueueEntry PopFront();
+    /**
+     * Remove entry from the queue and the UID set, but not from the destination index
+     * \param i the entry to remove
+     * \returns the removed entry
+     */
+    QueueEntry Take(EntryIterator i);
     /**
      * Notify that packet is dropped from queue by timeout
      * \param en the queue entry to drop
      * \param reason the reason to drop the entry
      */
-    void Drop(QueueEntry en, std::string reason);
+    void Drop(QueueEntry en, DropReason reason);
     /// The maximum number of packets that we allow a routing protocol to buffer.
     uint32_t m_maxLen;
     /// The maximum period of time that a routing protocol is allowed to buffer a packet for,
     /// seconds.
     Time m_queueTimeout;
+    /// Number of dropped entries by reason
+    std::array<uint64_t, DROP_REASONS> m_drops;
+    /// Callback notified of every dropped entry
+    DropCallback m_dropCallback;
 };
 
 } // namespace raodv
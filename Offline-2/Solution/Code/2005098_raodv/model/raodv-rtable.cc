@@ -30,6 +30,54 @@ NS_LOG_COMPONENT_DEFINE("RaodvRoutingTable");
 namespace raodv
 {
 
+/*
+ The Precursor List
+ */
+
+void
+PrecursorList::push_back(Ipv4Address id)
+{
+    if (m_size < INLINE_CAPACITY)
+    {
+        m_inline[m_size++] = id;
+        return;
+    }
+    if (m_size == INLINE_CAPACITY)
+    {
+        m_heap.assign(m_inline, m_inline + INLINE_CAPACITY);
+    }
+    m_heap.push_back(id);
+    m_size++;
+}
+
+bool
+PrecursorList::erase(Ipv4Address id)
+{
+    if (m_size > INLINE_CAPACITY)
+    {
+        auto i = std::remove(m_heap.begin(), m_heap.end(), id);
+        if (i == m_heap.end())
+        {
+            return false;
+        }
+        m_heap.erase(i, m_heap.end());
+        m_size = m_heap.size();
+        if (m_size <= INLINE_CAPACITY)
+        {
+            std::copy(m_heap.begin(), m_heap.end(), m_inline);
+            m_heap.clear();
+        }
+        return true;
+    }
+    Ipv4Address* last = std::remove(m_inline, m_inline + m_size, id);
+    if (last == m_inline + m_size)
+    {
+        return false;
+    }
+    m_size = last - m_inline;
+    return true;
+}
+
 /*
  The Routing Table
  */
@@ -43,14 +91,17 @@ RoutingTableEntry::RoutingTableEntry(Ptr<NetDevice> dev,
                                      Ipv4Address nextHop,
                                      Time lifetime)
     : m_ackTimer(Timer::CANCEL_ON_DESTROY),
-      m_validSeqNo(vSeqNo),
-      m_seqNo(seqNo),
-      m_hops(hops),
       m_lifeTime(lifetime + Simulator::Now()),
-      m_iface(iface),
+      m_dst(dst),
+      m_nextHop(nextHop),
+      m_seqNo(seqNo),
       m_flag(VALID),
+      m_hops(hops),
       m_reqCount(0),
+      m_validSeqNo(vSeqNo),
       m_blackListState(false),
+      m_iface(iface),
+      m_cost(0),
       m_blackListTimeout(Simulator::Now())
 {
     m_ipv4Route = Create<Ipv4Route>();
@@ -99,17 +150,12 @@ bool
 RoutingTableEntry::DeletePrecursor(Ipv4Address id)
 {
     NS_LOG_FUNCTION(this << id);
-    auto i = std::remove(m_precursorList.begin(), m_precursorList.end(), id);
-    if (i == m_precursorList.end())
+    if (!m_precursorList.erase(id))
     {
         NS_LOG_LOGIC("Precursor " << id << " not found");
         return false;
     }
-    else
-    {
-        NS_LOG_LOGIC("Precursor " << id << " found");
-        m_precursorList.erase(i, m_precursorList.end());
-    }
+    NS_LOG_LOGIC("Precursor " << id << " found");
     return true;
 }
 
@@ -179,8 +225,8 @@ RoutingTableEntry::Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit /* = T
     std::ostringstream gw;
     std::ostringstream iface;
     std::ostringstream expire;
-    dest << m_ipv4Route->GetDestination();
-    gw << m_ipv4Route->GetGateway();
+    dest << m_dst;
+    gw << m_nextHop;
     iface << m_iface.GetLocal();
     expire << std::setprecision(2) << (m_lifeTime - Simulator::Now()).As(unit);
     *os << std::setw(16) << dest.str();
@@ -214,8 +260,99 @@ RoutingTableEntry::Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit /* = T
  */
 
 RoutingTable::RoutingTable(Time t)
-    : m_badLinkLifetime(t)
+    : m_maxAlternates(0),
+      m_badLinkLifetime(t),
+      m_cacheNext(0)
 {
+    ClearCache();
+}
+
+void
+RoutingTable::NotifySize()
+{
+    if (!m_sizeCallback.IsNull())
+    {
+        m_sizeCallback(m_ipv4AddressEntry.size());
+    }
+}
+
+RoutingTableEntry*
+RoutingTable::FindEntry(Ipv4Address dst)
+{
+    for (uint32_t c = 0; c < CACHE_SIZE; c++)
+    {
+        if (m_cache[c].second && m_cache[c].first == dst)
+        {
+            return m_cache[c].second;
+        }
+    }
+    auto i = m_ipv4AddressEntry.find(dst);
+    if (i == m_ipv4AddressEntry.end())
+    {
+        return nullptr;
+    }
+    m_cache[m_cacheNext] = std::make_pair(dst, &i->second);
+    m_cacheNext = (m_cacheNext + 1) % CACHE_SIZE;
+    return &i->second;
+}
+
+void
+RoutingTable::ClearCache()
+{
+    for (uint32_t c = 0; c < CACHE_SIZE; c++)
+    {
+        m_cache[c] = std::make_pair(Ipv4Address(), nullptr);
+    }
+}
+
+void
+RoutingTable::IndexExpiry(const RoutingTableEntry& rt)
+{
+    m_expiry.insert(std::make_pair(rt.GetLifeTime() + Simulator::Now(), rt.GetDestination()));
+}
+
+void
+RoutingTable::UnindexExpiry(const RoutingTableEntry& rt)
+{
+    m_expiry.erase(std::make_pair(rt.GetLifeTime() + Simulator::Now(), rt.GetDestination()));
+}
+
+void
+RoutingTable::IndexNextHop(const RoutingTableEntry& rt)
+{
+    Ipv4Address dst = rt.GetDestination();
+    Ipv4Address nextHop = rt.GetNextHop();
+    auto i = m_indexedNextHop.find(dst);
+    if (i != m_indexedNextHop.end())
+    {
+        if (i->second == nextHop)
+        {
+            return;
+        }
+        UnindexNextHop(dst);
+    }
+    m_indexedNextHop.insert(std::make_pair(dst, nextHop));
+    m_nextHopIndex.insert(std::make_pair(nextHop, dst));
+}
+
+void
+RoutingTable::UnindexNextHop(Ipv4Address dst)
+{
+    auto i = m_indexedNextHop.find(dst);
+    if (i == m_indexedNextHop.end())
+    {
+        return;
+    }
+    auto range = m_nextHopIndex.equal_range(i->second);
+    for (auto j = range.first; j != range.second; ++j)
+    {
+        if (j->second == dst)
+        {
+            m_nextHopIndex.erase(j);
+            break;
+        }
+    }
+    m_indexedNextHop.erase(i);
 }
 
 bool
@@ -228,13 +365,13 @@ RoutingTable::LookupRoute(Ipv4Address id, RoutingTableEntry& rt)
         NS_LOG_LOGIC("Route to " << id << " not found; m_ipv4AddressEntry is empty");
         return false;
     }
-    auto i = m_ipv4AddressEntry.find(id);
-    if (i == m_ipv4AddressEntry.end())
+    RoutingTableEntry* entry = FindEntry(id);
+    if (!entry)
     {
         NS_LOG_LOGIC("Route to " << id << " not found");
         return false;
     }
-    rt = i->second;
+    rt = *entry;
     NS_LOG_LOGIC("Route to " << id << " found");
     return true;
 }
@@ -253,13 +390,65 @@ RoutingTable::LookupValidRoute(Ipv4Address id, RoutingTableEntry& rt)
     return (rt.GetFlag() == VALID);
 }
 
+RoutingTableEntry*
+RoutingTable::FindRoute(Ipv4Address id)
+{
+    NS_LOG_FUNCTION(this << id);
+    Purge();
+    RoutingTableEntry* rt = FindEntry(id);
+    if (!rt)
+    {
+        NS_LOG_LOGIC("Route to " << id << " not found");
+    }
+    return rt;
+}
+
+RoutingTableEntry*
+RoutingTable::FindValidRoute(Ipv4Address id)
+{
+    RoutingTableEntry* rt = FindRoute(id);
+    return (rt && rt->GetFlag() == VALID) ? rt : nullptr;
+}
+
+const RoutingTableEntry*
+RoutingTable::TouchValidRoute(Ipv4Address id, Time lifetime)
+{
+    NS_LOG_FUNCTION(this << id << lifetime);
+    RoutingTableEntry* rt = FindValidRoute(id);
+    if (rt)
+    {
+        RefreshLifeTime(*rt, lifetime);
+    }
+    return rt;
+}
+
+void
+RoutingTable::RefreshLifeTime(RoutingTableEntry& rt, Time lifetime)
+{
+    NS_LOG_FUNCTION(this << rt.GetDestination() << lifetime);
+    rt.SetRreqCnt(0);
+    if (lifetime > rt.GetLifeTime())
+    {
+        UnindexExpiry(rt);
+        rt.SetLifeTime(lifetime);
+        IndexExpiry(rt);
+    }
+}
+
 bool
 RoutingTable::DeleteRoute(Ipv4Address dst)
 {
     NS_LOG_FUNCTION(this << dst);
     Purge();
-    if (m_ipv4AddressEntry.erase(dst) != 0)
+    auto i = m_ipv4AddressEntry.find(dst);
+    if (i != m_ipv4AddressEntry.end())
     {
+        ClearCache();
+        UnindexExpiry(i->second);
+        UnindexNextHop(dst);
+        m_alternates.erase(dst);
+        m_ipv4AddressEntry.erase(i);
+        NotifySize();
         NS_LOG_LOGIC("Route deletion to " << dst << " successful");
         return true;
     }
@@ -277,6 +466,12 @@ RoutingTable::AddRoute(RoutingTableEntry& rt)
         rt.SetRreqCnt(0);
     }
     auto result = m_ipv4AddressEntry.insert(std::make_pair(rt.GetDestination(), rt));
+    if (result.second)
+    {
+        IndexExpiry(rt);
+        IndexNextHop(rt);
+        NotifySize();
+    }
     return result.second;
 }
 
@@ -290,7 +485,10 @@ RoutingTable::Update(RoutingTableEntry& rt)
         NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " fails; not found");
         return false;
     }
+    UnindexExpiry(i->second);
     i->second = rt;
+    IndexExpiry(i->second);
+    IndexNextHop(i->second);
     if (i->second.GetFlag() != IN_SEARCH)
     {
         NS_LOG_LOGIC("Route update to " << rt.GetDestination() << " set RreqCnt to 0");
@@ -311,6 +509,8 @@ RoutingTable::SetEntryState(Ipv4Address id, RouteFlags state)
     }
     i->second.SetFlag(state);
     i->second.SetRreqCnt(0);
+    // The entry may have been left out of the index as an expired IN_SEARCH route
+    IndexExpiry(i->second);
     NS_LOG_LOGIC("Route set entry state to " << id << ": new state is " << state);
     return true;
 }
@@ -322,8 +522,11 @@ RoutingTable::GetListOfDestinationWithNextHop(Ipv4Address nextHop,
     NS_LOG_FUNCTION(this);
     Purge();
     unreachable.clear();
-    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end(); ++i)
+    auto range = m_nextHopIndex.equal_range(nextHop);
+    for (auto j = range.first; j != range.second; ++j)
     {
+        auto i = m_ipv4AddressEntry.find(j->second);
+        NS_ASSERT(i != m_ipv4AddressEntry.end());
         if (i->second.GetNextHop() == nextHop)
         {
             NS_LOG_LOGIC("Unreachable insert " << i->first << " " << i->second.GetSeqNo());
@@ -337,19 +540,141 @@ RoutingTable::InvalidateRoutesWithDst(const std::map<Ipv4Address, uint32_t>& unr
 {
     NS_LOG_FUNCTION(this);
     Purge();
-    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end(); ++i)
+    ClearCache();
+    for (auto j = unreachable.begin(); j != unreachable.end(); ++j)
     {
-        for (auto j = unreachable.begin(); j != unreachable.end(); ++j)
+        auto i = m_ipv4AddressEntry.find(j->first);
+        if (i != m_ipv4AddressEntry.end() && i->second.GetFlag() == VALID)
         {
-            if ((i->first == j->first) && (i->second.GetFlag() == VALID))
-            {
-                NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
-                i->second.Invalidate(m_badLinkLifetime);
-            }
+            NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
+            UnindexExpiry(i->second);
+            i->second.Invalidate(m_badLinkLifetime);
+            IndexExpiry(i->second);
         }
     }
 }
 
+bool
+RoutingTable::AddAlternate(Ipv4Address dst,
+                           Ipv4Address nextHop,
+                           uint16_t hops,
+                           Ipv4InterfaceAddress iface,
+                           Ptr<NetDevice> dev,
+                           Time lifetime)
+{
+    NS_LOG_FUNCTION(this << dst << nextHop << hops);
+    if (m_maxAlternates == 0)
+    {
+        return false;
+    }
+    auto i = m_ipv4AddressEntry.find(dst);
+    if (i == m_ipv4AddressEntry.end() || i->second.GetNextHop() == nextHop)
+    {
+        return false;
+    }
+    std::vector<AlternateHop>& alternates = m_alternates[dst];
+    PurgeAlternates(alternates, i->second.GetNextHop());
+    for (auto j = alternates.begin(); j != alternates.end(); ++j)
+    {
+        if (j->m_nextHop == nextHop)
+        {
+            alternates.erase(j);
+            break;
+        }
+    }
+    auto pos = alternates.begin();
+    while (pos != alternates.end() && pos->m_hops <= hops)
+    {
+        ++pos;
+    }
+    if (pos - alternates.begin() >= static_cast<std::ptrdiff_t>(m_maxAlternates))
+    {
+        NS_LOG_LOGIC("Alternate " << nextHop << " to " << dst << " is not among the best");
+        return false;
+    }
+    AlternateHop alternate;
+    alternate.m_nextHop = nextHop;
+    alternate.m_hops = hops;
+    alternate.m_iface = iface;
+    alternate.m_dev = dev;
+    alternate.m_expire = lifetime + Simulator::Now();
+    alternates.insert(pos, alternate);
+    if (alternates.size() > m_maxAlternates)
+    {
+        alternates.pop_back();
+    }
+    NS_LOG_LOGIC("Alternate " << nextHop << " to " << dst << " recorded, " << alternates.size()
+                              << " alternates");
+    return true;
+}
+
+uint32_t
+RoutingTable::GetAlternateCount(Ipv4Address dst)
+{
+    auto i = m_alternates.find(dst);
+    if (i == m_alternates.end())
+    {
+        return 0;
+    }
+    auto j = m_ipv4AddressEntry.find(dst);
+    NS_ASSERT(j != m_ipv4AddressEntry.end());
+    PurgeAlternates(i->second, j->second.GetNextHop());
+    return i->second.size();
+}
+
+void
+RoutingTable::FailOverRoutesWithNextHop(Ipv4Address nextHop,
+                                        std::map<Ipv4Address, uint32_t>& unreachable)
+{
+    NS_LOG_FUNCTION(this << nextHop);
+    if (m_alternates.empty())
+    {
+        return;
+    }
+    ClearCache();
+    for (auto j = unreachable.begin(); j != unreachable.end();)
+    {
+        auto alt = m_alternates.find(j->first);
+        auto i = m_ipv4AddressEntry.find(j->first);
+        // The route to the broken neighbor itself is never rerouted
+        if (alt == m_alternates.end() || i == m_ipv4AddressEntry.end() || j->first == nextHop ||
+            i->second.GetFlag() != VALID)
+        {
+            ++j;
+            continue;
+        }
+        PurgeAlternates(alt->second, nextHop);
+        if (alt->second.empty())
+        {
+            m_alternates.erase(alt);
+            ++j;
+            continue;
+        }
+        AlternateHop best = alt->second.front();
+        alt->second.erase(alt->second.begin());
+        NS_LOG_LOGIC("Route to " << j->first << " fails over from " << nextHop << " to "
+                                 << best.m_nextHop);
+        i->second.SetNextHop(best.m_nextHop);
+        i->second.SetHop(best.m_hops);
+        i->second.SetInterface(best.m_iface);
+        i->second.SetOutputDevice(best.m_dev);
+        IndexNextHop(i->second);
+        j = unreachable.erase(j);
+    }
+}
+
+void
+RoutingTable::PurgeAlternates(std::vector<AlternateHop>& alternates, Ipv4Address nextHop) const
+{
+    Time now = Simulator::Now();
+    alternates.erase(std::remove_if(alternates.begin(),
+                                    alternates.end(),
+                                    [now, nextHop](const AlternateHop& a) {
+                                        return a.m_expire < now || a.m_nextHop == nextHop;
+                                    }),
+                     alternates.end());
+}
+
 void
 RoutingTable::DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface)
 {
@@ -358,12 +683,16 @@ RoutingTable::DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface)
     {
         return;
     }
+    ClearCache();
     for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end();)
     {
         if (i->second.GetInterface() == iface)
         {
             auto tmp = i;
             ++i;
+            UnindexExpiry(tmp->second);
+            UnindexNextHop(tmp->first);
+            m_alternates.erase(tmp->first);
             m_ipv4AddressEntry.erase(tmp);
         }
         else
@@ -371,42 +700,39 @@ RoutingTable::DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface)
             ++i;
         }
     }
+    NotifySize();
 }
 
 void
 RoutingTable::Purge()
 {
     NS_LOG_FUNCTION(this);
-    if (m_ipv4AddressEntry.empty())
-    {
-        return;
-    }
-    for (auto i = m_ipv4AddressEntry.begin(); i != m_ipv4AddressEntry.end();)
+    Time now = Simulator::Now();
+    std::size_t size = m_ipv4AddressEntry.size();
+    while (!m_expiry.empty() && m_expiry.begin()->first < now)
     {
-        if (i->second.GetLifeTime() < Seconds(0))
+        Ipv4Address dst = m_expiry.begin()->second;
+        m_expiry.erase(m_expiry.begin());
+        auto i = m_ipv4AddressEntry.find(dst);
+        NS_ASSERT(i != m_ipv4AddressEntry.end());
+        if (i->second.GetFlag() == INVALID)
         {
-            if (i->second.GetFlag() == INVALID)
-            {
-                auto tmp = i;
-                ++i;
-                m_ipv4AddressEntry.erase(tmp);
-            }
-            else if (i->second.GetFlag() == VALID)
-            {
-                NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
-                i->second.Invalidate(m_badLinkLifetime);
-                ++i;
-            }
-            else
-            {
-                ++i;
-            }
+            ClearCache();
+            UnindexNextHop(dst);
+            m_alternates.erase(dst);
+            m_ipv4AddressEntry.erase(i);
         }
-        else
+        else if (i->second.GetFlag() == VALID)
         {
-            ++i;
+            NS_LOG_LOGIC("Invalidate route with destination address " << i->first);
+            i->second.Invalidate(m_badLinkLifetime);
+            IndexExpiry(i->second);
         }
     }
+    if (m_ipv4AddressEntry.size() != size)
+    {
+        NotifySize();
+    }
 }
 
 void
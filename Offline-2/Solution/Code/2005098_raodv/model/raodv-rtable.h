@@ -16,6 +16,7 @@
 #ifndef RAODV_RTABLE_H
 #define RAODV_RTABLE_H
 
+#include "ns3/callback.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4.h"
 #include "ns3/net-device.h"
@@ -24,8 +25,10 @@
 
 #include <cassert>
 #include <map>
+#include <set>
 #include <stdint.h>
 #include <sys/types.h>
+#include <vector>
 
 namespace ns3
 {
@@ -43,9 +46,94 @@ enum RouteFlags
     IN_SEARCH = 2, //!< IN_SEARCH
 };
 
+/**
+ * \ingroup raodv
+ * \brief Precursor list of a routing table entry
+ *
+ * A route has few precursors, so the first INLINE_CAPACITY ones are stored in
+ * the list itself and copying an entry does not allocate. Larger lists move to
+ * the heap as a whole.
+ */
+class PrecursorList
+{
+  public:
+    /// Number of precursors stored without allocation
+    static constexpr uint32_t INLINE_CAPACITY = 4;
+
+    PrecursorList()
+        : m_size(0)
+    {
+    }
+
+    /**
+     * \returns the number of precursors
+     */
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \returns true if there is no precursor
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * \returns the first precursor
+     */
+    const Ipv4Address* begin() const
+    {
+        return m_size > INLINE_CAPACITY ? m_heap.data() : m_inline;
+    }
+
+    /**
+     * \returns the end of the precursors
+     */
+    const Ipv4Address* end() const
+    {
+        return begin() + m_size;
+    }
+
+    /**
+     * Append a precursor
+     * \param id precursor address
+     */
+    void push_back(Ipv4Address id);
+    /**
+     * Remove a precursor
+     * \param id precursor address
+     * \return true if it was in the list
+     */
+    bool erase(Ipv4Address id);
+
+    /// Remove all precursors
+    void clear()
+    {
+        m_size = 0;
+        m_heap.clear();
+    }
+
+  private:
+    /// Number of precursors
+    uint32_t m_size;
+    /// Precursors while there are at most INLINE_CAPACITY of them
+    Ipv4Address m_inline[INLINE_CAPACITY];
+    /// Precursors once there are more than INLINE_CAPACITY of them
+    std::vector<Ipv4Address> m_heap;
+};
+
 /**
  * \ingroup raodv
  * \brief Routing table entry
+ *
+ * The fields read on every data packet (destination, next hop, sequence
+ * number, flag, hop count and expiration time) are kept together at the start
+ * of the entry, and the destination and next hop are also cached out of the
+ * Ipv4Route so that reading them does not follow the route pointer. Copies of
+ * an entry share its Ipv4Route.
  */
 class RoutingTableEntry
 {
@@ -120,7 +208,7 @@ class RoutingTableEntry
      */
     Ipv4Address GetDestination() const
     {
-        return m_ipv4Route->GetDestination();
+        return m_dst;
     }
 
     /**
@@ -139,6 +227,8 @@ class RoutingTableEntry
     void SetRoute(Ptr<Ipv4Route> r)
     {
         m_ipv4Route = r;
+        m_dst = r->GetDestination();
+        m_nextHop = r->GetGateway();
     }
 
     /**
@@ -147,6 +237,8 @@ class RoutingTableEntry
      */
     void SetNextHop(Ipv4Address nextHop)
     {
+        m_nextHop = nextHop;
+        UnshareRoute();
         m_ipv4Route->SetGateway(nextHop);
     }
 
@@ -156,7 +248,7 @@ class RoutingTableEntry
      */
     Ipv4Address GetNextHop() const
     {
-        return m_ipv4Route->GetGateway();
+        return m_nextHop;
     }
 
     /**
@@ -165,6 +257,7 @@ class RoutingTableEntry
      */
     void SetOutputDevice(Ptr<NetDevice> dev)
     {
+        UnshareRoute();
         m_ipv4Route->SetOutputDevice(dev);
     }
 
@@ -187,12 +280,14 @@ class RoutingTableEntry
     }
 
     /**
-     * Set the Ipv4InterfaceAddress
+     * Set the Ipv4InterfaceAddress, and the route source with it
      * \param iface The Ipv4InterfaceAddress
      */
     void SetInterface(Ipv4InterfaceAddress iface)
     {
         m_iface = iface;
+        UnshareRoute();
+        m_ipv4Route->SetSource(iface.GetLocal());
     }
 
     /**
@@ -249,6 +344,24 @@ class RoutingTableEntry
         return m_hops;
     }
 
+    /**
+     * Set the path cost, the sum of the link costs to the destination
+     * \param cost the path cost
+     */
+    void SetCost(uint32_t cost)
+    {
+        m_cost = cost;
+    }
+
+    /**
+     * Get the path cost
+     * \returns the path cost, 0 if link costs are not used
+     */
+    uint32_t GetCost() const
+    {
+        return m_cost;
+    }
+
     /**
      * Set the lifetime
      * \param lt The lifetime
@@ -357,7 +470,7 @@ class RoutingTableEntry
      */
     bool operator==(const Ipv4Address dst) const
     {
-        return (m_ipv4Route->GetDestination() == dst);
+        return (m_dst == dst);
     }
 
     /**
@@ -368,12 +481,6 @@ class RoutingTableEntry
     void Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
   private:
-    /// Valid Destination Sequence Number flag
-    bool m_validSeqNo;
-    /// Destination Sequence Number, if m_validSeqNo = true
-    uint32_t m_seqNo;
-    /// Hop Count (number of hops needed to reach destination)
-    uint16_t m_hops;
     /**
      * \brief Expiration or deletion time of the route
      * Lifetime field in the routing table plays dual role:
@@ -381,6 +488,23 @@ class RoutingTableEntry
      * it is the deletion time.
      */
     Time m_lifeTime;
+    /// Destination address, the one of m_ipv4Route
+    Ipv4Address m_dst;
+    /// Next hop address, the gateway of m_ipv4Route
+    Ipv4Address m_nextHop;
+    /// Destination Sequence Number, if m_validSeqNo = true
+    uint32_t m_seqNo;
+    /// Routing flags: valid, invalid or in search
+    RouteFlags m_flag;
+    /// Hop Count (number of hops needed to reach destination)
+    uint16_t m_hops;
+    /// Number of route requests
+    uint8_t m_reqCount;
+    /// Valid Destination Sequence Number flag
+    bool m_validSeqNo;
+    /// Indicate if this entry is in "blacklist"
+    bool m_blackListState;
+
     /** Ip route, include
      *   - destination address
      *   - source address
@@ -388,19 +512,24 @@ class RoutingTableEntry
      *   - output device
      */
     Ptr<Ipv4Route> m_ipv4Route;
+    /**
+     * Give the entry its own copy of m_ipv4Route before it is changed. Copies of the entry, like
+     * the ones LookupRoute returns, share the route, and a change through one of them must
+     * leave the entry in the table and its next hop index as they are.
+     */
+    void UnshareRoute()
+    {
+        if (m_ipv4Route->GetReferenceCount() > 1)
+        {
+            m_ipv4Route = Create<Ipv4Route>(*m_ipv4Route);
+        }
+    }
     /// Output interface address
     Ipv4InterfaceAddress m_iface;
-    /// Routing flags: valid, invalid or in search
-    RouteFlags m_flag;
-
+    /// Path cost, in Neighbors::LINK_COST_UNIT per expected transmission
+    uint32_t m_cost;
     /// List of precursors
-    std::vector<Ipv4Address> m_precursorList;
-    /// When I can send another request
-    Time m_routeRequestTimeout;
-    /// Number of route requests
-    uint8_t m_reqCount;
-    /// Indicate if this entry is in "blacklist"
-    bool m_blackListState;
+    PrecursorList m_precursorList;
     /// Time for which the node is put into the blacklist
     Time m_blackListTimeout;
 };
@@ -412,6 +541,9 @@ class RoutingTableEntry
 class RoutingTable
 {
   public:
+    /// Callback notified of the number of entries whenever entries are added or removed
+    typedef Callback<void, uint32_t> SizeCallback;
+
     /**
      * constructor
      * \param t the routing table entry lifetime
@@ -441,6 +573,67 @@ class RoutingTable
     }
 
     //\}
+
+    /// \name Multipath route cache
+    //\{
+    /**
+     * Get the maximum number of alternate next hops kept per destination
+     *
+     * \return the maximum number of alternate next hops, 0 if multipath is disabled
+     */
+    uint32_t GetMaxAlternates() const
+    {
+        return m_maxAlternates;
+    }
+
+    /**
+     * Set the maximum number of alternate next hops kept per destination
+     *
+     * \param n the maximum number of alternate next hops, 0 disables multipath
+     */
+    void SetMaxAlternates(uint32_t n)
+    {
+        m_maxAlternates = n;
+        if (n == 0)
+        {
+            m_alternates.clear();
+        }
+    }
+
+    /**
+     * Record an alternate next hop to an existing destination. The alternates of a destination
+     * are kept by increasing hop count, up to GetMaxAlternates () distinct next hops; the current
+     * next hop of the route is never recorded.
+     * \param dst destination address
+     * \param nextHop the alternate next hop
+     * \param hops number of hops to dst via nextHop
+     * \param iface the interface on which nextHop was heard
+     * \param dev the output device towards nextHop
+     * \param lifetime time the alternate stays usable
+     * \return true if the alternate was recorded or refreshed
+     */
+    bool AddAlternate(Ipv4Address dst,
+                      Ipv4Address nextHop,
+                      uint16_t hops,
+                      Ipv4InterfaceAddress iface,
+                      Ptr<NetDevice> dev,
+                      Time lifetime);
+    /**
+     * Get the number of usable alternate next hops to a destination
+     * \param dst destination address
+     * \return the number of alternates
+     */
+    uint32_t GetAlternateCount(Ipv4Address dst);
+    /**
+     * Move the valid routes listed in unreachable off the broken next hop onto their best
+     * remaining alternate. Rerouted destinations are removed from unreachable, so that only
+     * the routes which have no alternate are left to be invalidated and reported in a RERR.
+     * \param nextHop the broken next hop
+     * \param unreachable routes using nextHop, as returned by GetListOfDestinationWithNextHop
+     */
+    void FailOverRoutesWithNextHop(Ipv4Address nextHop,
+                                   std::map<Ipv4Address, uint32_t>& unreachable);
+    //\}
     /**
      * Add routing table entry if it doesn't yet exist in routing table
      * \param r routing table entry
@@ -467,6 +660,47 @@ class RoutingTable
      * \return true on success
      */
     bool LookupValidRoute(Ipv4Address dst, RoutingTableEntry& rt);
+    /**
+     * Lookup routing table entry with destination address dst without copying it. The entry
+     * must not be kept across changes of the routing table, and its lifetime must only be
+     * changed through RefreshLifeTime.
+     * \param dst destination address
+     * \return the entry, or nullptr if there is none
+     */
+    RoutingTableEntry* FindRoute(Ipv4Address dst);
+    /**
+     * Lookup route in VALID state without copying it, see FindRoute
+     * \param dst destination address
+     * \return the entry, or nullptr if there is no valid route
+     */
+    RoutingTableEntry* FindValidRoute(Ipv4Address dst);
+    /**
+     * Lookup a valid route and, in the same lookup, extend its lifetime to at least lifetime
+     * and reset its RREQ count. The entry must not be kept across changes of the routing
+     * table.
+     * \param dst destination address
+     * \param lifetime the minimum remaining lifetime
+     * \return the entry, or nullptr if there is no valid route
+     */
+    const RoutingTableEntry* TouchValidRoute(Ipv4Address dst, Time lifetime);
+    /**
+     * Extend the lifetime of a valid route to at least lifetime and reset its RREQ count,
+     * in place
+     * \param dst destination address
+     * \param lifetime the minimum remaining lifetime
+     * \return true if there is a valid route to dst
+     */
+    bool RefreshLifeTime(Ipv4Address dst, Time lifetime)
+    {
+        return TouchValidRoute(dst, lifetime) != nullptr;
+    }
+    /**
+     * Extend the lifetime of an entry returned by FindRoute to at least lifetime and reset
+     * its RREQ count, without looking it up again
+     * \param rt the entry
+     * \param lifetime the minimum remaining lifetime
+     */
+    void RefreshLifeTime(RoutingTableEntry& rt, Time lifetime);
     /**
      * Update routing table
      * \param rt entry with destination address dst, if exists
@@ -489,7 +723,8 @@ class RoutingTable
     void GetListOfDestinationWithNextHop(Ipv4Address nextHop,
                                          std::map<Ipv4Address, uint32_t>& unreachable);
     /**
-     * Update routing entries with this destination as follows:
+     * Update routing entries with this destination as follows (one lookup per
+     * unreachable destination):
      * 1. The destination sequence number of this routing entry, if it
      *    exists and is valid, is incremented.
      * 2. The entry is invalidated by marking the route entry as invalid
@@ -503,13 +738,40 @@ class RoutingTable
      */
     void DeleteAllRoutesFromInterface(Ipv4InterfaceAddress iface);
 
+    /**
+     * Get the number of entries, whatever their state
+     * \returns the number of routing table entries
+     */
+    uint32_t GetSize() const
+    {
+        return m_ipv4AddressEntry.size();
+    }
+
+    /**
+     * Set the callback notified of the number of entries whenever entries are added or removed
+     * \param cb the callback
+     */
+    void SetSizeCallback(SizeCallback cb)
+    {
+        m_sizeCallback = cb;
+    }
+
     /// Delete all entries from routing table
     void Clear()
     {
+        ClearCache();
         m_ipv4AddressEntry.clear();
+        m_expiry.clear();
+        m_nextHopIndex.clear();
+        m_indexedNextHop.clear();
+        m_alternates.clear();
+        NotifySize();
     }
 
-    /// Delete all outdated entries and invalidate valid entry if Lifetime is expired
+    /**
+     * Delete all outdated entries and invalidate valid entry if Lifetime is expired.
+     * Only the entries whose lifetime has actually expired are visited.
+     */
     void Purge();
     /** Mark entry as unidirectional (e.g. add this neighbor to "blacklist" for blacklistTimeout
      * period)
@@ -526,10 +788,84 @@ class RoutingTable
     void Print(Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
 
   private:
+    /// Expiration time and destination of a routing table entry
+    typedef std::pair<Time, Ipv4Address> Expiry;
+
+    /// Alternate next hop to a destination
+    struct AlternateHop
+    {
+        Ipv4Address m_nextHop;        //!< next hop address
+        uint16_t m_hops;              //!< number of hops to the destination
+        Ipv4InterfaceAddress m_iface; //!< output interface address
+        Ptr<NetDevice> m_dev;         //!< output device
+        Time m_expire;                //!< absolute expiration time
+    };
+
     /// The routing table
     std::map<Ipv4Address, RoutingTableEntry> m_ipv4AddressEntry;
+    /**
+     * Lifetime-sorted index of the routing table entries, earliest expiration first.
+     * Expired IN_SEARCH entries are left out of it until they are modified again.
+     */
+    std::set<Expiry> m_expiry;
+    /// Destinations of the routing table entries, indexed by their next hop
+    std::multimap<Ipv4Address, Ipv4Address> m_nextHopIndex;
+    /// Next hop under which each destination is filed in m_nextHopIndex
+    std::map<Ipv4Address, Ipv4Address> m_indexedNextHop;
+    /// Alternate next hops of the destinations, best first
+    std::map<Ipv4Address, std::vector<AlternateHop>> m_alternates;
+    /// Maximum number of alternate next hops per destination
+    uint32_t m_maxAlternates;
     /// Deletion time for invalid routes
     Time m_badLinkLifetime;
+    /// Number of destinations in the lookup cache
+    static constexpr uint32_t CACHE_SIZE = 4;
+    /**
+     * Entries of the last looked up destinations, so that the several lookups made for one
+     * data packet find them without searching the table. Cleared whenever entries are
+     * removed or routes are invalidated.
+     */
+    std::pair<Ipv4Address, RoutingTableEntry*> m_cache[CACHE_SIZE];
+    /// Cache slot replaced by the next miss
+    uint32_t m_cacheNext;
+    /// Callback notified of the number of entries
+    SizeCallback m_sizeCallback;
+    /// Notify the size callback, if any, of the number of entries
+    void NotifySize();
+    /**
+     * Find the entry of a destination through the lookup cache
+     * \param dst the destination address
+     * \return the entry, or nullptr if there is none
+     */
+    RoutingTableEntry* FindEntry(Ipv4Address dst);
+    /// Empty the lookup cache
+    void ClearCache();
+    /**
+     * Add entry to the lifetime index
+     * \param rt the routing table entry
+     */
+    void IndexExpiry(const RoutingTableEntry& rt);
+    /**
+     * Remove entry from the lifetime index. Must be called before the entry lifetime changes.
+     * \param rt the routing table entry
+     */
+    void UnindexExpiry(const RoutingTableEntry& rt);
+    /**
+     * File entry destination under its current next hop, moving it if the next hop has changed
+     * \param rt the routing table entry
+     */
+    void IndexNextHop(const RoutingTableEntry& rt);
+    /**
+     * Remove destination from the next hop index
+     * \param dst the destination address
+     */
+    void UnindexNextHop(Ipv4Address dst);
+    /**
+     * Drop the expired alternates of a destination and those through the given next hop
+     * \param alternates the alternates of the destination
+     * \param nextHop next hop which may no longer be used
+     */
+    void PurgeAlternates(std::vector<AlternateHop>& alternates, Ipv4Address nextHop) const;
     /**
      * const version of Purge, for use by Print() method
      * \param table the routing table entry to purge
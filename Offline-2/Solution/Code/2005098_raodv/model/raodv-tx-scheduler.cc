@@ -0,0 +1,95 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+#include "raodv-tx-scheduler.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <utility>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RaodvTxScheduler");
+
+namespace raodv
+{
+
+TxScheduler::TxScheduler(Time slot)
+    : m_slot(slot)
+{
+}
+
+TxScheduler::~TxScheduler()
+{
+    Clear();
+}
+
+void
+TxScheduler::Schedule(Time delay, Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination)
+{
+    Time at = Simulator::Now() + delay;
+    if (m_slot.IsStrictlyPositive())
+    {
+        int64_t slot = m_slot.GetTimeStep();
+        at = TimeStep((at.GetTimeStep() + slot - 1) / slot * slot);
+    }
+    Slot& s = m_slots[at];
+    if (s.m_sends.empty())
+    {
+        s.m_event =
+            Simulator::Schedule(at - Simulator::Now(), &TxScheduler::Drain, this, at);
+    }
+    s.m_sends.push_back({socket, packet, destination});
+    NS_LOG_LOGIC("Send to " << destination << " in slot " << at.As(Time::S) << ", "
+                            << s.m_sends.size() << " sends");
+}
+
+void
+TxScheduler::Clear()
+{
+    for (auto i = m_slots.begin(); i != m_slots.end(); ++i)
+    {
+        i->second.m_event.Cancel();
+    }
+    m_slots.clear();
+}
+
+uint32_t
+TxScheduler::GetPendingCount() const
+{
+    uint32_t n = 0;
+    for (auto i = m_slots.begin(); i != m_slots.end(); ++i)
+    {
+        n += i->second.m_sends.size();
+    }
+    return n;
+}
+
+void
+TxScheduler::Drain(Time at)
+{
+    auto i = m_slots.find(at);
+    NS_ASSERT(i != m_slots.end());
+    std::vector<Send> sends;
+    sends.swap(i->second.m_sends);
+    m_slots.erase(i);
+
+    // Fisher-Yates shuffle, so that the sends bucketed into a slot still go out in a random
+    // order. Without slots only sends due at the same time share the event: keep them FIFO.
+    if (m_slot.IsStrictlyPositive() && m_rv && sends.size() > 1)
+    {
+        for (uint32_t j = sends.size() - 1; j > 0; --j)
+        {
+            std::swap(sends[j], sends[m_rv->GetInteger(0, j)]);
+        }
+    }
+    for (auto j = sends.begin(); j != sends.end(); ++j)
+    {
+        m_send(j->m_socket, j->m_packet, j->m_destination);
+    }
+}
+
+} // namespace raodv
+} // namespace ns3
@@ -0,0 +1,143 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef RAODV_TX_SCHEDULER_H
+#define RAODV_TX_SCHEDULER_H
+
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/socket.h"
+
+#include <map>
+#include <vector>
+
+namespace ns3
+{
+namespace raodv
+{
+/**
+ * \ingroup raodv
+ *
+ * \brief Per node scheduler of jittered control packet sends.
+ *
+ * Every control packet is sent after a random jitter. Instead of one simulator event per
+ * packet, the sends are bucketed into slots: the send time is rounded up to a multiple of the
+ * slot length, and all sends of a slot are drained by a single event, in a random order.
+ * With a zero slot length only sends due at the very same time share an event, and they are
+ * sent in the order they were scheduled.
+ */
+class TxScheduler
+{
+  public:
+    /// Callback sending a packet through a socket to a destination
+    typedef Callback<void, Ptr<Socket>, Ptr<Packet>, Ipv4Address> SendCallback;
+
+    /**
+     * constructor
+     * \param slot the slot length
+     */
+    TxScheduler(Time slot);
+    /// destructor, cancels the pending slots
+    ~TxScheduler();
+
+    /**
+     * Schedule a send
+     * \param delay the jitter before the send
+     * \param socket the socket to send through
+     * \param packet the packet
+     * \param destination the destination address
+     */
+    void Schedule(Time delay, Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination);
+    /// Drop all pending sends
+    void Clear();
+    /**
+     * Get the number of pending sends
+     * \returns the number of sends not drained yet
+     */
+    uint32_t GetPendingCount() const;
+    /**
+     * Get the number of pending slots, i.e. of scheduled simulator events
+     * \returns the number of slots not drained yet
+     */
+    uint32_t GetSlotCount() const
+    {
+        return m_slots.size();
+    }
+
+    /**
+     * Set the callback sending a packet
+     * \param cb the callback
+     */
+    void SetSendCallback(SendCallback cb)
+    {
+        m_send = cb;
+    }
+
+    /**
+     * Set the random variable used to order the sends of a slot
+     * \param rv the random variable
+     */
+    void SetRandomVariable(Ptr<UniformRandomVariable> rv)
+    {
+        m_rv = rv;
+    }
+
+    /**
+     * Set the slot length
+     * \param slot the slot length
+     */
+    void SetSlot(Time slot)
+    {
+        m_slot = slot;
+    }
+
+    /**
+     * Get the slot length
+     * \returns the slot length
+     */
+    Time GetSlot() const
+    {
+        return m_slot;
+    }
+
+  private:
+    /// A pending send
+    struct Send
+    {
+        Ptr<Socket> m_socket;      ///< Socket to send through
+        Ptr<Packet> m_packet;      ///< Packet
+        Ipv4Address m_destination; ///< Destination address
+    };
+
+    /// The sends due in one slot
+    struct Slot
+    {
+        std::vector<Send> m_sends; ///< Sends, in scheduling order
+        EventId m_event;           ///< Event draining the slot
+    };
+
+    /**
+     * Send all packets of a slot, in random order if the slot length is positive
+     * \param at the slot time
+     */
+    void Drain(Time at);
+
+    /// Slot length
+    Time m_slot;
+    /// Pending slots by time
+    std::map<Time, Slot> m_slots;
+    /// Send callback
+    SendCallback m_send;
+    /// Random variable ordering the sends of a slot
+    Ptr<UniformRandomVariable> m_rv;
+};
+
+} // namespace raodv
+} // namespace ns3
+
+#endif /* RAODV_TX_SCHEDULER_H */
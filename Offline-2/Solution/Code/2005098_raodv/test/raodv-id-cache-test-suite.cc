@@ -98,6 +98,100 @@ IdCacheTest::CheckTimeout3()
     NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 0, "All records expire");
 }
 
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for id cache expiration when lifetime gets shorter
+ */
+class IdCacheShorterLifetimeTest : public TestCase
+{
+  public:
+    IdCacheShorterLifetimeTest()
+        : TestCase("Id Cache expiration order"),
+          cache(Seconds(20))
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /// Timeout test function #1
+    void CheckTimeout1();
+    /// Timeout test function #2
+    void CheckTimeout2();
+
+    /// ID cache
+    IdCache cache;
+};
+
+void
+IdCacheShorterLifetimeTest::DoRun()
+{
+    cache.IsDuplicate(Ipv4Address("1.2.3.4"), 1);
+    cache.IsDuplicate(Ipv4Address("1.2.3.4"), 2);
+    cache.SetLifetime(Seconds(5));
+    cache.IsDuplicate(Ipv4Address("4.3.2.1"), 1);
+    NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 3, "trivial");
+
+    Simulator::Schedule(Seconds(6), &IdCacheShorterLifetimeTest::CheckTimeout1, this);
+    Simulator::Schedule(Seconds(21), &IdCacheShorterLifetimeTest::CheckTimeout2, this);
+    Simulator::Run();
+    Simulator::Destroy();
+}
+
+void
+IdCacheShorterLifetimeTest::CheckTimeout1()
+{
+    NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 2, "Record added last expires first");
+    // Re-added with a 20 s lifetime, the record outlives the ones added at 0 s
+    cache.SetLifetime(Seconds(20));
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("4.3.2.1"), 1), false, "Expired record");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("1.2.3.4"), 2), true, "Known record");
+}
+
+void
+IdCacheShorterLifetimeTest::CheckTimeout2()
+{
+    // The records added at 0 s expired at 20 s, the one re-added at 6 s expires at 26 s
+    NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 1, "Re-added record left");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(Ipv4Address("4.3.2.1"), 1), true, "Re-added record");
+}
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for id cache records keyed on two addresses and an ID
+ */
+class IdCacheTripleTest : public TestCase
+{
+  public:
+    IdCacheTripleTest()
+        : TestCase("Id Cache (addr, dst, id) records")
+    {
+    }
+
+    void DoRun() override;
+};
+
+void
+IdCacheTripleTest::DoRun()
+{
+    IdCache cache(Seconds(10));
+    Ipv4Address origin("10.1.1.1");
+    Ipv4Address dst("10.1.1.2");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(origin, dst, 1), false, "Unknown record");
+    NS_TEST_EXPECT_MSG_EQ(cache.Contains(origin, dst, 1), true, "Known record");
+    NS_TEST_EXPECT_MSG_EQ(cache.Contains(origin, dst, 2), false, "Other ID");
+    NS_TEST_EXPECT_MSG_EQ(cache.Contains(origin, Ipv4Address("10.1.1.3"), 1),
+                          false,
+                          "Other destination");
+    NS_TEST_EXPECT_MSG_EQ(cache.Contains(dst, origin, 1), false, "Swapped addresses");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(origin, dst, 2), false, "New ID of a known pair");
+    NS_TEST_EXPECT_MSG_EQ(cache.IsDuplicate(origin, dst, 1), true, "Known record");
+    NS_TEST_EXPECT_MSG_EQ(cache.GetSize(), 2, "trivial");
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup raodv-test
  *
@@ -110,6 +204,8 @@ class IdCacheTestSuite : public TestSuite
         : TestSuite("raodv-routing-id-cache", Type::UNIT)
     {
         AddTestCase(new IdCacheTest, TestCase::Duration::QUICK);
+        AddTestCase(new IdCacheShorterLifetimeTest, TestCase::Duration::QUICK);
+        AddTestCase(new IdCacheTripleTest, TestCase::Duration::QUICK);
     }
 } g_idCacheTestSuite; ///< the test suite
 
@@ -0,0 +1,561 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/raodv-helper.h"
+#include "ns3/raodv-packet.h"
+#include "ns3/raodv-routing-protocol.h"
+#include "ns3/boolean.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/simulator.h"
+#include "ns3/socket-factory.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/yans-wifi-helper.h"
+
+#include <vector>
+
+namespace ns3
+{
+namespace raodv
+{
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Builds two raodv WiFi nodes in range of each other
+ */
+class TwoNodeTestCase : public TestCase
+{
+  protected:
+    /**
+     * Constructor
+     * \param name test case name
+     */
+    TwoNodeTestCase(std::string name)
+        : TestCase(name)
+    {
+    }
+
+    /**
+     * Create the nodes, install the stack and assign 10.1.1.1 and 10.1.1.2
+     * \param raodv the raodv helper, with the attributes of the test
+     * \param plainFirst whether node 0 gets the stack without raodv, e.g. to inject messages
+     */
+    void CreateNodes(RaodvHelper& raodv, bool plainFirst = false)
+    {
+        m_nodes.Create(2);
+        for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+        {
+            Ptr<MobilityModel> m = CreateObject<ConstantPositionMobilityModel>();
+            m->SetPosition(Vector(i * 100, 0, 0));
+            m_nodes.Get(i)->AggregateObject(m);
+        }
+        WifiMacHelper wifiMac;
+        wifiMac.SetType("ns3::AdhocWifiMac");
+        YansWifiPhyHelper wifiPhy;
+        YansWifiChannelHelper wifiChannel = YansWifiChannelHelper::Default();
+        wifiPhy.SetChannel(wifiChannel.Create());
+        WifiHelper wifi;
+        wifi.SetStandard(WIFI_STANDARD_80211a);
+        wifi.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+                                     "DataMode",
+                                     StringValue("OfdmRate6Mbps"),
+                                     "RtsCtsThreshold",
+                                     StringValue("2200"));
+        NetDeviceContainer devices = wifi.Install(wifiPhy, wifiMac, m_nodes);
+
+        InternetStackHelper internetStack;
+        internetStack.SetRoutingHelper(raodv);
+        for (uint32_t i = 0; i < m_nodes.GetN(); i++)
+        {
+            if (i == 0 && plainFirst)
+            {
+                InternetStackHelper().Install(m_nodes.Get(i));
+            }
+            else
+            {
+                internetStack.Install(m_nodes.Get(i));
+            }
+        }
+        Ipv4AddressHelper address;
+        address.SetBase("10.1.1.0", "255.255.255.0");
+        m_interfaces = address.Assign(devices);
+    }
+
+    /**
+     * \param i node index
+     * \returns the raodv routing protocol of the node
+     */
+    Ptr<RoutingProtocol> GetRouting(uint32_t i) const
+    {
+        return DynamicCast<RoutingProtocol>(
+            m_nodes.Get(i)->GetObject<Ipv4>()->GetRoutingProtocol());
+    }
+
+    NodeContainer m_nodes;               //!< the nodes
+    Ipv4InterfaceContainer m_interfaces; //!< their addresses
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Packets queued during a route discovery are released one every QueueReleaseInterval,
+ * and the release stops when the route breaks
+ */
+class QueueReleaseTest : public TwoNodeTestCase
+{
+  public:
+    /**
+     * Constructor
+     * \param breakAfter number of packets released before the route of the sender breaks, 0
+     * for none
+     */
+    QueueReleaseTest(uint32_t breakAfter)
+        : TwoNodeTestCase(breakAfter ? "Paced queue release stops when the route breaks"
+                                     : "Paced queue release spacing"),
+          m_breakAfter(breakAfter)
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /// Send the burst to node 1, before any route to it exists
+    void SendBurst();
+    /**
+     * Record a packet released from the queue
+     * \param packet the packet
+     * \param wait its queue wait
+     */
+    void QueueWait(Ptr<const Packet> packet, Time wait);
+    /**
+     * Record a packet dropped from the queue
+     * \param packet the packet
+     * \param reason why it was dropped
+     */
+    void QueueDrop(Ptr<const Packet> packet, RequestQueue::DropReason reason);
+    /// Break the route of the sender by bringing its interface down
+    void BreakRoute();
+
+    static constexpr uint32_t PACKETS = 10; //!< burst size
+    uint32_t m_breakAfter;                  //!< released packets before the break, 0 for none
+    Ptr<Socket> m_socket;                   //!< sender socket
+    std::vector<Time> m_released;           //!< release times
+    uint32_t m_dropped{0};                  //!< packets dropped from the queue
+    Time m_breakTime;                       //!< time of the break
+};
+
+void
+QueueReleaseTest::SendBurst()
+{
+    InetSocketAddress to(m_interfaces.GetAddress(1), 9);
+    for (uint32_t i = 0; i < PACKETS; i++)
+    {
+        m_socket->SendTo(Create<Packet>(500), 0, to);
+    }
+}
+
+void
+QueueReleaseTest::QueueWait(Ptr<const Packet> packet, Time wait)
+{
+    m_released.push_back(Simulator::Now());
+    if (m_released.size() == m_breakAfter)
+    {
+        // Halfway to the next release
+        Simulator::Schedule(MilliSeconds(5), &QueueReleaseTest::BreakRoute, this);
+    }
+}
+
+void
+QueueReleaseTest::QueueDrop(Ptr<const Packet> packet, RequestQueue::DropReason reason)
+{
+    m_dropped++;
+}
+
+void
+QueueReleaseTest::BreakRoute()
+{
+    m_breakTime = Simulator::Now();
+    m_nodes.Get(0)->GetObject<Ipv4>()->SetDown(1);
+}
+
+void
+QueueReleaseTest::DoRun()
+{
+    RaodvHelper raodv;
+    raodv.Set("QueueReleaseInterval", TimeValue(MilliSeconds(10)));
+    CreateNodes(raodv);
+    Ptr<RoutingProtocol> routing = GetRouting(0);
+    routing->TraceConnectWithoutContext("QueueWait",
+                                        MakeCallback(&QueueReleaseTest::QueueWait, this));
+    routing->TraceConnectWithoutContext("QueueDrop",
+                                        MakeCallback(&QueueReleaseTest::QueueDrop, this));
+
+    m_socket = m_nodes.Get(0)->GetObject<UdpSocketFactory>()->CreateSocket();
+    Simulator::ScheduleWithContext(m_nodes.Get(0)->GetId(),
+                                   Seconds(1),
+                                   &QueueReleaseTest::SendBurst,
+                                   this);
+
+    // Long enough for the discoveries after the break to give up
+    Simulator::Stop(Seconds(m_breakAfter ? 40 : 5));
+    Simulator::Run();
+    m_socket->Close();
+    Simulator::Destroy();
+
+    uint32_t released = m_breakAfter ? m_breakAfter : PACKETS;
+    NS_TEST_ASSERT_MSG_EQ(m_released.size(), released, "Unexpected number of released packets");
+    for (std::size_t i = 1; i < m_released.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_released[i] - m_released[i - 1],
+                              MilliSeconds(10),
+                              "Released packets must be QueueReleaseInterval apart");
+    }
+    if (m_breakAfter)
+    {
+        NS_TEST_EXPECT_MSG_LT(m_released.back(), m_breakTime, "Released after the break");
+        NS_TEST_EXPECT_MSG_EQ(m_dropped,
+                              PACKETS - m_breakAfter,
+                              "The packets not released must go back to the queue and be "
+                              "dropped once no route is found");
+    }
+    else
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_dropped, 0, "No packet must be dropped");
+    }
+}
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Duplicate reverse RREQs: which copies are suppressed and which are forwarded, with
+ * counter-based suppression and aggregation
+ *
+ * Node 0 has no raodv. It sends the copies to node 1 and records the reverse RREQs node 1
+ * rebroadcasts.
+ */
+class RevRreqDuplicateTest : public TwoNodeTestCase
+{
+  public:
+    /// A reverse RREQ copy sent to node 1
+    struct Copy
+    {
+        Time m_at;            //!< send time
+        Ipv4Address m_origin; //!< origin of the reverse RREQ
+        uint32_t m_id;        //!< reverse RREQ ID
+    };
+
+    /**
+     * Constructor
+     * \param name test case name
+     * \param threshold the RevRreqCounterThreshold attribute
+     * \param aggregation the RevRreqAggregation attribute
+     * \param copies the copies sent to node 1
+     * \param forwarded IDs of the reverse RREQs node 1 must rebroadcast, in order
+     * \param suppressed number of copies node 1 must suppress
+     */
+    RevRreqDuplicateTest(std::string name,
+                         uint32_t threshold,
+                         bool aggregation,
+                         std::vector<Copy> copies,
+                         std::vector<uint32_t> forwarded,
+                         uint64_t suppressed)
+        : TwoNodeTestCase(name),
+          m_threshold(threshold),
+          m_aggregation(aggregation),
+          m_copies(copies),
+          m_expectedForwarded(forwarded),
+          m_expectedSuppressed(suppressed)
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Send a reverse RREQ copy to node 1
+     * \param copy the copy
+     */
+    void SendCopy(Copy copy);
+    /**
+     * Receive the raodv messages of node 1
+     * \param socket the socket
+     */
+    void Receive(Ptr<Socket> socket);
+
+    uint32_t m_threshold;                      //!< counter-based suppression threshold
+    bool m_aggregation;                        //!< whether aggregation is enabled
+    std::vector<Copy> m_copies;                //!< copies to send
+    std::vector<uint32_t> m_expectedForwarded; //!< expected rebroadcast IDs
+    uint64_t m_expectedSuppressed;             //!< expected suppressed copies
+    Ptr<Socket> m_socket;                      //!< node 0 socket, on the raodv port
+    std::vector<uint32_t> m_forwarded;         //!< IDs of the rebroadcasts heard
+};
+
+void
+RevRreqDuplicateTest::SendCopy(Copy copy)
+{
+    RevRreqHeader header(/*flags=*/0,
+                         /*reserved=*/0,
+                         /*hopCount=*/1,
+                         /*requestID=*/copy.m_id,
+                         /*dst=*/Ipv4Address("10.1.1.60"),
+                         /*dstSeqNo=*/1,
+                         /*origin=*/copy.m_origin,
+                         /*originSeqNo=*/1);
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(header);
+    packet->AddHeader(TypeHeader(RAODVTYPE_R_RREQ));
+    m_socket->SendTo(packet,
+                     0,
+                     InetSocketAddress(m_interfaces.GetAddress(1), RoutingProtocol::RAODV_PORT));
+}
+
+void
+RevRreqDuplicateTest::Receive(Ptr<Socket> socket)
+{
+    Ptr<Packet> packet = socket->Recv();
+    TypeHeader tHeader;
+    packet->RemoveHeader(tHeader);
+    if (tHeader.Get() != RAODVTYPE_R_RREQ)
+    {
+        return; // Hellos
+    }
+    RevRreqHeader header;
+    packet->RemoveHeader(header);
+    m_forwarded.push_back(header.GetId());
+}
+
+void
+RevRreqDuplicateTest::DoRun()
+{
+    RaodvHelper raodv;
+    raodv.Set("RevRreqCounterThreshold", UintegerValue(m_threshold));
+    raodv.Set("RevRreqAggregation", BooleanValue(m_aggregation));
+    CreateNodes(raodv, true);
+
+    m_socket = m_nodes.Get(0)->GetObject<UdpSocketFactory>()->CreateSocket();
+    m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), RoutingProtocol::RAODV_PORT));
+    m_socket->SetAllowBroadcast(true);
+    m_socket->SetRecvCallback(MakeCallback(&RevRreqDuplicateTest::Receive, this));
+    for (auto i = m_copies.begin(); i != m_copies.end(); ++i)
+    {
+        Simulator::ScheduleWithContext(m_nodes.Get(0)->GetId(),
+                                       i->m_at,
+                                       &RevRreqDuplicateTest::SendCopy,
+                                       this,
+                                       *i);
+    }
+
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+    const RoutingProtocol::Statistics& stats = GetRouting(1)->GetStatistics();
+    uint64_t received = stats.m_messages[RAODVTYPE_R_RREQ][RoutingProtocol::MESSAGE_RECEIVED];
+    uint64_t suppressed = stats.m_messages[RAODVTYPE_R_RREQ][RoutingProtocol::MESSAGE_SUPPRESSED];
+    m_socket->Close();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(received, m_copies.size(), "Every copy must be received");
+    NS_TEST_EXPECT_MSG_EQ(suppressed, m_expectedSuppressed, "Unexpected suppressed copies");
+    NS_TEST_ASSERT_MSG_EQ(m_forwarded.size(),
+                          m_expectedForwarded.size(),
+                          "Unexpected number of rebroadcasts");
+    for (std::size_t i = 0; i < m_forwarded.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(m_forwarded[i], m_expectedForwarded[i], "Unexpected rebroadcast");
+    }
+}
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Multi-destination RREQs which overlap a previous one only partly: the destinations
+ * already seen are dropped and the others are still forwarded
+ *
+ * Node 0 has no raodv. It sends the RREQs to node 1 and records the RREQs node 1 rebroadcasts.
+ */
+class MultiDestinationRreqTest : public TwoNodeTestCase
+{
+  public:
+    MultiDestinationRreqTest()
+        : TwoNodeTestCase("Partly duplicate multi-destination RREQ")
+    {
+    }
+
+    void DoRun() override;
+
+  private:
+    /**
+     * Send a RREQ of origin 10.1.1.50 to node 1
+     * \param destinations the destinations of the RREQ, the primary one first
+     */
+    void SendRequest(std::vector<RreqHeader::Destination> destinations);
+    /**
+     * Receive the raodv messages of node 1
+     * \param socket the socket
+     */
+    void Receive(Ptr<Socket> socket);
+
+    Ptr<Socket> m_socket;                              //!< node 0 socket, on the raodv port
+    std::vector<std::vector<Ipv4Address>> m_forwarded; //!< destinations of the rebroadcasts heard
+};
+
+void
+MultiDestinationRreqTest::SendRequest(std::vector<RreqHeader::Destination> destinations)
+{
+    RreqHeader header(/*flags=*/0,
+                      /*reserved=*/0,
+                      /*hopCount=*/1,
+                      /*requestID=*/destinations.front().m_id,
+                      /*dst=*/destinations.front().m_dst,
+                      /*dstSeqNo=*/0,
+                      /*origin=*/Ipv4Address("10.1.1.50"),
+                      /*originSeqNo=*/1);
+    header.SetUnknownSeqno(true);
+    for (auto i = destinations.begin() + 1; i != destinations.end(); ++i)
+    {
+        header.AddDestination(*i);
+    }
+    Ptr<Packet> packet = Create<Packet>();
+    packet->AddHeader(header);
+    packet->AddHeader(TypeHeader(RAODVTYPE_RREQ));
+    m_socket->SendTo(packet,
+                     0,
+                     InetSocketAddress(m_interfaces.GetAddress(1), RoutingProtocol::RAODV_PORT));
+}
+
+void
+MultiDestinationRreqTest::Receive(Ptr<Socket> socket)
+{
+    Ptr<Packet> packet = socket->Recv();
+    TypeHeader tHeader;
+    packet->RemoveHeader(tHeader);
+    if (tHeader.Get() != RAODVTYPE_RREQ)
+    {
+        return; // Hellos
+    }
+    RreqHeader header;
+    packet->RemoveHeader(header);
+    std::vector<Ipv4Address> destinations{header.GetDst()};
+    for (const auto& extra : header.GetDestinations())
+    {
+        destinations.push_back(extra.m_dst);
+    }
+    m_forwarded.push_back(destinations);
+}
+
+void
+MultiDestinationRreqTest::DoRun()
+{
+    RaodvHelper raodv;
+    CreateNodes(raodv, true);
+
+    m_socket = m_nodes.Get(0)->GetObject<UdpSocketFactory>()->CreateSocket();
+    m_socket->Bind(InetSocketAddress(Ipv4Address::GetAny(), RoutingProtocol::RAODV_PORT));
+    m_socket->SetAllowBroadcast(true);
+    m_socket->SetRecvCallback(MakeCallback(&MultiDestinationRreqTest::Receive, this));
+
+    Ipv4Address a("10.1.1.60");
+    Ipv4Address b("10.1.1.61");
+    Ipv4Address c("10.1.1.62");
+    std::vector<std::vector<RreqHeader::Destination>> requests{
+        {{a, 1, 0, true}, {b, 2, 0, true}},
+        // Same primary destination, with an unseen extra one
+        {{a, 1, 0, true}, {c, 3, 0, true}},
+        // Every destination already seen
+        {{b, 2, 0, true}, {c, 3, 0, true}}};
+    for (std::size_t i = 0; i < requests.size(); i++)
+    {
+        Simulator::ScheduleWithContext(m_nodes.Get(0)->GetId(),
+                                       Seconds(1 + 0.1 * i),
+                                       &MultiDestinationRreqTest::SendRequest,
+                                       this,
+                                       requests[i]);
+    }
+
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+    const RoutingProtocol::Statistics& stats = GetRouting(1)->GetStatistics();
+    uint64_t suppressed = stats.m_messages[RAODVTYPE_RREQ][RoutingProtocol::MESSAGE_SUPPRESSED];
+    m_socket->Close();
+    Simulator::Destroy();
+
+    NS_TEST_EXPECT_MSG_EQ(suppressed, 1, "Only the RREQ with no unseen destination is dropped");
+    std::vector<std::vector<Ipv4Address>> expected{{a, b}, {c}};
+    NS_TEST_ASSERT_MSG_EQ(m_forwarded.size(), expected.size(), "Unexpected number of rebroadcasts");
+    for (std::size_t i = 0; i < m_forwarded.size(); i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(m_forwarded[i].size(),
+                              expected[i].size(),
+                              "Unexpected number of destinations");
+        for (std::size_t j = 0; j < m_forwarded[i].size(); j++)
+        {
+            NS_TEST_EXPECT_MSG_EQ(m_forwarded[i][j], expected[i][j], "Unexpected destination");
+        }
+    }
+}
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief raodv protocol behaviour test suite
+ */
+class RaodvProtocolTestSuite : public TestSuite
+{
+  public:
+    RaodvProtocolTestSuite()
+        : TestSuite("routing-raodv-protocol", Type::SYSTEM)
+    {
+        AddTestCase(new QueueReleaseTest(0), TestCase::Duration::QUICK);
+        AddTestCase(new QueueReleaseTest(4), TestCase::Duration::QUICK);
+
+        Ipv4Address a("10.1.1.50");
+        Ipv4Address b("10.1.1.51");
+        // The first copy is forwarded at once, the later ones are duplicates, a newer discovery
+        // is forwarded again
+        AddTestCase(new RevRreqDuplicateTest("Reverse RREQ duplicates",
+                                             0,
+                                             false,
+                                             {{Seconds(1), a, 1},
+                                              {Seconds(1.001), a, 1},
+                                              {Seconds(1.002), a, 1},
+                                              {Seconds(1.1), a, 2}},
+                                             {1, 2},
+                                             2),
+                    TestCase::Duration::QUICK);
+        // Two copies heard during the assessment delay cancel the rebroadcast of a, the
+        // single copy of b is forwarded
+        AddTestCase(new RevRreqDuplicateTest("Reverse RREQ counter-based suppression",
+                                             2,
+                                             false,
+                                             {{Seconds(1), a, 1},
+                                              {Seconds(1.001), a, 1},
+                                              {Seconds(1.002), a, 1},
+                                              {Seconds(1.003), b, 1}},
+                                             {1},
+                                             3),
+                    TestCase::Duration::QUICK);
+        // The newer discovery of a and the copies of both are merged into one rebroadcast
+        AddTestCase(new RevRreqDuplicateTest("Reverse RREQ aggregation",
+                                             0,
+                                             true,
+                                             {{Seconds(1), a, 1},
+                                              {Seconds(1.001), a, 2},
+                                              {Seconds(1.002), a, 2},
+                                              {Seconds(1.003), a, 1}},
+                                             {2},
+                                             3),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new MultiDestinationRreqTest, TestCase::Duration::QUICK);
+    }
+} g_raodvProtocolTestSuite; ///< the test suite
+
+} // namespace raodv
+} // namespace ns3
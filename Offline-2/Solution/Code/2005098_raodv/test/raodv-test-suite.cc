@@ -9,7 +9,9 @@
 #include "ns3/raodv-packet.h"
 #include "ns3/raodv-rqueue.h"
 #include "ns3/raodv-rtable.h"
+#include "ns3/raodv-tx-scheduler.h"
 #include "ns3/ipv4-route.h"
+#include "ns3/socket.h"
 #include "ns3/test.h"
 
 namespace ns3
@@ -122,6 +124,134 @@ NeighborTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for event driven expiry of neighbors
+ */
+struct NeighborExpiryTest : public TestCase
+{
+    NeighborExpiryTest()
+        : TestCase("Neighbor expiry"),
+          neighbor(Seconds(1))
+    {
+    }
+
+    /**
+     * Handler test function
+     * \param addr the IPv4 address of the neighbor
+     */
+    void Handler(Ipv4Address addr)
+    {
+        m_lost.emplace_back(Simulator::Now(), addr);
+    }
+
+    void DoRun() override
+    {
+        neighbor.SetCallback(MakeCallback(&NeighborExpiryTest::Handler, this));
+        neighbor.Update(Ipv4Address("1.1.1.1"), Seconds(5));
+        neighbor.Update(Ipv4Address("2.2.2.2"), Seconds(3));
+        neighbor.Update(Ipv4Address("3.3.3.3"), Seconds(8));
+        neighbor.Update(Ipv4Address("2.2.2.2"), Seconds(1));
+        neighbor.Update(Ipv4Address("3.3.3.3"), Seconds(9));
+        Simulator::Run();
+        Simulator::Destroy();
+
+        NS_TEST_ASSERT_MSG_EQ(m_lost.size(), 3, "All neighbors are lost");
+        NS_TEST_EXPECT_MSG_EQ(m_lost[0].second, Ipv4Address("2.2.2.2"), "Expire time is kept");
+        NS_TEST_EXPECT_MSG_EQ(m_lost[1].second, Ipv4Address("1.1.1.1"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_lost[2].second, Ipv4Address("3.3.3.3"), "Expire time is extended");
+        NS_TEST_EXPECT_MSG_EQ(m_lost[0].first, Seconds(3) + TimeStep(1), "Lost at expire time");
+        NS_TEST_EXPECT_MSG_EQ(m_lost[1].first, Seconds(5) + TimeStep(1), "Lost at expire time");
+        NS_TEST_EXPECT_MSG_EQ(m_lost[2].first, Seconds(9) + TimeStep(1), "Lost at expire time");
+    }
+
+    /// Neighbors
+    Neighbors neighbor;
+    /// Time and address of the lost neighbors
+    std::vector<std::pair<Time, Ipv4Address>> m_lost;
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for the neighbor set change count used by adaptive hellos
+ */
+struct NeighborChangeCountTest : public TestCase
+{
+    NeighborChangeCountTest()
+        : TestCase("Neighbor change count"),
+          neighbor(Seconds(1))
+    {
+    }
+
+    /// Check the change count once the neighbor with the earliest expire time is lost
+    void CheckLost()
+    {
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetChangeCount(), m_count + 1, "A loss is a change");
+        m_count = neighbor.GetChangeCount();
+        neighbor.Update(Ipv4Address("2.2.2.2"), Seconds(10));
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetChangeCount(), m_count, "A refresh is no change");
+        neighbor.Clear();
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetChangeCount(), m_count + 1, "Clear is a change");
+    }
+
+    void DoRun() override
+    {
+        m_count = neighbor.GetChangeCount();
+        neighbor.Update(Ipv4Address("1.1.1.1"), Seconds(2));
+        neighbor.Update(Ipv4Address("2.2.2.2"), Seconds(5));
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetChangeCount(), m_count + 2, "Two neighbors added");
+        m_count = neighbor.GetChangeCount();
+        neighbor.Update(Ipv4Address("1.1.1.1"), Seconds(3));
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetChangeCount(), m_count, "A refresh is no change");
+        Simulator::Schedule(Seconds(4), &NeighborChangeCountTest::CheckLost, this);
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+
+    /// Neighbors
+    Neighbors neighbor;
+    /// Change count at the last check
+    uint32_t m_count;
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for the SNR based link costs of the neighbors
+ */
+struct NeighborLinkCostTest : public TestCase
+{
+    NeighborLinkCostTest()
+        : TestCase("Neighbor link cost")
+    {
+    }
+
+    void DoRun() override
+    {
+        Neighbors neighbor(Seconds(1));
+        Ipv4Address a("1.1.1.1");
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetLinkCost(a), Neighbors::LINK_COST_UNIT, "Unknown link");
+        neighbor.UpdateSnr(a, 30);
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetLinkCost(a), Neighbors::LINK_COST_UNIT, "Good link");
+        for (uint32_t i = 0; i < 100; i++)
+        {
+            neighbor.UpdateSnr(a, 0);
+        }
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetLinkCost(a),
+                              Neighbors::LINK_COST_UNIT * Neighbors::MAX_LINK_TRANSMISSIONS,
+                              "Poor link");
+        Ipv4Address b("2.2.2.2");
+        neighbor.UpdateSnr(b, (Neighbors::GOOD_SNR + Neighbors::POOR_SNR) / 2);
+        NS_TEST_EXPECT_MSG_GT(neighbor.GetLinkCost(b), Neighbors::LINK_COST_UNIT, "trivial");
+        NS_TEST_EXPECT_MSG_LT(neighbor.GetLinkCost(b), neighbor.GetLinkCost(a), "trivial");
+        neighbor.Clear();
+        NS_TEST_EXPECT_MSG_EQ(neighbor.GetLinkCost(a), Neighbors::LINK_COST_UNIT, "Cleared");
+        Simulator::Destroy();
+    }
+};
+
 /**
  * \ingroup raodv-test
  *
@@ -205,6 +335,33 @@ struct RreqHeaderTest : public TestCase
         uint32_t bytes = p->RemoveHeader(h2);
         NS_TEST_EXPECT_MSG_EQ(bytes, 23, "RREP is 23 bytes long");
         NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+
+        RreqHeader::Destination extra = {Ipv4Address("2.2.2.2"), 56, 0, true};
+        NS_TEST_EXPECT_MSG_EQ(h.AddDestination(extra), true, "trivial");
+        extra = {Ipv4Address("3.3.3.3"), 57, 12, false};
+        NS_TEST_EXPECT_MSG_EQ(h.AddDestination(extra), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetDestinations().size(), 2, "trivial");
+        p = Create<Packet>();
+        p->AddHeader(h);
+        RreqHeader h3;
+        bytes = p->RemoveHeader(h3);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 49, "13 bytes per additional destination");
+        NS_TEST_EXPECT_MSG_EQ(h, h3, "Round trip serialization works");
+        NS_TEST_EXPECT_MSG_EQ(h3.GetDestinations()[0].m_unknownSeqNo, true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h3.GetDestinations()[1].m_dstSeqNo, 12, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h3.GetDestinations()[1].m_id, 57, "trivial");
+        h3.ClearDestinations();
+        NS_TEST_EXPECT_MSG_EQ(h3, h2, "Back to a plain RREQ");
+
+        h3.SetCost(1000);
+        p = Create<Packet>();
+        p->AddHeader(h3);
+        RreqHeader h4;
+        bytes = p->RemoveHeader(h4);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 25, "The path cost takes 2 bytes");
+        NS_TEST_EXPECT_MSG_EQ(h4.GetCost(), 1000, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h4.GetUnknownSeqno(), h3.GetUnknownSeqno(), "Flags kept");
+        NS_TEST_EXPECT_MSG_EQ(h4, h3, "Round trip serialization works");
     }
 };
 
@@ -262,6 +419,18 @@ struct RrepHeaderTest : public TestCase
         uint32_t bytes = p->RemoveHeader(h2);
         NS_TEST_EXPECT_MSG_EQ(bytes, 19, "RREP is 19 bytes long");
         NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+
+        NS_TEST_EXPECT_MSG_EQ(h.HasCost(), false, "trivial");
+        h.SetCost(300);
+        NS_TEST_EXPECT_MSG_EQ(h.HasCost(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h.GetAckRequired(), h2.GetAckRequired(), "Flags kept");
+        p = Create<Packet>();
+        p->AddHeader(h);
+        RrepHeader h3;
+        bytes = p->RemoveHeader(h3);
+        NS_TEST_EXPECT_MSG_EQ(bytes, 21, "The path cost takes 2 bytes");
+        NS_TEST_EXPECT_MSG_EQ(h3.GetCost(), 300, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(h, h3, "Round trip serialization works");
     }
 };
 
@@ -323,6 +492,135 @@ struct RerrHeaderTest : public TestCase
     }
 };
 
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for the wire image of control messages
+ */
+struct ControlMessageTest : public TestCase
+{
+    ControlMessageTest()
+        : TestCase("raodv control message")
+    {
+    }
+
+    void DoRun() override
+    {
+        RerrHeader h;
+        h.AddUnDestination(Ipv4Address("1.2.3.4"), 12);
+        h.AddUnDestination(Ipv4Address("4.3.2.1"), 13);
+        ControlMessage message(h, RAODVTYPE_RERR);
+        TypeHeader tHeader(RAODVTYPE_RERR);
+        NS_TEST_EXPECT_MSG_EQ(message.GetSize(),
+                              tHeader.GetSerializedSize() + h.GetSerializedSize(),
+                              "trivial");
+
+        Ptr<Packet> p1 = message.CreatePacket(1);
+        Ptr<Packet> p2 = message.CreatePacket(7);
+        NS_TEST_EXPECT_MSG_EQ(p1->GetSize(), message.GetSize(), "trivial");
+        SocketIpTtlTag tag;
+        NS_TEST_EXPECT_MSG_EQ(p2->PeekPacketTag(tag), true, "TTL tag is set");
+        NS_TEST_EXPECT_MSG_EQ(static_cast<uint32_t>(tag.GetTtl()), 7, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(p1->PeekPacketTag(tag), true, "TTL tag is set");
+        NS_TEST_EXPECT_MSG_EQ(static_cast<uint32_t>(tag.GetTtl()), 1, "Each packet has its own TTL");
+
+        TypeHeader t2;
+        p1->RemoveHeader(t2);
+        NS_TEST_EXPECT_MSG_EQ(t2.IsValid(), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(t2.Get(), RAODVTYPE_RERR, "trivial");
+        RerrHeader h2;
+        p1->RemoveHeader(h2);
+        NS_TEST_EXPECT_MSG_EQ(h, h2, "Round trip serialization works");
+        NS_TEST_EXPECT_MSG_EQ(p2->GetSize(),
+                              message.GetSize(),
+                              "Packets sharing the image are independent");
+    }
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for the control packet send scheduler
+ */
+struct TxSchedulerTest : public TestCase
+{
+    TxSchedulerTest()
+        : TestCase("TxScheduler"),
+          scheduler(MilliSeconds(1))
+    {
+    }
+
+    /**
+     * Send callback
+     * \param socket the socket
+     * \param packet the packet
+     * \param destination the destination
+     */
+    void Send(Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination)
+    {
+        m_sent.emplace_back(Simulator::Now(), destination);
+    }
+
+    void DoRun() override
+    {
+        scheduler.SetSendCallback(MakeCallback(&TxSchedulerTest::Send, this));
+        scheduler.SetRandomVariable(CreateObject<UniformRandomVariable>());
+        scheduler.Schedule(MicroSeconds(200), nullptr, Create<Packet>(), Ipv4Address("1.1.1.1"));
+        scheduler.Schedule(MicroSeconds(700), nullptr, Create<Packet>(), Ipv4Address("2.2.2.2"));
+        scheduler.Schedule(MilliSeconds(1), nullptr, Create<Packet>(), Ipv4Address("3.3.3.3"));
+        scheduler.Schedule(MicroSeconds(1500), nullptr, Create<Packet>(), Ipv4Address("4.4.4.4"));
+        NS_TEST_EXPECT_MSG_EQ(scheduler.GetPendingCount(), 4, "All sends are pending");
+        NS_TEST_EXPECT_MSG_EQ(scheduler.GetSlotCount(), 2, "Sends share the 1 ms and 2 ms slots");
+        Simulator::Run();
+
+        NS_TEST_ASSERT_MSG_EQ(m_sent.size(), 4, "All packets are sent");
+        uint32_t late = 0;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            NS_TEST_EXPECT_MSG_EQ(m_sent[i].first, MilliSeconds(1), "Sent at the end of the slot");
+            late += (m_sent[i].second == Ipv4Address("4.4.4.4")) ? 1 : 0;
+        }
+        NS_TEST_EXPECT_MSG_EQ(late, 0, "Only sends of the slot are drained");
+        NS_TEST_EXPECT_MSG_EQ(m_sent[3].first, MilliSeconds(2), "Next slot");
+        NS_TEST_EXPECT_MSG_EQ(m_sent[3].second, Ipv4Address("4.4.4.4"), "Next slot");
+        NS_TEST_EXPECT_MSG_EQ(scheduler.GetSlotCount(), 0, "All slots are drained");
+
+        scheduler.Schedule(MilliSeconds(1), nullptr, Create<Packet>(), Ipv4Address("5.5.5.5"));
+        scheduler.Clear();
+        Simulator::Run();
+        NS_TEST_EXPECT_MSG_EQ(m_sent.size(), 4, "Cleared sends are dropped");
+
+        // Without slots the sends due at the same time keep their order, with no random draw
+        Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+        Ptr<UniformRandomVariable> reference = CreateObject<UniformRandomVariable>();
+        rv->SetStream(1);
+        reference->SetStream(1);
+        m_sent.clear();
+        TxScheduler fifo(Seconds(0));
+        fifo.SetSendCallback(MakeCallback(&TxSchedulerTest::Send, this));
+        fifo.SetRandomVariable(rv);
+        for (uint8_t i = 1; i <= 5; ++i)
+        {
+            fifo.Schedule(MilliSeconds(1), nullptr, Create<Packet>(), Ipv4Address(i));
+        }
+        Simulator::Run();
+        NS_TEST_ASSERT_MSG_EQ(m_sent.size(), 5, "All packets are sent");
+        for (uint8_t i = 1; i <= 5; ++i)
+        {
+            NS_TEST_EXPECT_MSG_EQ(m_sent[i - 1].second, Ipv4Address(i), "Sent in FIFO order");
+        }
+        NS_TEST_EXPECT_MSG_EQ(rv->GetInteger(0, 1000000),
+                              reference->GetInteger(0, 1000000),
+                              "No random draw without slots");
+        Simulator::Destroy();
+    }
+
+    /// The scheduler
+    TxScheduler scheduler;
+    /// Time and destination of the sent packets
+    std::vector<std::pair<Time, Ipv4Address>> m_sent;
+};
+
 /**
  * \ingroup raodv-test
  *
@@ -539,6 +837,166 @@ RaodvRqueueTest::CheckTimeout()
     NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 0, "Must be empty now");
 }
 
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for bulk dequeue and eviction order of the request queue
+ */
+struct RaodvRqueueDequeueAllTest : public TestCase
+{
+    RaodvRqueueDequeueAllTest()
+        : TestCase("Rqueue DequeueAll")
+    {
+    }
+
+    /**
+     * Unicast test function
+     * \param route the IPv4 route
+     * \param packet the packet
+     * \param header the IPv4 header
+     */
+    void Unicast(Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header& header)
+    {
+    }
+
+    /**
+     * Error test function
+     * \param p The packet
+     * \param h The header
+     * \param e the socket error
+     */
+    void Error(Ptr<const Packet> p, const Ipv4Header& h, Socket::SocketErrno e)
+    {
+        m_dropped.push_back(p->GetUid());
+    }
+
+    void DoRun() override
+    {
+        RequestQueue q(4, Seconds(10));
+        Ipv4RoutingProtocol::UnicastForwardCallback ucb =
+            MakeCallback(&RaodvRqueueDequeueAllTest::Unicast, this);
+        Ipv4RoutingProtocol::ErrorCallback ecb =
+            MakeCallback(&RaodvRqueueDequeueAllTest::Error, this);
+        std::vector<Ptr<Packet>> packets;
+        Ipv4Header h;
+        for (uint32_t i = 0; i < 5; ++i)
+        {
+            packets.push_back(Create<Packet>());
+            h.SetDestination(i % 2 ? Ipv4Address("2.2.2.2") : Ipv4Address("1.1.1.1"));
+            QueueEntry e(packets.back(), h, ucb, ecb);
+            NS_TEST_EXPECT_MSG_EQ(q.Enqueue(e), true, "trivial");
+        }
+        NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 4, "Queue is full");
+        NS_TEST_EXPECT_MSG_EQ(m_dropped.size(), 1, "Most aged packet is dropped");
+        NS_TEST_EXPECT_MSG_EQ(m_dropped.front(), packets[0]->GetUid(), "trivial");
+
+        std::vector<QueueEntry> entries;
+        NS_TEST_EXPECT_MSG_EQ(q.DequeueAll(Ipv4Address("3.3.3.3"), entries), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(q.DequeueAll(Ipv4Address("1.1.1.1"), entries), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entries.size(), 2, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(entries[0].GetPacket()->GetUid(),
+                              packets[2]->GetUid(),
+                              "Earliest entry first");
+        NS_TEST_EXPECT_MSG_EQ(entries[1].GetPacket()->GetUid(), packets[4]->GetUid(), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(q.Find(Ipv4Address("1.1.1.1")), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 2, "trivial");
+        h.SetDestination(Ipv4Address("1.1.1.1"));
+        QueueEntry e(packets[2], h, ucb, ecb);
+        NS_TEST_EXPECT_MSG_EQ(q.Enqueue(e), true, "Dequeued packet may be queued again");
+        NS_TEST_EXPECT_MSG_EQ(m_dropped.size(), 1, "trivial");
+        Simulator::Destroy();
+    }
+
+    /// UIDs of the dropped packets
+    std::vector<uint64_t> m_dropped;
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for the drop reason counters of the request queue
+ */
+struct RaodvRqueueDropReasonTest : public TestCase
+{
+    RaodvRqueueDropReasonTest()
+        : TestCase("Rqueue drop reasons"),
+          q(2, Seconds(1))
+    {
+    }
+
+    /**
+     * Unicast test function
+     * \param route the IPv4 route
+     * \param packet the packet
+     * \param header the IPv4 header
+     */
+    void Unicast(Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header& header)
+    {
+    }
+
+    /**
+     * Error test function
+     * \param p The packet
+     * \param h The header
+     * \param e the socket error
+     */
+    void Error(Ptr<const Packet> p, const Ipv4Header& h, Socket::SocketErrno e)
+    {
+    }
+
+    /**
+     * Drop test function
+     * \param entry the dropped entry
+     * \param reason the drop reason
+     */
+    void Dropped(const QueueEntry& entry, RequestQueue::DropReason reason)
+    {
+        m_reasons.push_back(reason);
+    }
+
+    void DoRun() override
+    {
+        q.SetDropCallback(MakeCallback(&RaodvRqueueDropReasonTest::Dropped, this));
+        Ipv4Header h;
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            h.SetDestination(i % 2 ? Ipv4Address("2.2.2.2") : Ipv4Address("1.1.1.1"));
+            QueueEntry e(Create<Packet>(),
+                         h,
+                         MakeCallback(&RaodvRqueueDropReasonTest::Unicast, this),
+                         MakeCallback(&RaodvRqueueDropReasonTest::Error, this));
+            q.Enqueue(e);
+        }
+        NS_TEST_EXPECT_MSG_EQ(q.GetDropCount(RequestQueue::DROP_QUEUE_FULL), 1, "trivial");
+        q.DropPacketWithDst(Ipv4Address("1.1.1.1"));
+        NS_TEST_EXPECT_MSG_EQ(q.GetDropCount(RequestQueue::DROP_NO_ROUTE), 1, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 1, "trivial");
+
+        Simulator::Schedule(Seconds(2), &RaodvRqueueDropReasonTest::CheckTimeout, this);
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+
+    /// Check the queue timeout drop
+    void CheckTimeout()
+    {
+        NS_TEST_EXPECT_MSG_EQ(q.GetSize(), 0, "Packet timed out");
+        NS_TEST_EXPECT_MSG_EQ(q.GetDropCount(RequestQueue::DROP_TIMEOUT), 1, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_reasons.size(), 3, "Every drop reported");
+        NS_TEST_EXPECT_MSG_EQ(m_reasons[0], RequestQueue::DROP_QUEUE_FULL, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_reasons[1], RequestQueue::DROP_NO_ROUTE, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(m_reasons[2], RequestQueue::DROP_TIMEOUT, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(RequestQueue::GetDropReasonName(RequestQueue::DROP_TIMEOUT),
+                              "Timeout",
+                              "trivial");
+    }
+
+    /// Request queue
+    RequestQueue q;
+    /// Reported drop reasons
+    std::vector<RequestQueue::DropReason> m_reasons;
+};
+
 /**
  * \ingroup raodv-test
  *
@@ -719,6 +1177,387 @@ struct RaodvRtableTest : public TestCase
     }
 };
 
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for the in place lookups of the routing table and the precursor list
+ */
+struct RaodvRtableFindTest : public TestCase
+{
+    RaodvRtableFindTest()
+        : TestCase("Rtable find")
+    {
+    }
+
+    void DoRun() override
+    {
+        PrecursorList precursors;
+        for (uint32_t i = 1; i <= PrecursorList::INLINE_CAPACITY + 2; i++)
+        {
+            precursors.push_back(Ipv4Address(i));
+        }
+        NS_TEST_EXPECT_MSG_EQ(precursors.size(), PrecursorList::INLINE_CAPACITY + 2, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(*precursors.begin(), Ipv4Address(1), "Order kept on overflow");
+        NS_TEST_EXPECT_MSG_EQ(precursors.erase(Ipv4Address(2)), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(precursors.erase(Ipv4Address(3)), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(precursors.erase(Ipv4Address(3)), false, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(precursors.size(), PrecursorList::INLINE_CAPACITY, "Back inline");
+        PrecursorList copy = precursors;
+        NS_TEST_EXPECT_MSG_EQ(*(copy.end() - 1),
+                              Ipv4Address(PrecursorList::INLINE_CAPACITY + 2),
+                              "trivial");
+
+        RoutingTable rtable(Seconds(2));
+        NS_TEST_EXPECT_MSG_EQ((rtable.FindRoute(Ipv4Address("1.2.3.4")) == nullptr),
+                              true,
+                              "trivial");
+        RoutingTableEntry rt(/*output device*/ nullptr,
+                             /*dst*/ Ipv4Address("1.2.3.4"),
+                             /*validSeqNo*/ true,
+                             /*seqNo*/ 10,
+                             /*interface*/ Ipv4InterfaceAddress(),
+                             /*hop*/ 5,
+                             /*next hop*/ Ipv4Address("1.1.1.1"),
+                             /*lifetime*/ Seconds(10));
+        rt.SetRreqCnt(2);
+        rtable.AddRoute(rt);
+        const RoutingTableEntry* found = rtable.FindValidRoute(Ipv4Address("1.2.3.4"));
+        NS_TEST_EXPECT_MSG_EQ((found != nullptr), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(found->GetNextHop(), Ipv4Address("1.1.1.1"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(found->GetRoute()->GetGateway(), Ipv4Address("1.1.1.1"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.RefreshLifeTime(Ipv4Address("1.2.3.4"), Seconds(20)),
+                              true,
+                              "trivial");
+        NS_TEST_EXPECT_MSG_EQ(found->GetLifeTime(), Seconds(20), "Refreshed in place");
+        NS_TEST_EXPECT_MSG_EQ(rtable.RefreshLifeTime(Ipv4Address("1.2.3.4"), Seconds(5)),
+                              true,
+                              "trivial");
+        NS_TEST_EXPECT_MSG_EQ(found->GetLifeTime(), Seconds(20), "Lifetime never shortened");
+        NS_TEST_EXPECT_MSG_EQ(found->GetRreqCnt(), 0, "trivial");
+        rtable.SetEntryState(Ipv4Address("1.2.3.4"), IN_SEARCH);
+        NS_TEST_EXPECT_MSG_EQ((rtable.FindValidRoute(Ipv4Address("1.2.3.4")) == nullptr),
+                              true,
+                              "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.RefreshLifeTime(Ipv4Address("1.2.3.4"), Seconds(30)),
+                              false,
+                              "Only valid routes are refreshed");
+        NS_TEST_EXPECT_MSG_EQ((rtable.TouchValidRoute(Ipv4Address("1.2.3.4"), Seconds(30)) ==
+                               nullptr),
+                              true,
+                              "trivial");
+        rtable.SetEntryState(Ipv4Address("1.2.3.4"), VALID);
+        const RoutingTableEntry* touched =
+            rtable.TouchValidRoute(Ipv4Address("1.2.3.4"), Seconds(30));
+        NS_TEST_EXPECT_MSG_EQ((touched == found), true, "Same entry through the lookup cache");
+        NS_TEST_EXPECT_MSG_EQ(touched->GetLifeTime(), Seconds(30), "Touched in place");
+        RoutingTableEntry* entry = rtable.FindRoute(Ipv4Address("1.2.3.4"));
+        NS_TEST_EXPECT_MSG_EQ((entry == found), true, "Same entry through the lookup cache");
+        entry->SetRreqCnt(3);
+        rtable.RefreshLifeTime(*entry, Seconds(40));
+        NS_TEST_EXPECT_MSG_EQ(found->GetLifeTime(), Seconds(40), "Refreshed through the entry");
+        NS_TEST_EXPECT_MSG_EQ(found->GetRreqCnt(), 0, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.DeleteRoute(Ipv4Address("1.2.3.4")), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ((rtable.FindRoute(Ipv4Address("1.2.3.4")) == nullptr),
+                              true,
+                              "Deleted entry not left in the lookup cache");
+        rtable.AddRoute(rt);
+        found = rtable.FindRoute(Ipv4Address("1.2.3.4"));
+        NS_TEST_EXPECT_MSG_EQ((found != nullptr), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(found->GetRreqCnt(), 2, "Entry of the new route");
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for raodv routing table lifetime expiration
+ */
+struct RaodvRtableExpiryTest : public TestCase
+{
+    RaodvRtableExpiryTest()
+        : TestCase("Rtable expiry"),
+          rtable(Seconds(5)),
+          size(0)
+    {
+    }
+
+    /**
+     * Size callback
+     * \param n the number of entries
+     */
+    void SetSize(uint32_t n)
+    {
+        size = n;
+    }
+
+    void DoRun() override
+    {
+        rtable.SetSizeCallback(MakeCallback(&RaodvRtableExpiryTest::SetSize, this));
+        Ptr<NetDevice> dev;
+        Ipv4InterfaceAddress iface;
+        RoutingTableEntry rt(/*output device*/ dev,
+                             /*dst*/ Ipv4Address("1.2.3.4"),
+                             /*validSeqNo*/ true,
+                             /*seqNo*/ 10,
+                             /*interface*/ iface,
+                             /*hop*/ 5,
+                             /*next hop*/ Ipv4Address("1.1.1.1"),
+                             /*lifetime*/ Seconds(10));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt), true, "trivial");
+        RoutingTableEntry rt2(/*output device*/ dev,
+                              /*dst*/ Ipv4Address("4.3.2.1"),
+                              /*validSeqNo*/ false,
+                              /*seqNo*/ 0,
+                              /*interface*/ iface,
+                              /*hop*/ 15,
+                              /*next hop*/ Ipv4Address("1.1.1.1"),
+                              /*lifetime*/ Seconds(1));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt2), true, "trivial");
+        rt2.SetLifeTime(Seconds(3));
+        NS_TEST_EXPECT_MSG_EQ(rtable.Update(rt2), true, "trivial");
+        RoutingTableEntry rt3(/*output device*/ dev,
+                              /*dst*/ Ipv4Address("5.5.5.5"),
+                              /*validSeqNo*/ false,
+                              /*seqNo*/ 0,
+                              /*interface*/ iface,
+                              /*hop*/ 1,
+                              /*next hop*/ Ipv4Address("5.5.5.5"),
+                              /*lifetime*/ Seconds(1));
+        rt3.SetFlag(IN_SEARCH);
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt3), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(size, 3, "Added entries are notified");
+
+        Simulator::Schedule(Seconds(2), &RaodvRtableExpiryTest::CheckTimeout1, this);
+        Simulator::Schedule(Seconds(4), &RaodvRtableExpiryTest::CheckTimeout2, this);
+        Simulator::Schedule(Seconds(11), &RaodvRtableExpiryTest::CheckTimeout3, this);
+        Simulator::Schedule(Seconds(20), &RaodvRtableExpiryTest::CheckTimeout4, this);
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+
+    /// Updated lifetime is used, expired IN_SEARCH entry is kept
+    void CheckTimeout1()
+    {
+        RoutingTableEntry rt;
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupValidRoute(Ipv4Address("4.3.2.1"), rt),
+                              true,
+                              "Lifetime was extended");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("5.5.5.5"), rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), IN_SEARCH, "IN_SEARCH entry is not invalidated");
+        NS_TEST_EXPECT_MSG_EQ(rtable.SetEntryState(Ipv4Address("5.5.5.5"), VALID),
+                              true,
+                              "trivial");
+    }
+
+    /// Expired valid entries are invalidated for the bad link lifetime
+    void CheckTimeout2()
+    {
+        RoutingTableEntry rt;
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("4.3.2.1"), rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "Expired route is invalidated");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("5.5.5.5"), rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "Revalidated route expires");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupValidRoute(Ipv4Address("1.2.3.4"), rt),
+                              true,
+                              "trivial");
+    }
+
+    /// Invalid entries are deleted after the bad link lifetime
+    void CheckTimeout3()
+    {
+        RoutingTableEntry rt;
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("4.3.2.1"), rt),
+                              false,
+                              "Invalid route is deleted");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("5.5.5.5"), rt),
+                              false,
+                              "Invalid route is deleted");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("1.2.3.4"), rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "Expired route is invalidated");
+        NS_TEST_EXPECT_MSG_EQ(size, 1, "Purged entries are notified");
+    }
+
+    /// All entries are gone
+    void CheckTimeout4()
+    {
+        RoutingTableEntry rt;
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("1.2.3.4"), rt),
+                              false,
+                              "Invalid route is deleted");
+        NS_TEST_EXPECT_MSG_EQ(size, 0, "Purged entries are notified");
+    }
+
+    /// Routing table
+    RoutingTable rtable;
+    /// Last notified number of entries
+    uint32_t size;
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for raodv routing table next hop index
+ */
+struct RaodvRtableNextHopTest : public TestCase
+{
+    RaodvRtableNextHopTest()
+        : TestCase("Rtable next hop index")
+    {
+    }
+
+    void DoRun() override
+    {
+        RoutingTable rtable(Seconds(5));
+        Ptr<NetDevice> dev;
+        Ipv4InterfaceAddress iface;
+        for (uint32_t i = 1; i <= 3; ++i)
+        {
+            RoutingTableEntry rt(/*output device*/ dev,
+                                 /*dst*/ Ipv4Address(0x0a000000 + i),
+                                 /*validSeqNo*/ true,
+                                 /*seqNo*/ i,
+                                 /*interface*/ iface,
+                                 /*hop*/ 2,
+                                 /*next hop*/ Ipv4Address("1.1.1.1"),
+                                 /*lifetime*/ Seconds(10));
+            NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt), true, "trivial");
+        }
+        std::map<Ipv4Address, uint32_t> unreachable;
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("1.1.1.1"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 3, "All routes use 1.1.1.1");
+
+        // Changing a looked-up copy leaves the table and its index alone until it is updated
+        RoutingTableEntry rt;
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.2"), rt), true, "trivial");
+        rt.SetNextHop(Ipv4Address("2.2.2.2"));
+        RoutingTableEntry stored;
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.2"), stored), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(stored.GetNextHop(), Ipv4Address("1.1.1.1"), "Entry unchanged");
+        NS_TEST_EXPECT_MSG_EQ(stored.GetRoute()->GetGateway(),
+                              Ipv4Address("1.1.1.1"),
+                              "Route of the entry unchanged");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetRoute()->GetGateway(), Ipv4Address("2.2.2.2"), "trivial");
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("1.1.1.1"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 3, "Index unchanged");
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("2.2.2.2"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.empty(), true, "Index unchanged");
+        NS_TEST_EXPECT_MSG_EQ(rtable.Update(rt), true, "trivial");
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("1.1.1.1"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 2, "Route moved to 2.2.2.2");
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("2.2.2.2"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 1, "Route moved to 2.2.2.2");
+        NS_TEST_EXPECT_MSG_EQ(unreachable.begin()->first, Ipv4Address("10.0.0.2"), "trivial");
+        NS_TEST_EXPECT_MSG_EQ(unreachable.begin()->second, 2, "Sequence number");
+
+        NS_TEST_EXPECT_MSG_EQ(rtable.DeleteRoute(Ipv4Address("10.0.0.1")), true, "trivial");
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("1.1.1.1"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 1, "Deleted route is not listed");
+        unreachable.insert(std::make_pair(Ipv4Address("10.0.0.9"), 1));
+        rtable.InvalidateRoutesWithDst(unreachable);
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupRoute(Ipv4Address("10.0.0.3"), rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetFlag(), INVALID, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupValidRoute(Ipv4Address("10.0.0.2"), rt),
+                              true,
+                              "Other next hop not affected");
+        rtable.Clear();
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("2.2.2.2"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.empty(), true, "trivial");
+        Simulator::Destroy();
+    }
+};
+
+/**
+ * \ingroup raodv-test
+ *
+ * \brief Unit test for the multipath alternates of the routing table
+ */
+struct RaodvRtableMultipathTest : public TestCase
+{
+    RaodvRtableMultipathTest()
+        : TestCase("Rtable multipath failover")
+    {
+    }
+
+    void DoRun() override
+    {
+        RoutingTable rtable(Seconds(5));
+        Ptr<NetDevice> dev;
+        Ipv4InterfaceAddress iface;
+        Ipv4Address dst("10.0.0.1");
+        RoutingTableEntry rt(/*output device*/ dev,
+                             /*dst*/ dst,
+                             /*validSeqNo*/ true,
+                             /*seqNo*/ 1,
+                             /*interface*/ iface,
+                             /*hop*/ 3,
+                             /*next hop*/ Ipv4Address("1.1.1.1"),
+                             /*lifetime*/ Seconds(10));
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddRoute(rt), true, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(
+            rtable.AddAlternate(dst, Ipv4Address("2.2.2.2"), 4, iface, dev, Seconds(10)),
+            false,
+            "Multipath disabled by default");
+        rtable.SetMaxAlternates(2);
+        NS_TEST_EXPECT_MSG_EQ(
+            rtable.AddAlternate(dst, Ipv4Address("1.1.1.1"), 3, iface, dev, Seconds(10)),
+            false,
+            "Current next hop is not an alternate");
+        NS_TEST_EXPECT_MSG_EQ(rtable.AddAlternate(Ipv4Address("10.0.0.9"),
+                                                  Ipv4Address("2.2.2.2"),
+                                                  3,
+                                                  iface,
+                                                  dev,
+                                                  Seconds(10)),
+                              false,
+                              "No route to attach the alternate to");
+        NS_TEST_EXPECT_MSG_EQ(
+            rtable.AddAlternate(dst, Ipv4Address("2.2.2.2"), 5, iface, dev, Seconds(1)),
+            true,
+            "trivial");
+        NS_TEST_EXPECT_MSG_EQ(
+            rtable.AddAlternate(dst, Ipv4Address("3.3.3.3"), 4, iface, dev, Seconds(10)),
+            true,
+            "trivial");
+        NS_TEST_EXPECT_MSG_EQ(
+            rtable.AddAlternate(dst, Ipv4Address("4.4.4.4"), 6, iface, dev, Seconds(10)),
+            false,
+            "Worse than the best two");
+        NS_TEST_EXPECT_MSG_EQ(rtable.GetAlternateCount(dst), 2, "trivial");
+
+        std::map<Ipv4Address, uint32_t> unreachable;
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("1.1.1.1"), unreachable);
+        rtable.FailOverRoutesWithNextHop(Ipv4Address("1.1.1.1"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.empty(), true, "Route was rerouted");
+        NS_TEST_EXPECT_MSG_EQ(rtable.LookupValidRoute(dst, rt), true, "Route stays valid");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetNextHop(), Ipv4Address("3.3.3.3"), "Fewest hops first");
+        NS_TEST_EXPECT_MSG_EQ(rt.GetHop(), 4, "trivial");
+        rtable.GetListOfDestinationWithNextHop(Ipv4Address("3.3.3.3"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 1, "Next hop index follows the failover");
+        Simulator::Schedule(Seconds(2),
+                            &RaodvRtableMultipathTest::CheckAfterExpiry,
+                            this,
+                            &rtable);
+        Simulator::Run();
+        Simulator::Destroy();
+    }
+
+    /**
+     * Check that an expired alternate is not used
+     * \param rtable the routing table
+     */
+    void CheckAfterExpiry(RoutingTable* rtable)
+    {
+        Ipv4Address dst("10.0.0.1");
+        std::map<Ipv4Address, uint32_t> unreachable;
+        rtable->GetListOfDestinationWithNextHop(Ipv4Address("3.3.3.3"), unreachable);
+        rtable->FailOverRoutesWithNextHop(Ipv4Address("3.3.3.3"), unreachable);
+        NS_TEST_EXPECT_MSG_EQ(unreachable.size(), 1, "Remaining alternate has expired");
+        NS_TEST_EXPECT_MSG_EQ(unreachable.begin()->first, dst, "trivial");
+        NS_TEST_EXPECT_MSG_EQ(rtable->GetAlternateCount(dst), 0, "trivial");
+    }
+};
+
 /**
  * \ingroup raodv-test
  *
@@ -731,15 +1570,26 @@ class RaodvTestSuite : public TestSuite
         : TestSuite("routing-raodv", Type::UNIT)
     {
         AddTestCase(new NeighborTest, TestCase::Duration::QUICK);
+        AddTestCase(new NeighborExpiryTest, TestCase::Duration::QUICK);
+        AddTestCase(new NeighborChangeCountTest, TestCase::Duration::QUICK);
+        AddTestCase(new NeighborLinkCostTest, TestCase::Duration::QUICK);
         AddTestCase(new TypeHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RreqHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RrepHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RrepAckHeaderTest, TestCase::Duration::QUICK);
         AddTestCase(new RerrHeaderTest, TestCase::Duration::QUICK);
+        AddTestCase(new ControlMessageTest, TestCase::Duration::QUICK);
+        AddTestCase(new TxSchedulerTest, TestCase::Duration::QUICK);
         AddTestCase(new QueueEntryTest, TestCase::Duration::QUICK);
         AddTestCase(new RaodvRqueueTest, TestCase::Duration::QUICK);
+        AddTestCase(new RaodvRqueueDequeueAllTest, TestCase::Duration::QUICK);
+        AddTestCase(new RaodvRqueueDropReasonTest, TestCase::Duration::QUICK);
         AddTestCase(new RaodvRtableEntryTest, TestCase::Duration::QUICK);
         AddTestCase(new RaodvRtableTest, TestCase::Duration::QUICK);
+        AddTestCase(new RaodvRtableFindTest, TestCase::Duration::QUICK);
+        AddTestCase(new RaodvRtableExpiryTest, TestCase::Duration::QUICK);
+        AddTestCase(new RaodvRtableNextHopTest, TestCase::Duration::QUICK);
+        AddTestCase(new RaodvRtableMultipathTest, TestCase::Duration::QUICK);
     }
 } g_aodvTestSuite; ///< the test suite
 
@@ -53,6 +53,36 @@
  *   to a comma-separated value (csv) file
  * - some tracing and flow monitor configuration that used to work is
  *   left commented inline in the program
+ *
+ * The driver runs a whole sweep: every combination of the comma-separated
+ * lists given by --protocols, --nodeNumbers, --packetNumbers, --nodeSpeeds
+ * and --runs is simulated in its own worker process, at most --jobs at a
+ * time (one per core by default).  Each simulation uses
+ * RngSeedManager::SetRun with its run number, so any row can be reproduced
+ * alone.  Once all workers are done, the runs of each point are averaged
+ * into one CSV row with 95% confidence intervals.  For example
+ *   ./ns3 run "scratch/2005098_task1 --protocols=AODV,RAODV --nodeNumbers=20,40,60
+ *              --packetNumbers=100 --nodeSpeeds=5 --runs=1,2,3,4,5"
+ * The single-point options --protocol, --nodeNumber, --packetNumber and
+ * --nodeSpeed are still accepted.
+ *
+ * The metrics are counted while the simulation runs, from the Tx trace of
+ * the OnOff applications and the receptions of the sinks; a timestamp byte
+ * tag added at transmission gives the end-to-end delay.  With
+ * --timeSeries=true, each run also writes one
+ * time,throughput,tx,rx,PDR,delay row per second to its own
+ * <trace name>.series.csv file.  The FlowMonitor XML is only produced with
+ * --flowMonitor=true.
+ *
+ * No trace is written unless asked for with --traceLevel.  With "sampled",
+ * the positions of all nodes are written every --traceInterval seconds as
+ * binary records into <trace name>.pos.bin.  With "full", every course change
+ * goes to <trace name>.mob and the WiFi PHY ASCII trace to <trace name>.tr.
+ * --traceMobility=true is the same as --traceLevel=full.
+ *
+ * Every simulation of the sweep runs on one core.  For networks too large
+ * for that, the raodv-distributed example of the raodv module runs this
+ * scenario partitioned into regions over MPI ranks.
  */
 
 #include "ns3/aodv-module.h"
@@ -65,16 +95,247 @@
 #include "ns3/mobility-module.h"
 #include "ns3/network-module.h"
 #include "ns3/olsr-module.h"
+#include "ns3/raodv-module.h"
 #include "ns3/yans-wifi-helper.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace ns3;
 using namespace dsr;
 
 NS_LOG_COMPONENT_DEFINE("manet-routing-compare");
 
+/**
+ * One point of the parameter sweep, simulated with one run number.
+ */
+struct RunConfig
+{
+    std::string protocol;  //!< Routing protocol name.
+    uint32_t nodeNumber;   //!< Number of nodes.
+    uint32_t packetNumber; //!< Number of packets per second.
+    uint32_t nodeSpeed;    //!< Speed of nodes.
+    uint32_t run;          //!< Run number given to RngSeedManager::SetRun.
+};
+
+/**
+ * Metrics of one simulation, as sent back by its worker process.
+ */
+struct RunResult
+{
+    double throughput;    //!< Throughput (kbps).
+    double delay;         //!< Mean end-to-end delay (s).
+    double deliveryRatio; //!< Packet delivery ratio (%).
+    double dropRatio;     //!< Packet drop ratio (%).
+};
+
+/**
+ * Transmission timestamp carried by the data packets, to measure their end-to-end delay.
+ */
+class TimestampTag : public Tag
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("RoutingExperimentTimestampTag")
+                                .SetParent<Tag>()
+                                .SetGroupName("Applications")
+                                .AddConstructor<TimestampTag>();
+        return tid;
+    }
+
+    TypeId GetInstanceTypeId() const override
+    {
+        return GetTypeId();
+    }
+
+    uint32_t GetSerializedSize() const override
+    {
+        return sizeof(int64_t);
+    }
+
+    void Serialize(TagBuffer i) const override
+    {
+        i.WriteU64(m_timestamp.GetTimeStep());
+    }
+
+    void Deserialize(TagBuffer i) override
+    {
+        m_timestamp = TimeStep(i.ReadU64());
+    }
+
+    void Print(std::ostream& os) const override
+    {
+        os << "t=" << m_timestamp;
+    }
+
+    /**
+     * Set the transmission time.
+     * \param t The time.
+     */
+    void SetTimestamp(Time t)
+    {
+        m_timestamp = t;
+    }
+
+    /**
+     * \return the transmission time.
+     */
+    Time GetTimestamp() const
+    {
+        return m_timestamp;
+    }
+
+  private:
+    Time m_timestamp; //!< Transmission time.
+};
+
+/**
+ * Amount of trace output of a run.
+ */
+enum TraceLevel
+{
+    TRACE_OFF,     //!< No trace output.
+    TRACE_SAMPLED, //!< Node positions at a fixed interval, in a binary file.
+    TRACE_FULL,    //!< Every course change and the WiFi PHY ASCII trace.
+};
+
+/**
+ * Writes snapshots of the node positions as fixed-size binary records into a buffered file.
+ * The file starts with a PositionTraceWriter::FileHeader; every snapshot is one record per node.
+ */
+class PositionTraceWriter
+{
+  public:
+    /// File header.
+    struct FileHeader
+    {
+        char magic[4];       //!< "MBTR".
+        uint32_t version;    //!< Format version, 1.
+        uint32_t numNodes;   //!< Number of nodes, hence records per snapshot.
+        uint32_t recordSize; //!< Size of a Record.
+        double interval;     //!< Time between snapshots (s).
+    };
+
+    /// Position of one node in one snapshot.
+    struct Record
+    {
+        double time;     //!< Simulation time (s).
+        uint32_t nodeId; //!< Node ID.
+        float x;         //!< X coordinate (m).
+        float y;         //!< Y coordinate (m).
+        float z;         //!< Z coordinate (m).
+    };
+
+    /**
+     * Create the trace file.
+     * \param fileName The file name.
+     * \param numNodes The number of nodes.
+     * \param interval The time between snapshots.
+     * \param bufferRecords Number of records buffered before they are written.
+     */
+    PositionTraceWriter(const std::string& fileName,
+                        uint32_t numNodes,
+                        Time interval,
+                        std::size_t bufferRecords)
+        : m_file(fileName, std::ios::out | std::ios::binary),
+          m_bufferRecords(bufferRecords)
+    {
+        NS_ABORT_MSG_UNLESS(m_file.is_open(), "Could not open " << fileName);
+        FileHeader header{{'M', 'B', 'T', 'R'}, 1, numNodes, sizeof(Record), interval.GetSeconds()};
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_buffer.reserve(m_bufferRecords);
+    }
+
+    /// Write the buffered records and close the file.
+    ~PositionTraceWriter()
+    {
+        Flush();
+    }
+
+    /**
+     * Record the current positions of nodes.
+     * \param nodes The nodes.
+     */
+    void Write(const NodeContainer& nodes)
+    {
+        double time = Simulator::Now().GetSeconds();
+        for (auto i = nodes.Begin(); i != nodes.End(); ++i)
+        {
+            Vector position = (*i)->GetObject<MobilityModel>()->GetPosition();
+            m_buffer.push_back({time,
+                                (*i)->GetId(),
+                                static_cast<float>(position.x),
+                                static_cast<float>(position.y),
+                                static_cast<float>(position.z)});
+            if (m_buffer.size() >= m_bufferRecords)
+            {
+                Flush();
+            }
+        }
+    }
+
+    /// Write the buffered records.
+    void Flush()
+    {
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()),
+                     m_buffer.size() * sizeof(Record));
+        m_buffer.clear();
+    }
+
+  private:
+    std::ofstream m_file;         //!< Trace file.
+    std::size_t m_bufferRecords;  //!< Buffer capacity in records.
+    std::vector<Record> m_buffer; //!< Records not written yet.
+};
+
+static_assert(sizeof(PositionTraceWriter::Record) == 24, "Record must have no padding");
+
+/**
+ * Data traffic counters, updated on every transmission and reception.
+ */
+struct TrafficCounters
+{
+    uint64_t txPackets{0}; //!< Transmitted packets.
+    uint64_t rxPackets{0}; //!< Received packets.
+    uint64_t rxBytes{0};   //!< Received bytes.
+    double delaySum{0.0};  //!< Sum of the end-to-end delays of the received packets (s).
+
+    /**
+     * Compute the metrics of the counted traffic.
+     * \param duration The time over which the traffic was counted.
+     * \return the metrics.
+     */
+    RunResult GetResult(Time duration) const
+    {
+        RunResult result{0.0, 0.0, 0.0, 0.0};
+        result.throughput = (rxBytes * 8.0) / (duration.GetSeconds() * 1024);
+        if (rxPackets > 0)
+        {
+            result.delay = delaySum / rxPackets;
+        }
+        if (txPackets > 0)
+        {
+            // Packets still in flight at the end of an interval count as dropped in it
+            double delivered = std::min(rxPackets, txPackets);
+            result.deliveryRatio = delivered / txPackets * 100;
+            result.dropRatio = (txPackets - delivered) / txPackets * 100;
+        }
+        return result;
+    }
+};
+
 /**
  * Routing experiment class.
  *
@@ -85,7 +346,7 @@ class RoutingExperiment
   public:
     RoutingExperiment();
     /**
-     * Run the experiment.
+     * Run every simulation of the sweep in worker processes and write the merged CSV.
      */
     void Run();
 
@@ -97,6 +358,21 @@ class RoutingExperiment
     void CommandSetup(int argc, char** argv);
 
   private:
+    /**
+     * Run a single simulation.
+     * \param config The sweep point and run number.
+     * \return the metrics of the simulation.
+     */
+    RunResult RunOne(const RunConfig& config);
+    /**
+     * Write the mean and confidence interval of the runs of each sweep point.
+     * \param configs The simulations, in sweep order.
+     * \param results The metrics of the simulations.
+     * \param done Whether each simulation completed.
+     */
+    void WriteResults(const std::vector<RunConfig>& configs,
+                      const std::vector<RunResult>& results,
+                      const std::vector<bool>& done) const;
     /**
      * Setup the receiving socket in a Sink Node.
      * \param addr The address of the node.
@@ -110,13 +386,21 @@ class RoutingExperiment
      */
     void ReceivePacket(Ptr<Socket> socket);
     /**
-     * Compute the throughput.
+     * Count a packet sent by an OnOff application and stamp it with the current time.
+     * \param packet The packet.
+     */
+    void TransmitPacket(Ptr<const Packet> packet);
+    /**
+     * Write the metrics of the last second to the time series and reset its counters.
      */
     void CheckThroughput();
+    /**
+     * Write a snapshot of the node positions and schedule the next one.
+     * \param nodes The nodes.
+     */
+    void SamplePositions(NodeContainer nodes);
 
-    uint32_t port{9};            //!< Receiving port number.
-    uint32_t bytesTotal{0};      //!< Total received bytes.
-    uint32_t packetsReceived{0}; //!< Total received packets.
+    uint32_t port{9}; //!< Receiving port number.
     uint32_t nodeNumber{0};
     uint32_t pacNumber{0};
     uint32_t nSpeed{0};
@@ -125,14 +409,101 @@ class RoutingExperiment
     int m_nSinks{10};                                      //!< Number of sink nodes.
     std::string m_protocolName{"AODV"};                    //!< Protocol name.
     double m_txp{15};                                     //!< Tx power.
-    bool m_traceMobility{false};                           //!< Enable mobility tracing.
-    bool m_flowMonitor{false};                             //!< Enable FlowMonitor.
+    bool m_traceMobility{false};                           //!< Same as m_traceLevel "full".
+    std::string m_traceLevel{"off"};                       //!< Trace level name.
+    TraceLevel m_trace{TRACE_OFF};                         //!< Trace level.
+    Time m_traceInterval{Seconds(1.0)};                    //!< Time between position samples.
+    std::unique_ptr<PositionTraceWriter> m_positionTrace;  //!< Position samples, if enabled.
+    bool m_flowMonitor{false};                             //!< Enable FlowMonitor XML output.
+    bool m_timeSeries{false};                              //!< Enable per-second time series.
+
+    TrafficCounters m_total;    //!< Traffic of the whole run.
+    TrafficCounters m_interval; //!< Traffic of the current second.
+    std::ofstream m_seriesOut;  //!< Per-second time series output.
+
+    std::string m_protocols;     //!< Comma-separated protocols of the sweep.
+    std::string m_nodeNumbers;   //!< Comma-separated numbers of nodes of the sweep.
+    std::string m_packetNumbers; //!< Comma-separated packet rates of the sweep.
+    std::string m_nodeSpeeds;    //!< Comma-separated node speeds of the sweep.
+    std::string m_runs{"1"};     //!< Comma-separated run numbers of each point.
+    uint32_t m_jobs{0};          //!< Maximum number of worker processes, 0 for one per core.
 };
 
 RoutingExperiment::RoutingExperiment()
 {
 }
 
+/**
+ * Split a comma-separated list.
+ * \param list The list.
+ * \return the non-empty items.
+ */
+static std::vector<std::string>
+SplitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * Split a comma-separated list of numbers.
+ * \param list The list.
+ * \param fallback The value to use if the list is empty.
+ * \return the numbers.
+ */
+static std::vector<uint32_t>
+SplitNumbers(const std::string& list, uint32_t fallback)
+{
+    std::vector<uint32_t> numbers;
+    for (const auto& item : SplitList(list))
+    {
+        numbers.push_back(std::stoul(item));
+    }
+    if (numbers.empty())
+    {
+        numbers.push_back(fallback);
+    }
+    return numbers;
+}
+
+/**
+ * Half width of the 95% confidence interval of a mean.
+ * \param values The samples.
+ * \param mean Their mean.
+ * \return the half width, 0 with less than two samples.
+ */
+static double
+ConfidenceHalfWidth(const std::vector<double>& values, double mean)
+{
+    // Student t quantiles for a two-sided 95% interval, by degrees of freedom
+    static const double t95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                 2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                 2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                 2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    std::size_t n = values.size();
+    if (n < 2)
+    {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double v : values)
+    {
+        sum += (v - mean) * (v - mean);
+    }
+    double stddev = std::sqrt(sum / (n - 1));
+    double t = (n - 1 <= 30) ? t95[n - 2] : 1.960;
+    return t * stddev / std::sqrt(static_cast<double>(n));
+}
+
 static inline std::string
 PrintReceivedPacket(Ptr<Socket> socket, Ptr<Packet> packet, Address senderAddress)
 {
@@ -151,7 +522,6 @@ PrintReceivedPacket(Ptr<Socket> socket, Ptr<Packet> packet, Address senderAddres
     }
     return oss.str();
 }
-
 void
 RoutingExperiment::ReceivePacket(Ptr<Socket> socket)
 {
@@ -159,28 +529,51 @@ RoutingExperiment::ReceivePacket(Ptr<Socket> socket)
     Address senderAddress;
     while ((packet = socket->RecvFrom(senderAddress)))
     {
-        bytesTotal += packet->GetSize();
-        packetsReceived += 1;
+        double delay = 0.0;
+        TimestampTag tag;
+        if (packet->FindFirstMatchingByteTag(tag))
+        {
+            delay = (Simulator::Now() - tag.GetTimestamp()).GetSeconds();
+        }
+        for (TrafficCounters* counters : {&m_total, &m_interval})
+        {
+            counters->rxPackets++;
+            counters->rxBytes += packet->GetSize();
+            counters->delaySum += delay;
+        }
        // NS_LOG_UNCOND(PrintReceivedPacket(socket, packet, senderAddress));
     }
 }
 
 void
-RoutingExperiment::CheckThroughput()
+RoutingExperiment::TransmitPacket(Ptr<const Packet> packet)
 {
-   // double kbs = (bytesTotal * 8.0) / 1000;
-    bytesTotal = 0;
-
-    std::ofstream out(m_CSVfileName, std::ios::app);
-
-   // out << (Simulator::Now()).GetSeconds() << "," << kbs << "," << packetsReceived << ","
-    //    << m_nSinks << "," << m_protocolName << "," << m_txp << "" << std::endl;
+    TimestampTag tag;
+    tag.SetTimestamp(Simulator::Now());
+    packet->AddByteTag(tag);
+    m_total.txPackets++;
+    m_interval.txPackets++;
+}
 
-    out.close();
-    packetsReceived = 0;
+void
+RoutingExperiment::CheckThroughput()
+{
+    if (m_seriesOut.is_open() && Simulator::Now() > Seconds(0))
+    {
+        RunResult result = m_interval.GetResult(Seconds(1.0));
+        m_seriesOut << Simulator::Now().GetSeconds() << "," << result.throughput << ","
+                    << m_interval.txPackets << "," << m_interval.rxPackets << ","
+                    << result.deliveryRatio << "," << result.delay << std::endl;
+    }
+    m_interval = TrafficCounters();
     Simulator::Schedule(Seconds(1.0), &RoutingExperiment::CheckThroughput, this);
- 
+}
 
+void
+RoutingExperiment::SamplePositions(NodeContainer nodes)
+{
+    m_positionTrace->Write(nodes);
+    Simulator::Schedule(m_traceInterval, &RoutingExperiment::SamplePositions, this, nodes);
 }
 
 Ptr<Socket>
@@ -200,22 +593,76 @@ RoutingExperiment::CommandSetup(int argc, char** argv)
 {
     CommandLine cmd(__FILE__);
     cmd.AddValue("CSVfileName", "The name of the CSV output file name", m_CSVfileName);
-    cmd.AddValue("traceMobility", "Enable mobility tracing", m_traceMobility);
-    cmd.AddValue("protocol", "Routing protocol (OLSR, AODV, DSDV, DSR)", m_protocolName);
-    cmd.AddValue("flowMonitor", "enable FlowMonitor", m_flowMonitor);
+    cmd.AddValue("traceMobility", "Same as --traceLevel=full", m_traceMobility);
+    cmd.AddValue("traceLevel",
+                 "Trace output: off, sampled (binary node positions) or full (every course "
+                 "change and the WiFi PHY ASCII trace)",
+                 m_traceLevel);
+    cmd.AddValue("traceInterval",
+                 "Time between position samples of --traceLevel=sampled",
+                 m_traceInterval);
+    cmd.AddValue("protocol", "Routing protocol (OLSR, AODV, RAODV, DSDV, DSR)", m_protocolName);
+    cmd.AddValue("flowMonitor", "enable FlowMonitor XML output", m_flowMonitor);
+    cmd.AddValue("timeSeries", "Write the per-second metrics of each run", m_timeSeries);
     cmd.AddValue("nodeNumber", "Number of Nodes ",nodeNumber);
     cmd.AddValue("packetNumber", "Number of Packetss ",pacNumber);
     cmd.AddValue("nodeSpeed", "Speed of Nodes ",nSpeed);
+    cmd.AddValue("protocols", "Comma-separated routing protocols of the sweep", m_protocols);
+    cmd.AddValue("nodeNumbers", "Comma-separated numbers of nodes of the sweep", m_nodeNumbers);
+    cmd.AddValue("packetNumbers",
+                 "Comma-separated numbers of packets per second of the sweep",
+                 m_packetNumbers);
+    cmd.AddValue("nodeSpeeds", "Comma-separated speeds of nodes of the sweep", m_nodeSpeeds);
+    cmd.AddValue("runs", "Comma-separated run numbers simulated for each point", m_runs);
+    cmd.AddValue("jobs", "Maximum number of parallel simulations, 0 for one per core", m_jobs);
 
 
     cmd.Parse(argc, argv);
 
-    std::vector<std::string> allowedProtocols{"OLSR", "AODV", "DSDV", "DSR"};
+    if (m_traceLevel == "off")
+    {
+        m_trace = m_traceMobility ? TRACE_FULL : TRACE_OFF;
+    }
+    else if (m_traceLevel == "sampled")
+    {
+        m_trace = TRACE_SAMPLED;
+    }
+    else if (m_traceLevel == "full")
+    {
+        m_trace = TRACE_FULL;
+    }
+    else
+    {
+        NS_FATAL_ERROR("No such trace level:" << m_traceLevel);
+    }
+    if (m_trace == TRACE_SAMPLED && !m_traceInterval.IsStrictlyPositive())
+    {
+        NS_FATAL_ERROR("The position sampling interval must be positive");
+    }
 
-    if (std::find(std::begin(allowedProtocols), std::end(allowedProtocols), m_protocolName) ==
-        std::end(allowedProtocols))
+    if (m_protocols.empty())
     {
-        NS_FATAL_ERROR("No such protocol:" << m_protocolName);
+        m_protocols = m_protocolName;
+    }
+
+    std::vector<std::string> allowedProtocols{"OLSR", "AODV", "RAODV", "DSDV", "DSR"};
+
+    for (const auto& protocol : SplitList(m_protocols))
+    {
+        if (std::find(std::begin(allowedProtocols), std::end(allowedProtocols), protocol) ==
+            std::end(allowedProtocols))
+        {
+            NS_FATAL_ERROR("No such protocol:" << protocol);
+        }
+        if (protocol == "DSR" && m_flowMonitor)
+        {
+            NS_FATAL_ERROR("Error: FlowMonitor does not work with DSR. Terminating.");
+        }
+    }
+    if (m_jobs == 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        m_jobs = cores > 0 ? cores : 1;
     }
 }
 
@@ -232,31 +679,171 @@ main(int argc, char* argv[])
 void
 RoutingExperiment::Run()
 {
-    Packet::EnablePrinting();
+    std::vector<RunConfig> configs;
+    for (const auto& protocol : SplitList(m_protocols))
+    {
+        for (uint32_t nodes : SplitNumbers(m_nodeNumbers, nodeNumber))
+        {
+            for (uint32_t packets : SplitNumbers(m_packetNumbers, pacNumber))
+            {
+                for (uint32_t speed : SplitNumbers(m_nodeSpeeds, nSpeed))
+                {
+                    for (uint32_t run : SplitNumbers(m_runs, 1))
+                    {
+                        configs.push_back({protocol, nodes, packets, speed, run});
+                    }
+                }
+            }
+        }
+    }
+
+    // Each simulation runs in a forked worker which sends its RunResult back through a pipe
+    std::vector<RunResult> results(configs.size());
+    std::vector<bool> done(configs.size(), false);
+    std::map<pid_t, std::pair<std::size_t, int>> workers;
+    std::size_t next = 0;
+    while (next < configs.size() || !workers.empty())
+    {
+        while (next < configs.size() && workers.size() < m_jobs)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                NS_FATAL_ERROR("Could not create pipe for worker");
+            }
+            std::cout.flush();
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                NS_FATAL_ERROR("Could not fork worker");
+            }
+            if (pid == 0)
+            {
+                close(fds[0]);
+                RunResult result = RunOne(configs[next]);
+                ssize_t written = write(fds[1], &result, sizeof(result));
+                close(fds[1]);
+                std::cout.flush();
+                _exit(written == sizeof(result) ? 0 : 1);
+            }
+            close(fds[1]);
+            workers[pid] = std::make_pair(next, fds[0]);
+            next++;
+        }
 
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        auto worker = workers.find(pid);
+        if (worker == workers.end())
+        {
+            continue;
+        }
+        std::size_t index = worker->second.first;
+        int fd = worker->second.second;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+            read(fd, &results[index], sizeof(RunResult)) == sizeof(RunResult))
+        {
+            done[index] = true;
+        }
+        else
+        {
+            const RunConfig& config = configs[index];
+            NS_LOG_ERROR("Simulation " << config.protocol << " nodes=" << config.nodeNumber
+                                       << " packets=" << config.packetNumber
+                                       << " speed=" << config.nodeSpeed
+                                       << " run=" << config.run << " failed");
+        }
+        close(fd);
+        workers.erase(worker);
+    }
+
+    WriteResults(configs, results, done);
+}
+
+void
+RoutingExperiment::WriteResults(const std::vector<RunConfig>& configs,
+                                const std::vector<RunResult>& results,
+                                const std::vector<bool>& done) const
+{
     // blank out the last output file and write the column headers
     std::ofstream out(m_CSVfileName);
-    out << "Number of nodes,"
+    out << "Protocol,"
+        << "Number of nodes,"
         << "Number of packets per second,"
         << "Speed of nodes,"
+        << "Runs,"
         << "Throughput,"
+        << "Throughput CI95,"
         << "End-to-end Delay,"
+        << "End-to-end Delay CI95,"
         << "Packet Delivery Ratio,"
-        << "Packet Drop Ratio"
-         << std::endl;
+        << "Packet Delivery Ratio CI95,"
+        << "Packet Drop Ratio,"
+        << "Packet Drop Ratio CI95"
+        << std::endl;
+
+    // The runs of a point are adjacent in sweep order
+    for (std::size_t first = 0; first < configs.size();)
+    {
+        std::size_t last = first;
+        while (last < configs.size() && configs[last].protocol == configs[first].protocol &&
+               configs[last].nodeNumber == configs[first].nodeNumber &&
+               configs[last].packetNumber == configs[first].packetNumber &&
+               configs[last].nodeSpeed == configs[first].nodeSpeed)
+        {
+            last++;
+        }
+        std::vector<double> metrics[4];
+        for (std::size_t i = first; i < last; i++)
+        {
+            if (done[i])
+            {
+                metrics[0].push_back(results[i].throughput);
+                metrics[1].push_back(results[i].delay);
+                metrics[2].push_back(results[i].deliveryRatio);
+                metrics[3].push_back(results[i].dropRatio);
+            }
+        }
+        const RunConfig& config = configs[first];
+        out << config.protocol << "," << config.nodeNumber << "," << config.packetNumber << ","
+            << config.nodeSpeed << "," << metrics[0].size();
+        for (const auto& values : metrics)
+        {
+            double mean = 0.0;
+            for (double v : values)
+            {
+                mean += v;
+            }
+            if (!values.empty())
+            {
+                mean /= values.size();
+            }
+            out << "," << mean << "," << ConfidenceHalfWidth(values, mean);
+        }
+        out << std::endl;
+        first = last;
+    }
     out.close();
-    
-    int nWifis = nodeNumber;
+}
+
+RunResult
+RoutingExperiment::RunOne(const RunConfig& config)
+{
+    Packet::EnablePrinting();
+    RngSeedManager::SetRun(config.run);
+    m_protocolName = config.protocol;
+
+    int nWifis = config.nodeNumber;
    // double TotalTime = 110.0;
      double TotalTime = 10.0;
-    int packetNumber = pacNumber;
+    int packetNumber = config.packetNumber;
     int pacSize = packetNumber*8*64;
     std::string str = std::to_string(pacSize);
     std::string rate(str);
     std::string phyMode("DsssRate11Mbps");
     std::string tr_name("manet-routing-compare");
 
-    int nodeSpeed = nSpeed;
+    int nodeSpeed = config.nodeSpeed;
     int nodePause = 0;  // in s
     
     Config::SetDefault("ns3::OnOffApplication::PacketSize", StringValue("64"));
@@ -319,7 +906,7 @@ RoutingExperiment::Run()
     streamIndex += mobilityAdhoc.AssignStreams(adhocNodes, streamIndex);
 
     AodvHelper aodv;
-   // RaodvHelper raodv;
+    RaodvHelper raodv;
     OlsrHelper olsr;
     DsdvHelper dsdv;
     DsrHelper dsr;
@@ -339,6 +926,12 @@ RoutingExperiment::Run()
         internet.SetRoutingHelper(list);
         internet.Install(adhocNodes);
     }
+    else if (m_protocolName == "RAODV")
+    {
+        list.Add(raodv, 100);
+        internet.SetRoutingHelper(list);
+        internet.Install(adhocNodes);
+    }
     else if (m_protocolName == "DSDV")
     {
         list.Add(dsdv, 100);
@@ -349,10 +942,6 @@ RoutingExperiment::Run()
     {
         internet.Install(adhocNodes);
         dsrMain.Install(dsr, adhocNodes);
-        if (m_flowMonitor)
-        {
-            NS_FATAL_ERROR("Error: FlowMonitor does not work with DSR. Terminating.");
-        }
     }
     else
     {
@@ -384,6 +973,9 @@ RoutingExperiment::Run()
        // temp.Start(Seconds(var->GetValue(100.0, 101.0)));
         temp.Start(Seconds(var->GetValue(1.0, 2.0))); 
         temp.Stop(Seconds(TotalTime));
+        temp.Get(0)->TraceConnectWithoutContext(
+            "Tx",
+            MakeCallback(&RoutingExperiment::TransmitPacket, this));
     }
 
     std::stringstream ss;
@@ -409,9 +1001,27 @@ RoutingExperiment::Run()
     // AsciiTraceHelper ascii;
     // Ptr<OutputStreamWrapper> osw = ascii.CreateFileStream(tr_name + ".tr");
     // wifiPhy.EnableAsciiAll(osw);
-    AsciiTraceHelper ascii;
-    MobilityHelper::EnableAsciiAll(ascii.CreateFileStream(tr_name + ".mob"));
 
+    // Workers run concurrently, so each one writes its own trace files
+    tr_name = tr_name + "_" + m_protocolName + "_" + nodes + "nodes_" + sNodeSpeed + "speed_" +
+              sRate + "rate_run" + std::to_string(config.run);
+    if (m_trace == TRACE_FULL)
+    {
+        AsciiTraceHelper ascii;
+        MobilityHelper::EnableAsciiAll(ascii.CreateFileStream(tr_name + ".mob"));
+        wifiPhy.EnableAsciiAll(ascii.CreateFileStream(tr_name + ".tr"));
+    }
+    else if (m_trace == TRACE_SAMPLED)
+    {
+        // Buffer about a megabyte of records between writes
+        m_positionTrace = std::make_unique<PositionTraceWriter>(tr_name + ".pos.bin",
+                                                                nWifis,
+                                                                m_traceInterval,
+                                                                1 << 16);
+        Simulator::ScheduleNow(&RoutingExperiment::SamplePositions, this, adhocNodes);
+    }
+
+    // The FlowMonitor is only needed for its XML output; DSR does not support it
     FlowMonitorHelper flowmonHelper;
     Ptr<FlowMonitor> flowmon;
     if (m_flowMonitor)
@@ -419,6 +1029,15 @@ RoutingExperiment::Run()
         flowmon = flowmonHelper.InstallAll();
     }
 
+    m_total = TrafficCounters();
+    m_interval = TrafficCounters();
+    if (m_timeSeries)
+    {
+        m_seriesOut.open(tr_name + ".series.csv");
+        m_seriesOut << "Time,Throughput,Sent packets,Received packets,"
+                    << "Packet Delivery Ratio,End-to-end Delay" << std::endl;
+    }
+
     NS_LOG_INFO("Run Simulation.");
 
     CheckThroughput();
@@ -426,49 +1045,18 @@ RoutingExperiment::Run()
     Simulator::Stop(Seconds(TotalTime));
     Simulator::Run();
 
-     flowmon->CheckForLostPackets();
-     Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier>(flowmonHelper.GetClassifier());
-     std::map<FlowId, FlowMonitor::FlowStats> stats = flowmon->GetFlowStats();
-    
-
-    double throughput = 0.0;
-    double avgDelay = 0.0;
-    uint32_t receivedPackets = 0;
-    uint32_t sentPackets = 0;
-    uint32_t droppedPackets = 0;
-
-    if (m_flowMonitor)
+    if (flowmon)
     {
-         double throughput1 = 0.0;
-         flowmon->SerializeToXmlFile(tr_name + ".flowmon", false, false);
-         for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator i = stats.begin();  i != stats.end(); ++i)
-       {
-          throughput1 += i->second.rxBytes;
-          avgDelay += i->second.delaySum.GetSeconds();
-          receivedPackets += i->second.rxPackets;
-          sentPackets += i->second.txPackets;
-          //droppedPackets += i->second.lostPackets;
-          droppedPackets += (i->second.txPackets - i->second.rxPackets);
-       }
-       throughput = (throughput1*8.0)/(10.0*1024);
-       avgDelay /= receivedPackets;
-       double packetDeliveryRatio = (double)receivedPackets / sentPackets * 100;
-       double packetDropRatio = (double)droppedPackets / sentPackets * 100;
-       
-      std::ofstream out(m_CSVfileName.c_str(), std::ios::app); // Append mode for CSV
-      if (out.is_open()) {
-        out << nWifis << ","
-            << packetNumber << ","
-            << nodeSpeed << ","
-            << throughput << ","
-            << avgDelay << ","
-            << packetDeliveryRatio << ","
-            << packetDropRatio << std::endl;
-        out.close();
-      } else {
-         NS_LOG_ERROR("Could not open CSV file: " << m_CSVfileName);
-      }
-    }
-
-     Simulator::Destroy();
+        flowmon->CheckForLostPackets();
+        flowmon->SerializeToXmlFile(tr_name + ".flowmon", false, false);
+    }
+    if (m_seriesOut.is_open())
+    {
+        m_seriesOut.close();
+    }
+    m_positionTrace.reset();
+    RunResult result = m_total.GetResult(Seconds(TotalTime));
+
+    Simulator::Destroy();
+    return result;
 }
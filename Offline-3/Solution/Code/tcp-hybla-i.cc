@@ -1,8 +1,10 @@
 #include "tcp-hybla-i.h"
 #include "tcp-socket-state.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 #include <cmath>     // for pow
 #include <algorithm> // for std::max
+#include <limits>    // for std::numeric_limits
 
 /*
 In the original TCP Hybla, the parameter rho is recalculated based solely on
@@ -71,8 +73,43 @@ TcpHyblaI::GetTypeId()
                                           "Factor to reduce increments if RTO/sRtt is large",
                                           DoubleValue(1.0),
                                           MakeDoubleAccessor(&TcpHyblaI::m_rtoScalingFactor),
-                                          MakeDoubleChecker<double>(0.0));
-    // Note: We do not re-register "RRTT" because it is already registered in TcpHybla.
+                                          MakeDoubleChecker<double>(0.0))
+                            .AddAttribute("Pacing",
+                                          "Enable pacing and set the pacing rate from cwnd/sRtt",
+                                          BooleanValue(false),
+                                          MakeBooleanAccessor(&TcpHyblaI::m_pacing),
+                                          MakeBooleanChecker())
+                            .AddAttribute("PacingSsGain",
+                                          "Pacing rate gain over cwnd/sRtt below half of ssThresh",
+                                          DoubleValue(2.0),
+                                          MakeDoubleAccessor(&TcpHyblaI::m_pacingSsGain),
+                                          MakeDoubleChecker<double>(0.0))
+                            .AddAttribute("PacingCaGain",
+                                          "Pacing rate gain over cwnd/sRtt above half of ssThresh",
+                                          DoubleValue(1.2),
+                                          MakeDoubleAccessor(&TcpHyblaI::m_pacingCaGain),
+                                          MakeDoubleChecker<double>(0.0))
+                            .AddAttribute("MaxPacingRate",
+                                          "Upper bound of the pacing rate",
+                                          DataRateValue(DataRate("4Gb/s")),
+                                          MakeDataRateAccessor(&TcpHyblaI::m_maxPacingRate),
+                                          MakeDataRateChecker())
+                            .AddTraceSource("HyblaIRho",
+                                            "Ratio of the smoothed RTT to the reference RTT, "
+                                            "named apart from the Rho of TcpHybla",
+                                            MakeTraceSourceAccessor(&TcpHyblaI::m_rho),
+                                            "ns3::TracedValueCallback::Double")
+                            .AddTraceSource("SmoothedRtt",
+                                            "Smoothed RTT rho is computed from",
+                                            MakeTraceSourceAccessor(&TcpHyblaI::m_sRtt),
+                                            "ns3::TracedValueCallback::Time")
+                            .AddTraceSource("ScalingFactor",
+                                            "Factors scaling a window increment",
+                                            MakeTraceSourceAccessor(
+                                                &TcpHyblaI::m_scalingFactorTrace),
+                                            "ns3::TcpHyblaI::ScalingFactorTracedCallback");
+    // Note: We do not re-register "RRTT" because it is already registered in TcpHybla, and our
+    // rho is traced as "HyblaIRho" since TcpHybla registers "Rho" too.
     return tid;
 }
 
@@ -82,8 +119,15 @@ TcpHyblaI::TcpHyblaI()
       m_alpha(0.9),
       m_inFlightThresh(0.8),
       m_rtoScalingFactor(1.0),
+      m_pacing(false),
+      m_pacingSsGain(2.0),
+      m_pacingCaGain(1.2),
+      m_maxPacingRate(DataRate("4Gb/s")),
       m_rRtt(MilliSeconds(50)),  // We can still set this default if needed
       m_rho(1.0),
+      m_rhoSquared(1.0),
+      m_slowStartIncrement(1.0),
+      m_sRttSeconds(0.0),
       m_cWndCnt(0.0)
 {
     NS_LOG_FUNCTION(this);
@@ -95,8 +139,15 @@ TcpHyblaI::TcpHyblaI(const TcpHyblaI& sock)
       m_alpha(sock.m_alpha),
       m_inFlightThresh(sock.m_inFlightThresh),
       m_rtoScalingFactor(sock.m_rtoScalingFactor),
+      m_pacing(sock.m_pacing),
+      m_pacingSsGain(sock.m_pacingSsGain),
+      m_pacingCaGain(sock.m_pacingCaGain),
+      m_maxPacingRate(sock.m_maxPacingRate),
       m_rRtt(sock.m_rRtt),
       m_rho(sock.m_rho),
+      m_rhoSquared(sock.m_rhoSquared),
+      m_slowStartIncrement(sock.m_slowStartIncrement),
+      m_sRttSeconds(sock.m_sRttSeconds),
       m_cWndCnt(sock.m_cWndCnt)
 {
     NS_LOG_FUNCTION(this);
@@ -113,25 +164,80 @@ TcpHyblaI::GetName() const
     return "TcpHyblaI";
 }
 
+void
+TcpHyblaI::Init(Ptr<TcpSocketState> tcb)
+{
+    NS_LOG_FUNCTION(this << tcb);
+
+    if (m_pacing)
+    {
+        tcb->m_pacing = true;
+        tcb->m_maxPacingRate = m_maxPacingRate;
+        tcb->m_pacingRate = m_maxPacingRate;
+        // The socket recomputes its own rate on ACKs, from the last RTT, and caps it at
+        // m_maxPacingRate. With the largest ratios, the cap set in UpdatePacingRate always wins.
+        tcb->m_pacingSsRatio = std::numeric_limits<uint16_t>::max();
+        tcb->m_pacingCaRatio = std::numeric_limits<uint16_t>::max();
+    }
+}
+
+void
+TcpHyblaI::IncreaseWindow(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
+{
+    NS_LOG_FUNCTION(this << tcb << segmentsAcked);
+
+    TcpHybla::IncreaseWindow(tcb, segmentsAcked);
+    if (m_pacing)
+    {
+        UpdatePacingRate(tcb);
+    }
+}
+
 void
 TcpHyblaI::PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt)
 {
     NS_LOG_FUNCTION(this << tcb << segmentsAcked << rtt);
 
-    if (m_sRtt == Seconds(0))
+    if (m_sRtt.Get().IsZero())
     {
         m_sRtt = rtt;
     }
     else
     {
-        m_sRtt = (m_sRtt * m_alpha) + (rtt * (1.0 - m_alpha));
+        m_sRtt = (m_sRtt.Get() * m_alpha) + (rtt * (1.0 - m_alpha));
     }
+    m_sRttSeconds = m_sRtt.Get().GetSeconds();
 
     if (rtt == tcb->m_minRtt)
     {
         HyblaIRecalcParam(tcb);
         NS_LOG_DEBUG("min RTT seen: " << rtt);
     }
+    if (m_pacing)
+    {
+        UpdatePacingRate(tcb);
+    }
+}
+
+void
+TcpHyblaI::UpdatePacingRate(const Ptr<TcpSocketState>& tcb)
+{
+    NS_LOG_FUNCTION(this << tcb);
+
+    if (m_sRtt.Get().IsZero())
+    {
+        return;
+    }
+    // As in Linux, pace a little faster than cwnd / RTT, so that the window is not the limit,
+    // and faster still early in slow start, where cwnd doubles every RTT or more
+    double gain = (tcb->m_cWnd < tcb->m_ssThresh / 2) ? m_pacingSsGain : m_pacingCaGain;
+    double window = std::max(tcb->m_cWnd.Get(), tcb->m_bytesInFlight.Get());
+    DataRate rate(static_cast<uint64_t>(gain * window * 8 / m_sRttSeconds));
+    rate = std::min(rate, m_maxPacingRate);
+
+    tcb->m_maxPacingRate = rate;
+    tcb->m_pacingRate = rate;
+    NS_LOG_DEBUG("Pacing rate " << rate << " for cwnd " << tcb->m_cWnd << " sRtt " << m_sRtt);
 }
 
 void
@@ -139,12 +245,16 @@ TcpHyblaI::HyblaIRecalcParam(const Ptr<TcpSocketState>& tcb)
 {
     NS_LOG_FUNCTION(this);
 
-    Time effectiveRtt = (m_sRtt.IsZero()) ? tcb->m_minRtt : m_sRtt;
+    Time effectiveRtt = (m_sRtt.Get().IsZero()) ? tcb->m_minRtt : m_sRtt.Get();
     double candidateRho =
         (double)effectiveRtt.GetMilliSeconds() / (double)m_rRtt.GetMilliSeconds();
-    m_rho = std::max(candidateRho, 1.0);
+    double rho = std::max(candidateRho, 1.0);
+    m_rho = rho;
+    // rho only changes here, so the per-ACK powers of it are computed once
+    m_rhoSquared = rho * rho;
+    m_slowStartIncrement = std::pow(2, rho) - 1.0;
 
-    NS_ASSERT(m_rho > 0.0);
+    NS_ASSERT(rho > 0.0);
     NS_LOG_DEBUG("Recalculated rho using sRtt: rho=" << m_rho);
 }
 
@@ -161,7 +271,7 @@ TcpHyblaI::ComputeScalingFactor(const Ptr<TcpSocketState>& tcb)
 
     double computedRto = srttSeconds * 2.0;
 
-    double rtoRatio = (m_sRtt.IsZero()) ? 1.0 : (computedRto / m_sRtt.GetSeconds());
+    double rtoRatio = (m_sRtt.Get().IsZero()) ? 1.0 : (computedRto / m_sRttSeconds);
     rtoRatio = std::max(rtoRatio, 1.0);
 
     uint32_t outstanding = tcb->m_nextTxSequence - tcb->m_lastAckedSeq;
@@ -182,6 +292,7 @@ TcpHyblaI::ComputeScalingFactor(const Ptr<TcpSocketState>& tcb)
 
     double finalFactor = inflightFactor * rtoFactor * outstandingFactor;
     finalFactor = std::max(finalFactor, 0.5);
+    m_scalingFactorTrace(inflightFactor, rtoFactor, outstandingFactor, finalFactor);
     return finalFactor;
 }
 
@@ -194,7 +305,7 @@ TcpHyblaI::SlowStart(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
 
     if (segmentsAcked >= 1)
     {
-        double increment = std::pow(2, m_rho) - 1.0;
+        double increment = m_slowStartIncrement;
 
         double scale = ComputeScalingFactor(tcb);
         increment *= scale;
@@ -220,13 +331,13 @@ TcpHyblaI::CongestionAvoidance(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked)
 {
     NS_LOG_FUNCTION(this << tcb << segmentsAcked);
 
-    while (segmentsAcked > 0)
+    // The window does not change while the acked segments are counted, so the per-segment
+    // increments rho^2 / cwnd add up in closed form. This only rounds differently from summing
+    // them one at a time, by a few ulps of m_cWndCnt.
+    if (segmentsAcked > 0)
     {
         uint32_t segCwnd = tcb->GetCwndInSegments();
-        double increment = (std::pow(m_rho, 2) / static_cast<double>(segCwnd));
-
-        m_cWndCnt += increment;
-        segmentsAcked -= 1;
+        m_cWndCnt += segmentsAcked * m_rhoSquared / static_cast<double>(segCwnd);
     }
 
     if (m_cWndCnt >= 1.0)
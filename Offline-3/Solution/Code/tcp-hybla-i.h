@@ -15,6 +15,8 @@
 #define TCPHYBLAI_H
 
 #include "tcp-hybla.h"
+#include "ns3/data-rate.h"
+#include "ns3/traced-callback.h"
 #include "ns3/traced-value.h"
 #include "ns3/nstime.h"
 
@@ -32,6 +34,14 @@ class TcpSocketState;
  * - Uses a smoothed RTT (sRtt) to compute a stable rho parameter, reducing abrupt changes.
  * - Adjusts congestion window increments based on network conditions: in-flight ratio, a simple RTO estimate,
  *   and outstanding data.
+ *
+ * With the Pacing attribute set, it also enables pacing on the socket and sets the pacing rate
+ * to cwnd / sRtt on every ACK, times PacingSsGain below half of ssThresh and PacingCaGain above,
+ * capped at MaxPacingRate. The large window steps of a long RTT path are then spread over the
+ * RTT instead of being sent as a burst into the bottleneck queue.
+ *
+ * The HyblaIRho, SmoothedRtt and ScalingFactor trace sources report the internal state behind each
+ * window increment. They only cost a comparison or an empty callback list while unconnected.
  */
 class TcpHyblaI : public TcpHybla
 {
@@ -42,11 +52,26 @@ public:
      */
     static TypeId GetTypeId();
 
+    /**
+     * TracedCallback signature for the scaling of a window increment.
+     *
+     * \param [in] inflightFactor Factor from the in-flight to cwnd ratio.
+     * \param [in] rtoFactor Factor from the RTO to sRtt ratio.
+     * \param [in] outstandingFactor Factor from the outstanding data.
+     * \param [in] scale Scaling factor applied, their product bounded below by 0.5.
+     */
+    typedef void (*ScalingFactorTracedCallback)(double inflightFactor,
+                                                double rtoFactor,
+                                                double outstandingFactor,
+                                                double scale);
+
     TcpHyblaI();
     TcpHyblaI(const TcpHyblaI& sock);
     ~TcpHyblaI() override;
 
     // Inherited
+    void Init(Ptr<TcpSocketState> tcb) override;
+    void IncreaseWindow(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked) override;
     void PktsAcked(Ptr<TcpSocketState> tcb, uint32_t segmentsAcked, const Time& rtt) override;
     Ptr<TcpCongestionOps> Fork() override;
     std::string GetName() const override;
@@ -57,16 +82,26 @@ protected:
 
 private:
     // New parameters
-    Time m_sRtt;             //!< Smoothed RTT
+    TracedValue<Time> m_sRtt; //!< Smoothed RTT
     double m_alpha;          //!< Smoothing factor for sRtt
     double m_inFlightThresh; //!< Threshold for in_flight to cwnd ratio
     double m_rtoScalingFactor; //!< Factor to scale increments if RTO is large vs sRtt
+    bool m_pacing;             //!< Set the pacing rate of the socket from cwnd / sRtt
+    double m_pacingSsGain;     //!< Pacing rate gain below half of ssThresh
+    double m_pacingCaGain;     //!< Pacing rate gain above half of ssThresh
+    DataRate m_maxPacingRate;  //!< Upper bound of the pacing rate
 
     // Re-implemented parameters from Hybla since we can't access parent's private members
     Time m_rRtt;     //!< Reference RTT for HyblaI
-    double m_rho;     //!< Rho parameter
+    TracedValue<double> m_rho;   //!< Rho parameter
+    double m_rhoSquared;         //!< rho^2, the congestion avoidance increment per cwnd
+    double m_slowStartIncrement; //!< 2^rho - 1, the slow start increment in segments
+    double m_sRttSeconds;        //!< m_sRtt in seconds
     double m_cWndCnt; //!< cWnd integer-to-float counter
 
+    /// Factors of each window increment scaling, see ComputeScalingFactor
+    TracedCallback<double, double, double, double> m_scalingFactorTrace;
+
 private:
     /**
      * \brief Recalculate algorithm parameters with smoothed RTT.
@@ -80,6 +115,12 @@ private:
      * \return scaling factor (<= 1.0) to modulate cwnd increment.
      */
     double ComputeScalingFactor(const Ptr<TcpSocketState>& tcb);
+
+    /**
+     * \brief Set the pacing rate of the socket from cwnd and the smoothed RTT.
+     * \param tcb the socket state.
+     */
+    void UpdatePacingRate(const Ptr<TcpSocketState>& tcb);
 };
 
 } // namespace ns3
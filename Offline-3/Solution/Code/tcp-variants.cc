@@ -59,333 +59,981 @@
 #include "ns3/network-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/tcp-header.h"
+#include "ns3/tcp-hybla-i.h"
+#include "ns3/tcp-rx-buffer.h"
+#include "ns3/tcp-socket-base.h"
 #include "ns3/traffic-control-module.h"
 #include "ns3/udp-header.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
 
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("TcpVariantsComparison");
 
-static std::map<uint32_t, bool> firstCwnd;                      //!< First congestion window.
-static std::map<uint32_t, bool> firstSshThr;                    //!< First SlowStart threshold.
-static std::map<uint32_t, bool> firstRtt;                       //!< First RTT. Round Trip Time
-static std::map<uint32_t, bool> firstRto;                       //!< First RTO. Retransmission Time Out
-static std::map<uint32_t, Ptr<OutputStreamWrapper>> cWndStream; //!< Congstion window output stream.
-static std::map<uint32_t, Ptr<OutputStreamWrapper>>
-    ssThreshStream; //!< SlowStart threshold output stream.
-static std::map<uint32_t, Ptr<OutputStreamWrapper>> rttStream;      //!< RTT output stream.
-static std::map<uint32_t, Ptr<OutputStreamWrapper>> rtoStream;      //!< RTO output stream.
-static std::map<uint32_t, Ptr<OutputStreamWrapper>> nextTxStream;   //!< Next TX output stream.
-static std::map<uint32_t, Ptr<OutputStreamWrapper>> nextRxStream;   //!< Next RX output stream.
-static std::map<uint32_t, Ptr<OutputStreamWrapper>> inFlightStream; //!< In flight output stream.
-static std::map<uint32_t, uint32_t> cWndValue;                      //!< congestion window value.
-static std::map<uint32_t, uint32_t> ssThreshValue;                  //!< SlowStart threshold value.
-
-/**
- * Get the Node Id From Context.
+/**
+ * Metrics recorded in the binary trace. The order matches TRACE_METRIC_SUFFIX.
+ */
+enum TraceMetric : uint32_t
+{
+    TRACE_CWND = 0,                //!< Congestion window.
+    TRACE_SSTHRESH = 1,            //!< SlowStart threshold.
+    TRACE_RTT = 2,                 //!< RTT (s).
+    TRACE_RTO = 3,                 //!< RTO (s).
+    TRACE_NEXT_TX = 4,             //!< Next TX sequence number.
+    TRACE_IN_FLIGHT = 5,           //!< Bytes in flight.
+    TRACE_NEXT_RX = 6,             //!< Next RX sequence number.
+    TRACE_RHO = 7,                 //!< TcpHyblaI rho.
+    TRACE_SRTT = 8,                //!< TcpHyblaI smoothed RTT (s).
+    TRACE_INFLIGHT_FACTOR = 9,     //!< TcpHyblaI in-flight scaling factor.
+    TRACE_RTO_FACTOR = 10,         //!< TcpHyblaI RTO scaling factor.
+    TRACE_OUTSTANDING_FACTOR = 11, //!< TcpHyblaI outstanding data scaling factor.
+    TRACE_SCALE = 12,              //!< TcpHyblaI scaling factor applied to an increment.
+    TRACE_METRICS = 13,            //!< Number of metrics.
+};
+
+/// Suffix of the text trace file of each metric.
+static const char* const TRACE_METRIC_SUFFIX[TRACE_METRICS] = {"-cwnd.data",
+                                                              "-ssth.data",
+                                                              "-rtt.data",
+                                                              "-rto.data",
+                                                              "-next-tx.data",
+                                                              "-inflight.data",
+                                                              "-next-rx.data",
+                                                              "-rho.data",
+                                                              "-srtt.data",
+                                                              "-inflight-factor.data",
+                                                              "-rto-factor.data",
+                                                              "-outstanding-factor.data",
+                                                              "-scale.data"};
+
+/**
+ * Writes the trace samples of all flows and metrics as fixed-size binary records into a single
+ * buffered file. The file starts with a BinaryTraceWriter::FileHeader.
+ */
+class BinaryTraceWriter
+{
+  public:
+    /// File header.
+    struct FileHeader
+    {
+        char magic[4];       //!< "TVTR".
+        uint32_t version;    //!< Format version, 1.
+        uint32_t numFlows;   //!< Number of flows of the run.
+        uint32_t recordSize; //!< Size of a Record.
+    };
+
+    /// One trace sample.
+    struct Record
+    {
+        double time;     //!< Simulation time (s), 0 for the initial value of a metric.
+        uint32_t nodeId; //!< Node ID.
+        uint32_t metric; //!< TraceMetric.
+        double value;    //!< Sample value.
+    };
+
+    /**
+     * Create the trace file.
+     * \param fileName The file name.
+     * \param numFlows The number of flows.
+     * \param bufferRecords Number of records buffered before they are written.
+     */
+    BinaryTraceWriter(const std::string& fileName, uint32_t numFlows, std::size_t bufferRecords)
+        : m_file(fileName, std::ios::out | std::ios::binary),
+          m_bufferRecords(bufferRecords)
+    {
+        NS_ABORT_MSG_UNLESS(m_file.is_open(), "Could not open " << fileName);
+        FileHeader header{{'T', 'V', 'T', 'R'}, 1, numFlows, sizeof(Record)};
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_buffer.reserve(m_bufferRecords);
+    }
+
+    /// Write the buffered records and close the file.
+    ~BinaryTraceWriter()
+    {
+        Flush();
+    }
+
+    /**
+     * Record a sample.
+     * \param time The sample time (s).
+     * \param nodeId The node ID.
+     * \param metric The metric.
+     * \param value The value.
+     */
+    void Write(double time, uint32_t nodeId, TraceMetric metric, double value)
+    {
+        m_buffer.push_back({time, nodeId, metric, value});
+        if (m_buffer.size() >= m_bufferRecords)
+        {
+            Flush();
+        }
+    }
+
+    /// Write the buffered records.
+    void Flush()
+    {
+        m_file.write(reinterpret_cast<const char*>(m_buffer.data()),
+                     m_buffer.size() * sizeof(Record));
+        m_buffer.clear();
+    }
+
+  private:
+    std::ofstream m_file;         //!< Trace file.
+    std::size_t m_bufferRecords;  //!< Buffer capacity in records.
+    std::vector<Record> m_buffer; //!< Records not written yet.
+};
+
+static_assert(sizeof(BinaryTraceWriter::Record) == 24, "Record must have no padding");
+
+static std::unique_ptr<BinaryTraceWriter> binaryTrace; //!< Binary trace, if enabled.
+
+/**
+ * Convert a sample to the value stored in a binary record.
+ * \param value The sample.
+ * \return the record value.
+ */
+static double
+ToRecordValue(uint32_t value)
+{
+    return value;
+}
+
+/**
+ * \copydoc ToRecordValue(uint32_t)
+ */
+static double
+ToRecordValue(double value)
+{
+    return value;
+}
+
+/**
+ * \copydoc ToRecordValue(uint32_t)
+ */
+static double
+ToRecordValue(SequenceNumber32 value)
+{
+    return value.GetValue();
+}
+
+/**
+ * Write a trace sample, to the binary trace if enabled, else as a text line of the metric file.
  *
- * \param context The context.
- * \return the node ID.
- * example:
- * "/root/12345/otherdata"
-   Step 1: Find the first slash (n1):
-   n1 = 5 (position of the slash after "root").
-   Step 2: Find the second slash (n2):
-   n2 = 11 (position of the slash after "12345").
-   Step 3: Extract the substring between n1 and n2:
-   Substring: "12345".
-   Step 4: Convert "12345" to an integer:
-   Result: 12345.
- */
-static uint32_t
-GetNodeIdFromContext(std::string context)
-{
-    const std::size_t n1 = context.find_first_of('/', 1);
-    const std::size_t n2 = context.find_first_of('/', n1 + 1);
-    return std::stoul(context.substr(n1 + 1, n2 - n1 - 1));
+ * \param stream The text stream of the metric of the node.
+ * \param nodeId The node ID.
+ * \param metric The metric.
+ * \param initial Whether this is the initial value, written at time 0.0.
+ * \param value The value.
+ */
+template <typename T>
+static void
+WriteSample(Ptr<OutputStreamWrapper> stream,
+            uint32_t nodeId,
+            TraceMetric metric,
+            bool initial,
+            T value)
+{
+    double time = initial ? 0.0 : Simulator::Now().GetSeconds();
+    if (binaryTrace)
+    {
+        binaryTrace->Write(time, nodeId, metric, ToRecordValue(value));
+        return;
+    }
+    if (initial)
+    {
+        *stream->GetStream() << "0.0 " << value << "\n";
+    }
+    else
+    {
+        *stream->GetStream() << time << " " << value << "\n";
+    }
 }
 
+/**
+ * Convert a binary trace into the text files written by the ascii trace format.
+ *
+ * \param bin_file_name Binary trace file name.
+ * \param prefix_file_name Prefix of the text trace files.
+ */
+static void
+ConvertBinaryTrace(const std::string& bin_file_name, const std::string& prefix_file_name)
+{
+    std::ifstream in(bin_file_name, std::ios::in | std::ios::binary);
+    NS_ABORT_MSG_UNLESS(in.is_open(), "Could not open " << bin_file_name);
+    BinaryTraceWriter::FileHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    NS_ABORT_MSG_UNLESS(in && std::string(header.magic, 4) == "TVTR" && header.version == 1 &&
+                            header.recordSize == sizeof(BinaryTraceWriter::Record),
+                        bin_file_name << " is not a binary trace");
+
+    std::map<std::pair<uint32_t, uint32_t>, std::unique_ptr<std::ofstream>> files;
+    BinaryTraceWriter::Record record;
+    while (in.read(reinterpret_cast<char*>(&record), sizeof(record)))
+    {
+        NS_ABORT_MSG_UNLESS(record.metric < TRACE_METRICS, "Unknown metric " << record.metric);
+        // Sources are nodes 1..num_flows, the next RX sequence is traced on the sinks after them
+        uint32_t flow = record.nodeId - 1;
+        if (record.metric == TRACE_NEXT_RX)
+        {
+            flow -= header.numFlows;
+        }
+        auto& file = files[std::make_pair(flow, record.metric)];
+        if (!file)
+        {
+            std::string flowString;
+            if (header.numFlows > 1)
+            {
+                flowString = "-flow" + std::to_string(flow);
+            }
+            file = std::make_unique<std::ofstream>(prefix_file_name + flowString +
+                                                   TRACE_METRIC_SUFFIX[record.metric]);
+        }
+        if (record.time == 0.0)
+        {
+            *file << "0.0 ";
+        }
+        else
+        {
+            *file << record.time << " ";
+        }
+        if (record.metric == TRACE_RTT || record.metric == TRACE_RTO ||
+            record.metric >= TRACE_RHO)
+        {
+            *file << record.value << "\n";
+        }
+        else
+        {
+            *file << static_cast<uint32_t>(record.value) << "\n";
+        }
+    }
+}
+
+/**
+ * Trace sinks of one flow. It holds the output streams and last values of the flow, and its
+ * tracers are bound to it, so a traced sample costs no context parsing or map lookup.
+ */
+struct FlowTracer
+{
+    /**
+     * Create the trace files of the flow, unless the binary trace is enabled.
+     *
+     * \param file_prefix Prefix of the trace file names of the flow.
+     * \param source Node ID of the sender.
+     * \param sink Node ID of the receiver.
+     * \param hybla_i Whether to also trace the TcpHyblaI state of the sender.
+     */
+    FlowTracer(const std::string& file_prefix, uint32_t source, uint32_t sink, bool hybla_i)
+        : sourceId(source),
+          sinkId(sink),
+          hyblaI(hybla_i)
+    {
+        if (!binaryTrace)
+        {
+            AsciiTraceHelper ascii;
+            cWndStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_CWND]);
+            ssThreshStream =
+                ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_SSTHRESH]);
+            rttStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_RTT]);
+            rtoStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_RTO]);
+            nextTxStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_NEXT_TX]);
+            inFlightStream =
+                ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_IN_FLIGHT]);
+            nextRxStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_NEXT_RX]);
+        }
+        if (!binaryTrace && hyblaI)
+        {
+            AsciiTraceHelper ascii;
+            rhoStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_RHO]);
+            sRttStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_SRTT]);
+            inFlightFactorStream =
+                ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_INFLIGHT_FACTOR]);
+            rtoFactorStream =
+                ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_RTO_FACTOR]);
+            outstandingFactorStream =
+                ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_OUTSTANDING_FACTOR]);
+            scaleStream = ascii.CreateFileStream(file_prefix + TRACE_METRIC_SUFFIX[TRACE_SCALE]);
+        }
+    }
+
+    uint32_t sourceId;                                //!< Node ID of the sender.
+    uint32_t sinkId;                                  //!< Node ID of the receiver.
+    bool hyblaI;                                      //!< Whether the TcpHyblaI state is traced.
+    bool firstCwnd{true};                             //!< First congestion window.
+    bool firstSshThr{true};                           //!< First SlowStart threshold.
+    bool firstRtt{true};                              //!< First RTT. Round Trip Time
+    bool firstRto{true};                              //!< First RTO. Retransmission Time Out
+    uint32_t cWndValue{0};                            //!< congestion window value.
+    uint32_t ssThreshValue{0};                        //!< SlowStart threshold value.
+    Ptr<OutputStreamWrapper> cWndStream;              //!< Congstion window output stream.
+    Ptr<OutputStreamWrapper> ssThreshStream;          //!< SlowStart threshold output stream.
+    Ptr<OutputStreamWrapper> rttStream;               //!< RTT output stream.
+    Ptr<OutputStreamWrapper> rtoStream;               //!< RTO output stream.
+    Ptr<OutputStreamWrapper> nextTxStream;            //!< Next TX output stream.
+    Ptr<OutputStreamWrapper> nextRxStream;            //!< Next RX output stream.
+    Ptr<OutputStreamWrapper> inFlightStream;          //!< In flight output stream.
+    Ptr<OutputStreamWrapper> rhoStream;               //!< TcpHyblaI rho output stream.
+    Ptr<OutputStreamWrapper> sRttStream;              //!< TcpHyblaI smoothed RTT output stream.
+    Ptr<OutputStreamWrapper> inFlightFactorStream;    //!< In-flight factor output stream.
+    Ptr<OutputStreamWrapper> rtoFactorStream;         //!< RTO factor output stream.
+    Ptr<OutputStreamWrapper> outstandingFactorStream; //!< Outstanding factor output stream.
+    Ptr<OutputStreamWrapper> scaleStream;             //!< Scaling factor output stream.
+};
+
+static std::vector<std::unique_ptr<FlowTracer>> flowTracers; //!< Tracers of all flows.
+
 /**
  * Congestion window tracer.
  *
- * \param context The context.
+ * \param flow The flow.
  * \param oldval Old value.
  * \param newval New value.
  * Congestion Window (cwnd):
 A TCP parameter that controls the number of packets a sender can send before requiring an acknowledgment.
-context: A string that provides a unique path or identifier for the trace source.
  */
 static void
-CwndTracer(std::string context, uint32_t oldval, uint32_t newval)
+CwndTracer(FlowTracer* flow, uint32_t oldval, uint32_t newval)
 {
-    uint32_t nodeId = GetNodeIdFromContext(context);
-
-    if (firstCwnd[nodeId])
+    if (flow->firstCwnd)
     {
-        *cWndStream[nodeId]->GetStream() << "0.0 " << oldval << std::endl;
-        firstCwnd[nodeId] = false;
+        WriteSample(flow->cWndStream, flow->sourceId, TRACE_CWND, true, oldval);
+        flow->firstCwnd = false;
     }
-    *cWndStream[nodeId]->GetStream() << Simulator::Now().GetSeconds() << " " << newval << std::endl;
-    cWndValue[nodeId] = newval;
-     // If this is not the first time logging the slow-start threshold (ssThresh) for this node:
-     // Logs the current simulation time and the current value of ssThresh (ssThreshValue[nodeId]).
+    WriteSample(flow->cWndStream, flow->sourceId, TRACE_CWND, false, newval);
+    flow->cWndValue = newval;
+     // If this is not the first time logging the slow-start threshold (ssThresh) for this flow:
+     // Logs the current simulation time and the current value of ssThresh (ssThreshValue).
 
-    if (!firstSshThr[nodeId])
+    if (!flow->firstSshThr)
     {
-        *ssThreshStream[nodeId]->GetStream()
-            << Simulator::Now().GetSeconds() << " " << ssThreshValue[nodeId] << std::endl;
+        WriteSample(flow->ssThreshStream,
+                    flow->sourceId,
+                    TRACE_SSTHRESH,
+                    false,
+                    flow->ssThreshValue);
     }
 }
 
 /**
  * Slow start threshold tracer.
  *
- * \param context The context.
+ * \param flow The flow.
  * \param oldval Old value.
  * \param newval New value.
  */
 static void
-SsThreshTracer(std::string context, uint32_t oldval, uint32_t newval)
+SsThreshTracer(FlowTracer* flow, uint32_t oldval, uint32_t newval)
 {
-    uint32_t nodeId = GetNodeIdFromContext(context);
-
-    if (firstSshThr[nodeId])
+    if (flow->firstSshThr)
     {
-        *ssThreshStream[nodeId]->GetStream() << "0.0 " << oldval << std::endl;
-        firstSshThr[nodeId] = false;
+        WriteSample(flow->ssThreshStream, flow->sourceId, TRACE_SSTHRESH, true, oldval);
+        flow->firstSshThr = false;
     }
-    *ssThreshStream[nodeId]->GetStream()
-        << Simulator::Now().GetSeconds() << " " << newval << std::endl;
-    ssThreshValue[nodeId] = newval;
+    WriteSample(flow->ssThreshStream, flow->sourceId, TRACE_SSTHRESH, false, newval);
+    flow->ssThreshValue = newval;
 
-    if (!firstCwnd[nodeId])
+    if (!flow->firstCwnd)
     {
-        *cWndStream[nodeId]->GetStream()
-            << Simulator::Now().GetSeconds() << " " << cWndValue[nodeId] << std::endl;
+        WriteSample(flow->cWndStream, flow->sourceId, TRACE_CWND, false, flow->cWndValue);
     }
 }
 
 /**
  * RTT tracer.
  *
- * \param context The context.
+ * \param flow The flow.
  * \param oldval Old value.
  * \param newval New value.
  */
 static void
-RttTracer(std::string context, Time oldval, Time newval)
+RttTracer(FlowTracer* flow, Time oldval, Time newval)
 {
-    uint32_t nodeId = GetNodeIdFromContext(context);
-
-    if (firstRtt[nodeId])
+    if (flow->firstRtt)
     {
-        *rttStream[nodeId]->GetStream() << "0.0 " << oldval.GetSeconds() << std::endl;
-        firstRtt[nodeId] = false;
+        WriteSample(flow->rttStream, flow->sourceId, TRACE_RTT, true, oldval.GetSeconds());
+        flow->firstRtt = false;
     }
-    *rttStream[nodeId]->GetStream()
-        << Simulator::Now().GetSeconds() << " " << newval.GetSeconds() << std::endl;
+    WriteSample(flow->rttStream, flow->sourceId, TRACE_RTT, false, newval.GetSeconds());
 }
 
 /**
  * RTO tracer.
  *
- * \param context The context.
+ * \param flow The flow.
  * \param oldval Old value.
  * \param newval New value.
  */
 static void
-RtoTracer(std::string context, Time oldval, Time newval)
+RtoTracer(FlowTracer* flow, Time oldval, Time newval)
 {
-    uint32_t nodeId = GetNodeIdFromContext(context);
-
-    if (firstRto[nodeId])
+    if (flow->firstRto)
     {
-        *rtoStream[nodeId]->GetStream() << "0.0 " << oldval.GetSeconds() << std::endl;
-        firstRto[nodeId] = false;
+        WriteSample(flow->rtoStream, flow->sourceId, TRACE_RTO, true, oldval.GetSeconds());
+        flow->firstRto = false;
     }
-    *rtoStream[nodeId]->GetStream()
-        << Simulator::Now().GetSeconds() << " " << newval.GetSeconds() << std::endl;
+    WriteSample(flow->rtoStream, flow->sourceId, TRACE_RTO, false, newval.GetSeconds());
 }
 
 /**
  * Next TX tracer.
  *
- * \param context The context.
+ * \param flow The flow.
  * \param old Old sequence number.
  * \param nextTx Next sequence number.
  */
 static void
-NextTxTracer(std::string context, SequenceNumber32 old [[maybe_unused]], SequenceNumber32 nextTx)
+NextTxTracer(FlowTracer* flow, SequenceNumber32 old [[maybe_unused]], SequenceNumber32 nextTx)
 {
-    uint32_t nodeId = GetNodeIdFromContext(context);
-
-    *nextTxStream[nodeId]->GetStream()
-        << Simulator::Now().GetSeconds() << " " << nextTx << std::endl;
+    WriteSample(flow->nextTxStream, flow->sourceId, TRACE_NEXT_TX, false, nextTx);
 }
 
 /**
  * In-flight tracer.
  *
- * \param context The context.
+ * \param flow The flow.
  * \param old Old value.
  * \param inFlight In flight value.
  * Purpose: Logs the amount of data (in bytes) currently in flight 
- * (i.e., unacknowledged by the receiver) for a specific node during the simulation.
+ * (i.e., unacknowledged by the receiver) for a specific flow during the simulation.
  * old [[maybe_unused]]: The previous value of in-flight bytes. The [[maybe_unused]] attribute tells
  *  the compiler that this parameter might not be used in the function.
  */
 static void
-InFlightTracer(std::string context, uint32_t old [[maybe_unused]], uint32_t inFlight)
+InFlightTracer(FlowTracer* flow, uint32_t old [[maybe_unused]], uint32_t inFlight)
 {
-    uint32_t nodeId = GetNodeIdFromContext(context);
-
-    *inFlightStream[nodeId]->GetStream()
-        << Simulator::Now().GetSeconds() << " " << inFlight << std::endl;
+    WriteSample(flow->inFlightStream, flow->sourceId, TRACE_IN_FLIGHT, false, inFlight);
 }
 
 /**
  * Next RX tracer.
  *
- * \param context The context.
+ * \param flow The flow.
  * \param old Old sequence number.
  * \param nextRx Next sequence number.
  */
 static void
-NextRxTracer(std::string context, SequenceNumber32 old [[maybe_unused]], SequenceNumber32 nextRx)
+NextRxTracer(FlowTracer* flow, SequenceNumber32 old [[maybe_unused]], SequenceNumber32 nextRx)
+{
+    WriteSample(flow->nextRxStream, flow->sinkId, TRACE_NEXT_RX, false, nextRx);
+}
+
+/**
+ * TcpHyblaI rho tracer.
+ *
+ * \param flow The flow.
+ * \param old Old value.
+ * \param rho New value.
+ */
+static void
+RhoTracer(FlowTracer* flow, double old [[maybe_unused]], double rho)
 {
-    uint32_t nodeId = GetNodeIdFromContext(context);
+    WriteSample(flow->rhoStream, flow->sourceId, TRACE_RHO, false, rho);
+}
 
-    *nextRxStream[nodeId]->GetStream()
-        << Simulator::Now().GetSeconds() << " " << nextRx << std::endl;
+/**
+ * TcpHyblaI smoothed RTT tracer.
+ *
+ * \param flow The flow.
+ * \param old Old value.
+ * \param sRtt New value.
+ */
+static void
+SmoothedRttTracer(FlowTracer* flow, Time old [[maybe_unused]], Time sRtt)
+{
+    WriteSample(flow->sRttStream, flow->sourceId, TRACE_SRTT, false, sRtt.GetSeconds());
 }
 
 /**
- * Congestion window trace connection.
+ * TcpHyblaI scaling factor tracer: one sample of each factor per scaled window increment.
  *
- * \param cwnd_tr_file_name Congestion window trace file name.
- * \param nodeId Node ID.
- * cwnd_tr_file_name: The name of the file where the congestion window data will be logged.
-*  nodeId: The ID of the node whose TCP congestion window will be traced.
+ * \param flow The flow.
+ * \param inflightFactor Factor from the in-flight to cwnd ratio.
+ * \param rtoFactor Factor from the RTO to sRtt ratio.
+ * \param outstandingFactor Factor from the outstanding data.
+ * \param scale Scaling factor applied.
  */
 static void
-TraceCwnd(std::string cwnd_tr_file_name, uint32_t nodeId)
-{
-    //An instance of AsciiTraceHelper is created, which facilitates creating file streams for ASCII-based tracing.
-    AsciiTraceHelper ascii;
-    cWndStream[nodeId] = ascii.CreateFileStream(cwnd_tr_file_name);
-    //Points to the CongestionWindow attribute of the first TCP socket (SocketList/0) on the specified node (NodeList/<nodeId>).
-    //MakeCallback(&CwndTracer) wraps the CwndTracer function, so it gets invoked whenever the CongestionWindow attribute changes.
-    Config::Connect("/NodeList/" + std::to_string(nodeId) +
-                        "/$ns3::TcpL4Protocol/SocketList/0/CongestionWindow",
-                    MakeCallback(&CwndTracer));
+ScalingFactorTracer(FlowTracer* flow,
+                    double inflightFactor,
+                    double rtoFactor,
+                    double outstandingFactor,
+                    double scale)
+{
+    WriteSample(flow->inFlightFactorStream,
+                flow->sourceId,
+                TRACE_INFLIGHT_FACTOR,
+                false,
+                inflightFactor);
+    WriteSample(flow->rtoFactorStream, flow->sourceId, TRACE_RTO_FACTOR, false, rtoFactor);
+    WriteSample(flow->outstandingFactorStream,
+                flow->sourceId,
+                TRACE_OUTSTANDING_FACTOR,
+                false,
+                outstandingFactor);
+    WriteSample(flow->scaleStream, flow->sourceId, TRACE_SCALE, false, scale);
 }
 
 /**
- * Slow start threshold trace connection.
+ * Get a TCP socket of a node. The path is resolved once, when the tracers are connected.
  *
- * \param ssthresh_tr_file_name Slow start threshold trace file name.
  * \param nodeId Node ID.
+ * \param index Index of the socket in the SocketList of the node's TcpL4Protocol.
+ * \return the socket.
+ */
+static Ptr<TcpSocketBase>
+GetTcpSocket(uint32_t nodeId, uint32_t index)
+{
+    Config::MatchContainer matches =
+        Config::LookupMatches("/NodeList/" + std::to_string(nodeId) +
+                              "/$ns3::TcpL4Protocol/SocketList/" + std::to_string(index));
+    NS_ABORT_MSG_IF(matches.GetN() == 0,
+                    "No TCP socket " << index << " on node " << nodeId);
+    return matches.Get(0)->GetObject<TcpSocketBase>();
+}
+
+/**
+ * Sender side trace connection: congestion window, slow start threshold, RTT, RTO,
+ * next TX sequence and bytes in flight of the first TCP socket (SocketList/0) of the sender,
+ * and the rho, smoothed RTT and scaling factors of TcpHyblaI.
+ *
+ * \param flow The flow.
  */
 static void
-TraceSsThresh(std::string ssthresh_tr_file_name, uint32_t nodeId)
+TraceSource(FlowTracer* flow)
 {
-    AsciiTraceHelper ascii;
-    ssThreshStream[nodeId] = ascii.CreateFileStream(ssthresh_tr_file_name);
-    Config::Connect("/NodeList/" + std::to_string(nodeId) +
-                        "/$ns3::TcpL4Protocol/SocketList/0/SlowStartThreshold",
-                    MakeCallback(&SsThreshTracer));
+    Ptr<TcpSocketBase> socket = GetTcpSocket(flow->sourceId, 0);
+    //MakeBoundCallback(&CwndTracer, flow) binds the flow to CwndTracer, so it gets invoked with
+    //the flow whenever the CongestionWindow attribute changes.
+    socket->TraceConnectWithoutContext("CongestionWindow", MakeBoundCallback(&CwndTracer, flow));
+    socket->TraceConnectWithoutContext("SlowStartThreshold",
+                                       MakeBoundCallback(&SsThreshTracer, flow));
+    socket->TraceConnectWithoutContext("RTT", MakeBoundCallback(&RttTracer, flow));
+    socket->TraceConnectWithoutContext("RTO", MakeBoundCallback(&RtoTracer, flow));
+    socket->TraceConnectWithoutContext("NextTxSequence", MakeBoundCallback(&NextTxTracer, flow));
+    socket->TraceConnectWithoutContext("BytesInFlight", MakeBoundCallback(&InFlightTracer, flow));
+
+    if (flow->hyblaI)
+    {
+        // The TcpHyblaI instance the socket was created with, reached through its CongestionOps
+        std::string path = "/NodeList/" + std::to_string(flow->sourceId) +
+                           "/$ns3::TcpL4Protocol/SocketList/0/CongestionOps/$ns3::TcpHyblaI/";
+        bool connected =
+            Config::ConnectWithoutContextFailSafe(path + "HyblaIRho",
+                                                  MakeBoundCallback(&RhoTracer, flow)) &&
+            Config::ConnectWithoutContextFailSafe(path + "SmoothedRtt",
+                                                  MakeBoundCallback(&SmoothedRttTracer, flow)) &&
+            Config::ConnectWithoutContextFailSafe(path + "ScalingFactor",
+                                                  MakeBoundCallback(&ScalingFactorTracer, flow));
+        NS_ABORT_MSG_UNLESS(connected,
+                            "No TcpHyblaI congestion control on node " << flow->sourceId);
+    }
+}
 
+/**
+ * Receiver side trace connection.
+ *
+ * \param flow The flow.
+ * Purpose: Sets up tracing to log the next expected sequence number
+ * (used for TCP acknowledgment) in the receive buffer of the flow's receiver.
+ */
+static void
+TraceSink(FlowTracer* flow)
+{
+    //The NextRxSequence of the receive buffer in the second TCP socket (SocketList/1) on the
+    //receiver, the one accepted by the PacketSink.
+    GetTcpSocket(flow->sinkId, 1)->GetRxBuffer()->TraceConnectWithoutContext(
+        "NextRxSequence",
+        MakeBoundCallback(&NextRxTracer, flow));
 }
 
 /**
- * RTT trace connection.
+ * Goodput of a flow.
  *
- * \param rtt_tr_file_name RTT trace file name.
- * \param nodeId Node ID.
+ * \param sinkApps The PacketSink of each flow, in flow order.
+ * \param flow The flow.
+ * \param start_time Start time offset between two flows (s).
+ * \param stop_time Simulation stop time (s).
+ * \return the goodput (Mb/s).
+ */
+static double
+FlowGoodput(const ApplicationContainer& sinkApps,
+            uint32_t flow,
+            double start_time,
+            double stop_time)
+{
+    Ptr<PacketSink> sink = DynamicCast<PacketSink>(sinkApps.Get(flow));
+    // Flow i starts at start_time * i
+    return sink->GetTotalRx() * 8.0 / (stop_time - start_time * flow) / 1e6;
+}
+
+/**
+ * Print the benchmark report: the simulator cost, and the goodput and Jain fairness index of
+ * the flows.
+ *
+ * \param sinkApps The PacketSink of each flow, in flow order.
+ * \param start_time Start time offset between two flows (s).
+ * \param stop_time Simulation stop time (s).
+ * \param setup_seconds Wall-clock time of the scenario setup (s).
+ * \param run_seconds Wall-clock time of Simulator::Run (s).
  */
 static void
-TraceRtt(std::string rtt_tr_file_name, uint32_t nodeId)
+ReportBenchmark(const ApplicationContainer& sinkApps,
+                double start_time,
+                double stop_time,
+                double setup_seconds,
+                double run_seconds)
 {
-    AsciiTraceHelper ascii;
-    rttStream[nodeId] = ascii.CreateFileStream(rtt_tr_file_name);
-    Config::Connect("/NodeList/" + std::to_string(nodeId) + "/$ns3::TcpL4Protocol/SocketList/0/RTT",
-                    MakeCallback(&RttTracer));
+    double total = 0.0;
+    double squares = 0.0;
+    for (uint32_t i = 0; i < sinkApps.GetN(); i++)
+    {
+        double goodput = FlowGoodput(sinkApps, i, start_time, stop_time);
+        total += goodput;
+        squares += goodput * goodput;
+    }
+    // Jain fairness index: (sum x)^2 / (n * sum x^2), 1 when all flows get the same goodput
+    double fairness = (squares > 0.0) ? total * total / (sinkApps.GetN() * squares) : 0.0;
+    uint64_t events = Simulator::GetEventCount();
+
+    std::cout << "flows " << sinkApps.GetN() << "\n"
+              << "goodput_total_mbps " << total << "\n"
+              << "goodput_mean_mbps " << total / sinkApps.GetN() << "\n"
+              << "jain_fairness " << fairness << "\n"
+              << "events " << events << "\n"
+              << "events_per_second " << (run_seconds > 0.0 ? events / run_seconds : 0.0) << "\n"
+              << "setup_wall_seconds " << setup_seconds << "\n"
+              << "run_wall_seconds " << run_seconds << "\n"
+              << "total_wall_seconds " << setup_seconds + run_seconds << std::endl;
 }
 
 /**
- * RTO trace connection.
+ * Occupancy of one bottleneck queue disc: a text trace of its packets in queue, and the peak and
+ * time average of it for the end of run report.
+ */
+struct QueueTracer
+{
+    /**
+     * Create the trace file of the queue and connect to the queue disc.
+     *
+     * \param file_name Trace file name.
+     * \param queue The queue disc.
+     */
+    QueueTracer(const std::string& file_name, Ptr<QueueDisc> queue)
+        : queueDisc(queue)
+    {
+        AsciiTraceHelper ascii;
+        stream = ascii.CreateFileStream(file_name);
+        *stream->GetStream() << "0.0 0\n";
+        queue->TraceConnectWithoutContext("PacketsInQueue",
+                                          MakeCallback(&QueueTracer::PacketsInQueue, this));
+    }
+
+    /**
+     * Packets in queue tracer.
+     *
+     * \param oldval Old value.
+     * \param newval New value.
+     */
+    void PacketsInQueue(uint32_t oldval, uint32_t newval)
+    {
+        Time now = Simulator::Now();
+        area += oldval * (now - lastChange).GetSeconds();
+        lastChange = now;
+        maxPackets = std::max(maxPackets, newval);
+        *stream->GetStream() << now.GetSeconds() << " " << newval << "\n";
+    }
+
+    /**
+     * Time average of the packets in queue since the start of the simulation.
+     *
+     * \return the mean occupancy (packets).
+     */
+    double MeanPackets() const
+    {
+        Time now = Simulator::Now();
+        double total = area + queueDisc->GetNPackets() * (now - lastChange).GetSeconds();
+        return now.IsStrictlyPositive() ? total / now.GetSeconds() : 0.0;
+    }
+
+    Ptr<QueueDisc> queueDisc;        //!< The queue disc.
+    Ptr<OutputStreamWrapper> stream; //!< Packets in queue output stream.
+    Time lastChange;                 //!< Time of the last change of the occupancy.
+    double area{0.0};                //!< Integral of the occupancy until lastChange (packet s).
+    uint32_t maxPackets{0};          //!< Peak occupancy (packets).
+};
+
+/**
+ * Print the occupancy and the drops of the bottleneck queue discs.
  *
- * \param rto_tr_file_name RTO trace file name.
- * \param nodeId Node ID.
+ * \param queues The tracers of the bottleneck queue discs.
  */
 static void
-TraceRto(std::string rto_tr_file_name, uint32_t nodeId)
+ReportQueues(const std::vector<std::unique_ptr<QueueTracer>>& queues)
 {
-    AsciiTraceHelper ascii;
-    rtoStream[nodeId] = ascii.CreateFileStream(rto_tr_file_name);
-    Config::Connect("/NodeList/" + std::to_string(nodeId) + "/$ns3::TcpL4Protocol/SocketList/0/RTO",
-                    MakeCallback(&RtoTracer));
+    for (uint32_t i = 0; i < queues.size(); i++)
+    {
+        const QueueTracer& queue = *queues[i];
+        const QueueDisc::Stats& stats = queue.queueDisc->GetStats();
+        std::cout << "queue " << i << " limit " << queue.queueDisc->GetMaxSize()
+                  << " max_packets " << queue.maxPackets << " mean_packets "
+                  << queue.MeanPackets() << " dropped_packets " << stats.nTotalDroppedPackets
+                  << " sent_packets " << stats.nTotalSentPackets << std::endl;
+    }
 }
 
 /**
- * Next TX trace connection.
+ * One simulation of the batch mode.
+ */
+struct BatchConfig
+{
+    std::string protocol;  //!< TCP variant, without the ns3:: prefix.
+    double errorRate;      //!< Packet error rate of the bottleneck.
+    std::string bandwidth; //!< Bottleneck bandwidth.
+    uint32_t run;          //!< Run number given to SeedManager::SetRun.
+};
+
+/**
+ * Metrics of one simulation, as sent back by its worker process.
+ */
+struct BatchResult
+{
+    double goodput; //!< Total goodput of the flows (Mb/s).
+    double rtt;     //!< Mean of the RTT samples of the senders (s).
+};
+
+/// RTT samples of the senders, for the batch mode result.
+static struct
+{
+    double sum{0.0};     //!< Sum of the samples (s).
+    uint64_t samples{0}; //!< Number of samples.
+} rttStats;
+
+/**
+ * RTT tracer of the batch mode.
  *
- * \param next_tx_seq_file_name Next TX trace file name.
- * \param nodeId Node ID.
+ * \param oldval Old value.
+ * \param newval New value.
  */
 static void
-TraceNextTx(std::string& next_tx_seq_file_name, uint32_t nodeId)
+RttSample(Time oldval [[maybe_unused]], Time newval)
 {
-    AsciiTraceHelper ascii;
-    nextTxStream[nodeId] = ascii.CreateFileStream(next_tx_seq_file_name);
-    Config::Connect("/NodeList/" + std::to_string(nodeId) +
-                        "/$ns3::TcpL4Protocol/SocketList/0/NextTxSequence",
-                    MakeCallback(&NextTxTracer));
+    rttStats.sum += newval.GetSeconds();
+    rttStats.samples++;
 }
 
 /**
- * In flight trace connection.
+ * Connect the RTT of the first TCP socket of a sender to the batch mode statistics.
  *
- * \param in_flight_file_name In flight trace file name.
- * \param nodeId Node ID.
+ * \param nodeId Node ID of the sender.
  */
 static void
-TraceInFlight(std::string& in_flight_file_name, uint32_t nodeId)
+TraceRttStats(uint32_t nodeId)
+{
+    GetTcpSocket(nodeId, 0)->TraceConnectWithoutContext("RTT", MakeCallback(&RttSample));
+}
+
+/**
+ * Split a comma-separated list.
+ * \param list The list.
+ * \return the non-empty items.
+ */
+static std::vector<std::string>
+SplitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (!item.empty())
+        {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+/**
+ * Half width of the 95% confidence interval of a mean.
+ * \param values The samples.
+ * \param mean Their mean.
+ * \return the half width, 0 with less than two samples.
+ */
+static double
+ConfidenceHalfWidth(const std::vector<double>& values, double mean)
 {
-    AsciiTraceHelper ascii;
-    inFlightStream[nodeId] = ascii.CreateFileStream(in_flight_file_name);
-    Config::Connect("/NodeList/" + std::to_string(nodeId) +
-                        "/$ns3::TcpL4Protocol/SocketList/0/BytesInFlight",
-                    MakeCallback(&InFlightTracer));
+    // Student t quantiles for a two-sided 95% interval, by degrees of freedom
+    static const double t95[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                 2.262,  2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                 2.110,  2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                 2.060,  2.056, 2.052, 2.048, 2.045, 2.042};
+    std::size_t n = values.size();
+    if (n < 2)
+    {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double v : values)
+    {
+        sum += (v - mean) * (v - mean);
+    }
+    double stddev = std::sqrt(sum / (n - 1));
+    double t = (n - 1 <= 30) ? t95[n - 2] : 1.960;
+    return t * stddev / std::sqrt(static_cast<double>(n));
 }
 
 /**
- * Next RX trace connection.
+ * Write the batch summary: the mean and 95% confidence interval of the goodput and RTT of the
+ * replicas of each configuration, one CSV row per configuration.
  *
- * \param next_rx_seq_file_name Next RX trace file name.
- * \param nodeId Node ID.
- * Purpose: Sets up tracing to log the next expected sequence number 
- * (used for TCP acknowledgment) in the receive buffer of a TCP connection on a specified node.
+ * \param file_name Summary file name.
+ * \param configs The simulations, the replicas of a configuration adjacent.
+ * \param results Their results.
+ * \param done Whether each simulation succeeded.
  */
 static void
-TraceNextRx(std::string& next_rx_seq_file_name, uint32_t nodeId)
-{
-    AsciiTraceHelper ascii;
-    nextRxStream[nodeId] = ascii.CreateFileStream(next_rx_seq_file_name);
-    //Specifies the NextRxSequence attribute of the receive buffer in the second
-    // TCP socket (SocketList/1) on the node identified by nodeId.
-    Config::Connect("/NodeList/" + std::to_string(nodeId) +
-                        "/$ns3::TcpL4Protocol/SocketList/1/RxBuffer/NextRxSequence",
-                    MakeCallback(&NextRxTracer));
+WriteBatchSummary(const std::string& file_name,
+                  const std::vector<BatchConfig>& configs,
+                  const std::vector<BatchResult>& results,
+                  const std::vector<bool>& done)
+{
+    std::ofstream out(file_name);
+    NS_ABORT_MSG_UNLESS(out.is_open(), "Could not open " << file_name);
+    out << "protocol,error_p,bandwidth,replicas,goodput_mbps,goodput_ci95,rtt_s,rtt_ci95"
+        << std::endl;
+    for (std::size_t first = 0; first < configs.size();)
+    {
+        std::size_t last = first;
+        while (last < configs.size() && configs[last].protocol == configs[first].protocol &&
+               configs[last].errorRate == configs[first].errorRate &&
+               configs[last].bandwidth == configs[first].bandwidth)
+        {
+            last++;
+        }
+        std::vector<double> metrics[2];
+        for (std::size_t i = first; i < last; i++)
+        {
+            if (done[i])
+            {
+                metrics[0].push_back(results[i].goodput);
+                metrics[1].push_back(results[i].rtt);
+            }
+        }
+        const BatchConfig& config = configs[first];
+        out << config.protocol << "," << config.errorRate << "," << config.bandwidth << ","
+            << metrics[0].size();
+        for (const auto& values : metrics)
+        {
+            double mean = 0.0;
+            for (double v : values)
+            {
+                mean += v;
+            }
+            if (!values.empty())
+            {
+                mean /= values.size();
+            }
+            out << "," << mean << "," << ConfidenceHalfWidth(values, mean);
+        }
+        out << std::endl;
+        first = last;
+    }
+}
+
+/**
+ * Run every simulation of the batch in forked worker processes, at most jobs at a time, and
+ * write the summary once they are done. A worker returns from this function with the index of
+ * its simulation and the pipe to send its BatchResult to; the parent simulates nothing.
+ *
+ * \param configs The simulations.
+ * \param jobs Maximum number of worker processes.
+ * \param summary_file Summary file name.
+ * \param [out] index Index of the simulation of the worker.
+ * \param [out] result_fd Pipe to write the BatchResult of the worker to.
+ * \return true in a worker, false in the parent once the summary is written.
+ */
+static bool
+RunBatch(const std::vector<BatchConfig>& configs,
+         uint32_t jobs,
+         const std::string& summary_file,
+         std::size_t& index,
+         int& result_fd)
+{
+    std::vector<BatchResult> results(configs.size());
+    std::vector<bool> done(configs.size(), false);
+    std::map<pid_t, std::pair<std::size_t, int>> workers;
+    std::size_t next = 0;
+    while (next < configs.size() || !workers.empty())
+    {
+        while (next < configs.size() && workers.size() < jobs)
+        {
+            int fds[2];
+            if (pipe(fds) != 0)
+            {
+                NS_FATAL_ERROR("Could not create pipe for worker");
+            }
+            std::cout.flush();
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                NS_FATAL_ERROR("Could not fork worker");
+            }
+            if (pid == 0)
+            {
+                close(fds[0]);
+                index = next;
+                result_fd = fds[1];
+                return true;
+            }
+            close(fds[1]);
+            workers[pid] = std::make_pair(next, fds[0]);
+            next++;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        auto worker = workers.find(pid);
+        if (worker == workers.end())
+        {
+            continue;
+        }
+        std::size_t i = worker->second.first;
+        int fd = worker->second.second;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+            read(fd, &results[i], sizeof(BatchResult)) == sizeof(BatchResult))
+        {
+            done[i] = true;
+        }
+        else
+        {
+            const BatchConfig& config = configs[i];
+            NS_LOG_ERROR("Simulation " << config.protocol << " error_p=" << config.errorRate
+                                       << " bandwidth=" << config.bandwidth
+                                       << " run=" << config.run << " failed");
+        }
+        close(fd);
+        workers.erase(worker);
+    }
+
+    WriteBatchSummary(summary_file, configs, results, done);
+    return false;
 }
 
 int
 main(int argc, char* argv[])
 {
+    auto wallStart = std::chrono::steady_clock::now();
     std::string transport_prot = "TcpWestwoodPlus";
     double error_p = 0.0;
     std::string bandwidth = "2Mbps";
@@ -407,6 +1055,17 @@ main(int argc, char* argv[])
     bool sack = true;
     std::string queue_disc_type = "ns3::PfifoFastQueueDisc";
     std::string recovery = "ns3::TcpClassicRecovery";
+    std::string trace_format = "ascii";
+    std::string convert_trace;
+    bool benchmark = false;
+    bool pacing = false;
+    bool queue_report = false;
+    std::string protocols;
+    std::string error_rates;
+    std::string bandwidths;
+    uint32_t replicas = 1;
+    uint32_t jobs = 0;
+    std::string summary_file;
 
     CommandLine cmd(__FILE__);
     cmd.AddValue("transport_prot",
@@ -434,8 +1093,123 @@ main(int argc, char* argv[])
                  queue_disc_type);
     cmd.AddValue("sack", "Enable or disable SACK option", sack);
     cmd.AddValue("recovery", "Recovery algorithm type to use (e.g., ns3::TcpPrrRecovery", recovery);
+    cmd.AddValue("trace_format",
+                 "Format of the TCP traces: ascii (one text file per metric and flow) or binary "
+                 "(all records in <prefix_name>-trace.bin)",
+                 trace_format);
+    cmd.AddValue("convert_trace",
+                 "Convert this binary trace to the ascii trace files named after prefix_name, "
+                 "then exit",
+                 convert_trace);
+    cmd.AddValue("benchmark",
+                 "Dumbbell benchmark: all flows share one bottleneck queue between two gateways, "
+                 "with static routes, and the simulator cost, goodput and fairness are reported",
+                 benchmark);
+    cmd.AddValue("pacing",
+                 "Enable TCP pacing. TcpHyblaI then sets the pacing rate from its own cwnd/sRtt",
+                 pacing);
+    cmd.AddValue("queue_report",
+                 "Trace the packets in each bottleneck queue disc to <prefix_name>[-flowN]"
+                 "-queue.data, and report their peak, mean and drops at the end",
+                 queue_report);
+    cmd.AddValue("protocols",
+                 "Batch mode: comma-separated list of transport protocols (default transport_prot)",
+                 protocols);
+    cmd.AddValue("error_rates",
+                 "Batch mode: comma-separated list of packet error rates (default error_p)",
+                 error_rates);
+    cmd.AddValue("bandwidths",
+                 "Batch mode: comma-separated list of bottleneck bandwidths (default bandwidth)",
+                 bandwidths);
+    cmd.AddValue("replicas",
+                 "Batch mode: replicas of each configuration, with runs run, run+1, ...",
+                 replicas);
+    cmd.AddValue("jobs",
+                 "Batch mode: maximum number of parallel simulations, 0 for one per core",
+                 jobs);
+    cmd.AddValue("summary_file",
+                 "Batch mode summary CSV (default <prefix_name>-summary.csv)",
+                 summary_file);
     cmd.Parse(argc, argv);
 
+    if (!convert_trace.empty())
+    {
+        ConvertBinaryTrace(convert_trace, prefix_file_name);
+        return 0;
+    }
+    NS_ABORT_MSG_UNLESS(trace_format == "ascii" || trace_format == "binary",
+                        "Unknown trace format " << trace_format);
+
+    // Batch mode: every combination of the lists, replicas times, each simulation in its own
+    // worker process, which then runs the code below with its configuration
+    int batch_fd = -1;
+    if (!protocols.empty() || !error_rates.empty() || !bandwidths.empty() || replicas > 1)
+    {
+        std::vector<std::string> protocolList = SplitList(protocols);
+        if (protocolList.empty())
+        {
+            protocolList.push_back(transport_prot);
+        }
+        std::vector<double> errorRateList;
+        for (const auto& item : SplitList(error_rates))
+        {
+            errorRateList.push_back(std::stod(item));
+        }
+        if (errorRateList.empty())
+        {
+            errorRateList.push_back(error_p);
+        }
+        std::vector<std::string> bandwidthList = SplitList(bandwidths);
+        if (bandwidthList.empty())
+        {
+            bandwidthList.push_back(bandwidth);
+        }
+        NS_ABORT_MSG_UNLESS(replicas > 0, "At least one replica is needed");
+
+        std::vector<BatchConfig> configs;
+        for (const auto& protocol : protocolList)
+        {
+            TypeId protocolTid;
+            NS_ABORT_MSG_UNLESS(TypeId::LookupByNameFailSafe("ns3::" + protocol, &protocolTid),
+                                "TypeId ns3::" << protocol << " not found");
+            for (double errorRate : errorRateList)
+            {
+                for (const auto& bw : bandwidthList)
+                {
+                    for (uint32_t replica = 0; replica < replicas; replica++)
+                    {
+                        configs.push_back({protocol, errorRate, bw, run + replica});
+                    }
+                }
+            }
+        }
+        if (jobs == 0)
+        {
+            long cores = sysconf(_SC_NPROCESSORS_ONLN);
+            jobs = cores > 0 ? cores : 1;
+        }
+        if (summary_file.empty())
+        {
+            summary_file = prefix_file_name + "-summary.csv";
+        }
+
+        std::size_t index;
+        if (!RunBatch(configs, jobs, summary_file, index, batch_fd))
+        {
+            return 0;
+        }
+        const BatchConfig& config = configs[index];
+        transport_prot = config.protocol;
+        error_p = config.errorRate;
+        bandwidth = config.bandwidth;
+        run = config.run;
+        // Workers run concurrently, so the optional traces of each one get their own names
+        std::ostringstream name;
+        name << prefix_file_name << "-" << config.protocol << "-err" << config.errorRate << "-bw"
+             << config.bandwidth << "-run" << config.run;
+        prefix_file_name = name.str();
+    }
+
     transport_prot = std::string("ns3::") + transport_prot;
 
     SeedManager::SetSeed(1);
@@ -477,6 +1251,11 @@ main(int argc, char* argv[])
     // even if some packets in between are lost.
    //Improves performance in the presence of packet loss by avoiding retransmission of already received data
 
+    // Pacing spreads each window over the RTT, so that the window steps of a long RTT path do
+    // not reach the BDP sized bottleneck queue as one burst
+    Config::SetDefault("ns3::TcpSocketState::EnablePacing", BooleanValue(pacing));
+    Config::SetDefault("ns3::TcpHyblaI::Pacing", BooleanValue(pacing));
+
     Config::SetDefault("ns3::TcpL4Protocol::RecoveryType",
                        TypeIdValue(TypeId::LookupByName(recovery)));
     // Select TCP variant
@@ -493,6 +1272,11 @@ main(int argc, char* argv[])
     sources.Create(num_flows);
     NodeContainer sinks;
     sinks.Create(num_flows);
+    if (benchmark)
+    {
+        // The second gateway is created last, so that sources and sinks keep their node IDs
+        gateways.Create(1);
+    }
 
     // Configure the error model
     // Here we use RateErrorModel with packet error rate
@@ -530,6 +1314,26 @@ main(int argc, char* argv[])
     TrafficControlHelper tchCoDel;
     tchCoDel.SetRootQueueDisc("ns3::CoDelQueueDisc");
 
+    // The queue disc of the first device of each bottleneck, the one on the way to the sinks
+    QueueDiscContainer bottleneckQueues;
+    auto installBottleneckQueueDisc = [&](NetDeviceContainer& devices) {
+        QueueDiscContainer queues;
+        if (queue_disc_type == "ns3::PfifoFastQueueDisc")
+        {
+            queues = tchPfifo.Install(devices);
+        }
+        else if (queue_disc_type == "ns3::CoDelQueueDisc")
+        {
+            queues = tchCoDel.Install(devices);
+        }
+        else
+        {
+            NS_FATAL_ERROR("Queue not recognized. Allowed values are ns3::CoDelQueueDisc or "
+                           "ns3::PfifoFastQueueDisc");
+        }
+        bottleneckQueues.Add(queues.Get(0));
+    };
+
     Ipv4AddressHelper address;
     address.SetBase("10.0.0.0", "255.255.255.0");
 
@@ -558,7 +1362,49 @@ main(int argc, char* argv[])
     Config::SetDefault("ns3::CoDelQueueDisc::MaxSize",
                        QueueSizeValue(QueueSize(QueueSizeUnit::BYTES, size)));
 
-    for (uint32_t i = 0; i < num_flows; i++)
+    if (benchmark)
+    {
+        // Dumbbell: source -> gateway 0 -> bottleneck -> gateway 1 -> sink. The sink side links
+        // have no delay, so that the base RTT is the same as in the default topology. Only the
+        // bottleneck has a queue disc: the default one that the address assignment installs on
+        // the access links is removed, so they just use their device queue.
+        TrafficControlHelper tchAccess;
+        PointToPointHelper SinkLink;
+        SinkLink.SetDeviceAttribute("DataRate", StringValue(access_bandwidth));
+        SinkLink.SetChannelAttribute("Delay", StringValue("0ms"));
+
+        // Static routes: every host has a default route to its gateway, and each gateway
+        // reaches the hosts of the other side through the bottleneck. Global routing is not
+        // needed, which keeps the setup linear in the number of flows.
+        Ipv4StaticRoutingHelper staticRouting;
+        NetDeviceContainer devices = UnReLink.Install(gateways.Get(0), gateways.Get(1));
+        installBottleneckQueueDisc(devices);
+        Ipv4InterfaceContainer bottleneck = address.Assign(devices);
+        staticRouting.GetStaticRouting(bottleneck.Get(0).first)
+            ->SetDefaultRoute(bottleneck.GetAddress(1), bottleneck.Get(0).second);
+        staticRouting.GetStaticRouting(bottleneck.Get(1).first)
+            ->SetDefaultRoute(bottleneck.GetAddress(0), bottleneck.Get(1).second);
+
+        for (uint32_t i = 0; i < num_flows; i++)
+        {
+            devices = LocalLink.Install(sources.Get(i), gateways.Get(0));
+            address.NewNetwork();
+            Ipv4InterfaceContainer interfaces = address.Assign(devices);
+            tchAccess.Uninstall(devices);
+            staticRouting.GetStaticRouting(interfaces.Get(0).first)
+                ->SetDefaultRoute(interfaces.GetAddress(1), interfaces.Get(0).second);
+
+            devices = SinkLink.Install(gateways.Get(1), sinks.Get(i));
+            address.NewNetwork();
+            interfaces = address.Assign(devices);
+            tchAccess.Uninstall(devices);
+            staticRouting.GetStaticRouting(interfaces.Get(1).first)
+                ->SetDefaultRoute(interfaces.GetAddress(0), interfaces.Get(1).second);
+            sink_interfaces.Add(interfaces.Get(1));
+        }
+    }
+
+    for (uint32_t i = 0; i < num_flows && !benchmark; i++)
     {
         NetDeviceContainer devices;
         //This installs a Point-to-Point (P2P) link between a source node (sources.Get(i)) and the gateway node (gateways.Get(0)).
@@ -568,19 +1414,7 @@ main(int argc, char* argv[])
         Ipv4InterfaceContainer interfaces = address.Assign(devices);
 
         devices = UnReLink.Install(gateways.Get(0), sinks.Get(i));
-        if (queue_disc_type == "ns3::PfifoFastQueueDisc")
-        {
-            tchPfifo.Install(devices);
-        }
-        else if (queue_disc_type == "ns3::CoDelQueueDisc")
-        {
-            tchCoDel.Install(devices);
-        }
-        else
-        {
-            NS_FATAL_ERROR("Queue not recognized. Allowed values are ns3::CoDelQueueDisc or "
-                           "ns3::PfifoFastQueueDisc");
-        }
+        installBottleneckQueueDisc(devices);
         address.NewNetwork();
         interfaces = address.Assign(devices);
         sink_interfaces.Add(interfaces.Get(1));
@@ -588,12 +1422,16 @@ main(int argc, char* argv[])
          // This keeps track of the IP interface for each sink node, which can be used later to send traffic to the sinks.
     }
 
-    NS_LOG_INFO("Initialize Global Routing.");
-    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    if (!benchmark)
+    {
+        NS_LOG_INFO("Initialize Global Routing.");
+        Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    }
 
     uint16_t port = 50000;
     Address sinkLocalAddress(InetSocketAddress(Ipv4Address::GetAny(), port));
     PacketSinkHelper sinkHelper("ns3::TcpSocketFactory", sinkLocalAddress);
+    ApplicationContainer sinkApps;
 
     for (uint32_t i = 0; i < sources.GetN(); i++)
     {
@@ -614,6 +1452,7 @@ main(int argc, char* argv[])
         ApplicationContainer sinkApp = sinkHelper.Install(sinks.Get(i));
         sinkApp.Start(Seconds(start_time * i));
         sinkApp.Stop(Seconds(stop_time));
+        sinkApps.Add(sinkApp);
     }
 
     // Set up tracing if enabled
@@ -624,6 +1463,12 @@ main(int argc, char* argv[])
         ascii.open(prefix_file_name + "-ascii");
         ascii_wrap = new OutputStreamWrapper(prefix_file_name + "-ascii", std::ios::out);
         stack.EnableAsciiIpv4All(ascii_wrap);
+        if (trace_format == "binary")
+        {
+            binaryTrace = std::make_unique<BinaryTraceWriter>(prefix_file_name + "-trace.bin",
+                                                              num_flows,
+                                                              1 << 16);
+        }
 
         for (uint16_t index = 0; index < num_flows; index++)
         {
@@ -632,48 +1477,42 @@ main(int argc, char* argv[])
             {
                 flowString = "-flow" + std::to_string(index);
             }
-            //This block initializes flow-specific variables (like firstCwnd, firstSshThr, firstRtt, firstRto)
-            // to true to indicate that these flows are just starting. These variables are likely used
-            // to track whether it's the first time the corresponding metric is being traced for that flow.
-            firstCwnd[index + 1] = true;
-            firstSshThr[index + 1] = true;
-            firstRtt[index + 1] = true;
-            firstRto[index + 1] = true;
-            // Each callback corresponds to a specific metric and is scheduled at a time slightly offset from the start time
-            // (start_time * index + 0.00001) ensures that each flow's tracing starts a bit later, avoiding conflicts between flows
-            Simulator::Schedule(Seconds(start_time * index + 0.00001),
-                                &TraceCwnd,
-                                prefix_file_name + flowString + "-cwnd.data",
-                                index + 1);
-            Simulator::Schedule(Seconds(start_time * index + 0.00001),
-                                &TraceSsThresh,
-                                prefix_file_name + flowString + "-ssth.data",
-                                index + 1);
+            flowTracers.push_back(std::make_unique<FlowTracer>(prefix_file_name + flowString,
+                                                               index + 1,
+                                                               num_flows + index + 1,
+                                                               transport_prot ==
+                                                                   "ns3::TcpHyblaI"));
+            // The tracers of each flow are connected once its sockets exist. The sender side
+            // (start_time * index + 0.00001) right after its BulkSend starts, the receiver side
+            // 0.1 s later, once the PacketSink has accepted the connection.
             Simulator::Schedule(Seconds(start_time * index + 0.00001),
-                                &TraceRtt,
-                                prefix_file_name + flowString + "-rtt.data",
-                                index + 1);
-            Simulator::Schedule(Seconds(start_time * index + 0.00001),
-                                &TraceRto,
-                                prefix_file_name + flowString + "-rto.data",
-                                index + 1);
-            Simulator::Schedule(Seconds(start_time * index + 0.00001),
-                                &TraceNextTx,
-                                prefix_file_name + flowString + "-next-tx.data",
-                                index + 1);
-            Simulator::Schedule(Seconds(start_time * index + 0.00001),
-                                &TraceInFlight,
-                                prefix_file_name + flowString + "-inflight.data",
-                                index + 1);
+                                &TraceSource,
+                                flowTracers.back().get());
             Simulator::Schedule(Seconds(start_time * index + 0.1),
-                                &TraceNextRx,
-                                prefix_file_name + flowString + "-next-rx.data",
-                                num_flows + index + 1);
+                                &TraceSink,
+                                flowTracers.back().get());
+        }
+    }
+
+    std::vector<std::unique_ptr<QueueTracer>> queueTracers;
+    if (queue_report)
+    {
+        for (uint32_t i = 0; i < bottleneckQueues.GetN(); i++)
+        {
+            std::string flowString;
+            if (bottleneckQueues.GetN() > 1)
+            {
+                flowString = "-flow" + std::to_string(i);
+            }
+            queueTracers.push_back(
+                std::make_unique<QueueTracer>(prefix_file_name + flowString + "-queue.data",
+                                              bottleneckQueues.Get(i)));
         }
     }
 
     if (pcap)
     {
+        // EnablePcapAll covers every point-to-point device, the benchmark sink links included
         UnReLink.EnablePcapAll(prefix_file_name, true);
         LocalLink.EnablePcapAll(prefix_file_name, true);
     }
@@ -685,14 +1524,58 @@ main(int argc, char* argv[])
         flowHelper.InstallAll();
     }
 
+    if (batch_fd >= 0)
+    {
+        for (uint32_t index = 0; index < num_flows; index++)
+        {
+            Simulator::Schedule(Seconds(start_time * index + 0.00001), &TraceRttStats, index + 1);
+        }
+    }
+
     Simulator::Stop(Seconds(stop_time));
+    auto runStart = std::chrono::steady_clock::now();
     Simulator::Run();
+    auto runEnd = std::chrono::steady_clock::now();
+
+    if (benchmark)
+    {
+        ReportBenchmark(sinkApps,
+                        start_time,
+                        stop_time,
+                        std::chrono::duration<double>(runStart - wallStart).count(),
+                        std::chrono::duration<double>(runEnd - runStart).count());
+    }
+
+    if (queue_report)
+    {
+        ReportQueues(queueTracers);
+    }
+
+    BatchResult batchResult{0.0, 0.0};
+    for (uint32_t i = 0; i < sinkApps.GetN(); i++)
+    {
+        batchResult.goodput += FlowGoodput(sinkApps, i, start_time, stop_time);
+    }
+    if (rttStats.samples > 0)
+    {
+        batchResult.rtt = rttStats.sum / rttStats.samples;
+    }
 
     if (flow_monitor)
     {
         flowHelper.SerializeToXmlFile(prefix_file_name + ".flowmonitor", true, true);
     }
+    flowTracers.clear();
+    queueTracers.clear();
+    binaryTrace.reset();
 
     Simulator::Destroy();
+    if (batch_fd >= 0)
+    {
+        ssize_t written = write(batch_fd, &batchResult, sizeof(batchResult));
+        close(batch_fd);
+        std::cout.flush();
+        _exit(written == sizeof(batchResult) ? 0 : 1);
+    }
     return 0;
 }
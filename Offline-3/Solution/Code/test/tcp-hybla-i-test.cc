@@ -0,0 +1,431 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/tcp-congestion-ops.h"
+#include "ns3/tcp-hybla-i.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("TcpHyblaITestSuite");
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TcpHyblaI window growth, checked against a reference that evaluates rho^2 and 2^rho
+ * with std::pow on every ACK and adds the congestion avoidance increments one segment at a time.
+ *
+ * The slow start growth must match exactly. In congestion avoidance the increments are summed
+ * in closed form, which only rounds differently: the cwnd may run one segment ahead of or behind
+ * the reference when the fractional counter lands next to an integer.
+ */
+class TcpHyblaIIncrementTest : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param cWnd Congestion window.
+     * \param ssThresh Slow Start Threshold.
+     * \param segmentSize Segment size.
+     * \param rtt Round trip time.
+     * \param segmentsAcked Segments acknowledged by each ACK.
+     * \param name Test description.
+     */
+    TcpHyblaIIncrementTest(uint32_t cWnd,
+                           uint32_t ssThresh,
+                           uint32_t segmentSize,
+                           const Time& rtt,
+                           uint32_t segmentsAcked,
+                           const std::string& name);
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Reference scaling factor, as computed before rho^2, 2^rho and sRtt were cached.
+     * \param state The socket state.
+     * \return the scaling factor.
+     */
+    double ReferenceScalingFactor(Ptr<TcpSocketState> state) const;
+
+    uint32_t m_cWnd;        //!< cWnd.
+    uint32_t m_ssThresh;    //!< Slow Start Threshold.
+    uint32_t m_segmentSize; //!< Segment size.
+    Time m_rtt;             //!< Round trip time.
+    uint32_t m_segmentsAcked; //!< Segments acknowledged by each ACK.
+    Time m_sRtt;            //!< Reference smoothed RTT.
+};
+
+TcpHyblaIIncrementTest::TcpHyblaIIncrementTest(uint32_t cWnd,
+                                               uint32_t ssThresh,
+                                               uint32_t segmentSize,
+                                               const Time& rtt,
+                                               uint32_t segmentsAcked,
+                                               const std::string& name)
+    : TestCase(name),
+      m_cWnd(cWnd),
+      m_ssThresh(ssThresh),
+      m_segmentSize(segmentSize),
+      m_rtt(rtt),
+      m_segmentsAcked(segmentsAcked)
+{
+}
+
+double
+TcpHyblaIIncrementTest::ReferenceScalingFactor(Ptr<TcpSocketState> state) const
+{
+    double cwndInBytes = (double)state->m_cWnd;
+    double inFlight = (double)state->m_bytesInFlight;
+    double inflightRatio = (cwndInBytes > 0) ? inFlight / cwndInBytes : 0.0;
+
+    double computedRto = state->m_srtt.Get().GetSeconds() * 2.0;
+    double rtoRatio = (m_sRtt.IsZero()) ? 1.0 : (computedRto / m_sRtt.GetSeconds());
+    rtoRatio = std::max(rtoRatio, 1.0);
+
+    uint32_t outstanding = state->m_nextTxSequence - state->m_lastAckedSeq;
+    double outstandingFactor = 1.0;
+    if (outstanding > state->GetCwndInSegments() * 2)
+    {
+        outstandingFactor = 0.9;
+    }
+
+    double inflightFactor = 1.0;
+    if (inflightRatio > 0.8)
+    {
+        inflightFactor = std::max(1.0 - ((inflightRatio - 0.8) * 0.5), 0.5);
+    }
+
+    double rtoFactor = 1.0 / (1.0 + (rtoRatio - 1.0) * 1.0);
+    return std::max(inflightFactor * rtoFactor * outstandingFactor, 0.5);
+}
+
+void
+TcpHyblaIIncrementTest::DoRun()
+{
+    Ptr<TcpSocketState> state = CreateObject<TcpSocketState>();
+    state->m_cWnd = m_cWnd;
+    state->m_ssThresh = m_ssThresh;
+    state->m_segmentSize = m_segmentSize;
+    state->m_minRtt = m_rtt;
+    state->m_srtt = m_rtt;
+    state->m_bytesInFlight = m_cWnd / 2;
+    state->m_lastAckedSeq = SequenceNumber32(1);
+    state->m_nextTxSequence = SequenceNumber32(1 + m_cWnd / 2);
+
+    Ptr<TcpHyblaI> cong = CreateObject<TcpHyblaI>();
+    cong->PktsAcked(state, 1, m_rtt);
+
+    m_sRtt = m_rtt;
+    double rho = std::max((double)m_sRtt.GetMilliSeconds() / 50.0, 1.0);
+    uint32_t refCwnd = m_cWnd;
+    double refCwndCnt = 0.0;
+
+    for (uint32_t ack = 0; ack < 1000; ++ack)
+    {
+        cong->IncreaseWindow(state, m_segmentsAcked);
+
+        // Reference, with the window of the reference in the same socket state
+        Ptr<TcpSocketState> ref = CopyObject<TcpSocketState>(state);
+        ref->m_cWnd = refCwnd;
+        uint32_t segmentsAcked = m_segmentsAcked;
+        bool slowStart = false;
+        if (refCwnd < m_ssThresh && segmentsAcked >= 1)
+        {
+            double increment = (std::pow(2, rho) - 1.0) * ReferenceScalingFactor(ref);
+            uint32_t incr = static_cast<uint32_t>(increment * m_segmentSize);
+            refCwnd = std::min(refCwnd + incr, m_ssThresh);
+            segmentsAcked -= 1;
+            slowStart = true;
+        }
+        ref->m_cWnd = refCwnd;
+        if (refCwnd >= m_ssThresh)
+        {
+            while (segmentsAcked > 0)
+            {
+                refCwndCnt += std::pow(rho, 2) / static_cast<double>(ref->GetCwndInSegments());
+                segmentsAcked -= 1;
+            }
+            if (refCwndCnt >= 1.0)
+            {
+                uint32_t inc = static_cast<uint32_t>(refCwndCnt);
+                refCwndCnt -= inc;
+                refCwnd +=
+                    (uint32_t)((double)inc * ReferenceScalingFactor(ref) * (double)m_segmentSize);
+            }
+        }
+
+        if (slowStart && refCwnd < m_ssThresh)
+        {
+            NS_TEST_ASSERT_MSG_EQ(state->m_cWnd.Get(),
+                                  refCwnd,
+                                  "Slow start cwnd differs from the reference at ACK " << ack);
+        }
+        else
+        {
+            NS_TEST_ASSERT_MSG_EQ_TOL(state->m_cWnd.Get(),
+                                      refCwnd,
+                                      m_segmentSize,
+                                      "Congestion avoidance cwnd drifted from the reference at ACK "
+                                          << ack);
+        }
+        // Keep the reference in step once the tolerance was used
+        refCwnd = state->m_cWnd;
+    }
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TcpHyblaI pacing: the pacing rate of the socket follows cwnd / sRtt times the gain of the
+ * phase, within MaxPacingRate, and is left alone when pacing is disabled.
+ */
+class TcpHyblaIPacingTest : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param pacing Whether the Pacing attribute is set.
+     * \param ssThresh Slow Start Threshold.
+     * \param maxPacingRate MaxPacingRate attribute.
+     * \param name Test description.
+     */
+    TcpHyblaIPacingTest(bool pacing,
+                        uint32_t ssThresh,
+                        const DataRate& maxPacingRate,
+                        const std::string& name);
+
+  private:
+    void DoRun() override;
+
+    bool m_pacing;            //!< Pacing attribute.
+    uint32_t m_ssThresh;      //!< Slow Start Threshold.
+    DataRate m_maxPacingRate; //!< MaxPacingRate attribute.
+};
+
+TcpHyblaIPacingTest::TcpHyblaIPacingTest(bool pacing,
+                                         uint32_t ssThresh,
+                                         const DataRate& maxPacingRate,
+                                         const std::string& name)
+    : TestCase(name),
+      m_pacing(pacing),
+      m_ssThresh(ssThresh),
+      m_maxPacingRate(maxPacingRate)
+{
+}
+
+void
+TcpHyblaIPacingTest::DoRun()
+{
+    Ptr<TcpSocketState> state = CreateObject<TcpSocketState>();
+    state->m_cWnd = 10000;
+    state->m_ssThresh = m_ssThresh;
+    state->m_segmentSize = 500;
+    state->m_minRtt = MilliSeconds(200);
+    state->m_srtt = MilliSeconds(200);
+    state->m_bytesInFlight = 5000;
+    state->m_lastAckedSeq = SequenceNumber32(1);
+    state->m_nextTxSequence = SequenceNumber32(5001);
+    DataRate initialRate = state->m_pacingRate;
+
+    Ptr<TcpHyblaI> cong = CreateObject<TcpHyblaI>();
+    cong->SetAttribute("Pacing", BooleanValue(m_pacing));
+    cong->SetAttribute("MaxPacingRate", DataRateValue(m_maxPacingRate));
+    cong->Init(state);
+    NS_TEST_ASSERT_MSG_EQ(state->m_pacing, m_pacing, "Pacing not enabled on the socket");
+
+    // sRtt = 0.9 * 200 ms + 0.1 * 300 ms = 210 ms
+    cong->PktsAcked(state, 1, MilliSeconds(200));
+    cong->PktsAcked(state, 1, MilliSeconds(300));
+    cong->IncreaseWindow(state, 1);
+
+    if (!m_pacing)
+    {
+        NS_TEST_ASSERT_MSG_EQ(state->m_pacingRate.Get(), initialRate, "Pacing rate changed");
+        return;
+    }
+    double gain = (state->m_cWnd < m_ssThresh / 2) ? 2.0 : 1.2;
+    DataRate expected(static_cast<uint64_t>(gain * state->m_cWnd * 8 / 0.21));
+    expected = std::min(expected, m_maxPacingRate);
+    NS_TEST_ASSERT_MSG_EQ_TOL(state->m_pacingRate.Get().GetBitRate(),
+                              expected.GetBitRate(),
+                              expected.GetBitRate() / 1000,
+                              "Pacing rate is not cwnd / sRtt times the gain");
+    NS_TEST_ASSERT_MSG_EQ(state->m_maxPacingRate,
+                          state->m_pacingRate.Get(),
+                          "Socket cap differs from the pacing rate");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TcpHyblaI trace sources: HyblaIRho and SmoothedRtt follow the RTT samples, and
+ * ScalingFactor reports the factors of each scaled increment.
+ */
+class TcpHyblaITraceTest : public TestCase
+{
+  public:
+    TcpHyblaITraceTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Rho tracer.
+     * \param oldval Old value.
+     * \param newval New value.
+     */
+    void Rho(double oldval, double newval);
+
+    /**
+     * Smoothed RTT tracer.
+     * \param oldval Old value.
+     * \param newval New value.
+     */
+    void SmoothedRtt(Time oldval, Time newval);
+
+    /**
+     * Scaling factor tracer.
+     * \param inflightFactor In-flight factor.
+     * \param rtoFactor RTO factor.
+     * \param outstandingFactor Outstanding data factor.
+     * \param scale Scaling factor applied.
+     */
+    void ScalingFactor(double inflightFactor,
+                       double rtoFactor,
+                       double outstandingFactor,
+                       double scale);
+
+    double m_rho{0.0};           //!< Last traced rho.
+    Time m_sRtt;                 //!< Last traced smoothed RTT.
+    uint32_t m_scalings{0};      //!< Number of traced scalings.
+    double m_scale{0.0};         //!< Last traced scaling factor.
+    double m_factorProduct{0.0}; //!< Product of the last traced factors.
+};
+
+TcpHyblaITraceTest::TcpHyblaITraceTest()
+    : TestCase("Trace sources of the TcpHyblaI state")
+{
+}
+
+void
+TcpHyblaITraceTest::Rho(double oldval [[maybe_unused]], double newval)
+{
+    m_rho = newval;
+}
+
+void
+TcpHyblaITraceTest::SmoothedRtt(Time oldval [[maybe_unused]], Time newval)
+{
+    m_sRtt = newval;
+}
+
+void
+TcpHyblaITraceTest::ScalingFactor(double inflightFactor,
+                                  double rtoFactor,
+                                  double outstandingFactor,
+                                  double scale)
+{
+    m_scalings++;
+    m_scale = scale;
+    m_factorProduct = inflightFactor * rtoFactor * outstandingFactor;
+}
+
+void
+TcpHyblaITraceTest::DoRun()
+{
+    Ptr<TcpSocketState> state = CreateObject<TcpSocketState>();
+    state->m_cWnd = 1000;
+    state->m_ssThresh = 0xFFFFFFFF;
+    state->m_segmentSize = 500;
+    state->m_minRtt = MilliSeconds(100);
+    state->m_srtt = MilliSeconds(100);
+    state->m_bytesInFlight = 1000;
+    state->m_lastAckedSeq = SequenceNumber32(1);
+    state->m_nextTxSequence = SequenceNumber32(1001);
+
+    Ptr<TcpHyblaI> cong = CreateObject<TcpHyblaI>();
+    cong->TraceConnectWithoutContext("HyblaIRho",
+                                     MakeCallback(&TcpHyblaITraceTest::Rho, this));
+    cong->TraceConnectWithoutContext("SmoothedRtt",
+                                     MakeCallback(&TcpHyblaITraceTest::SmoothedRtt, this));
+    cong->TraceConnectWithoutContext("ScalingFactor",
+                                     MakeCallback(&TcpHyblaITraceTest::ScalingFactor, this));
+
+    cong->PktsAcked(state, 1, MilliSeconds(100));
+    NS_TEST_ASSERT_MSG_EQ(m_sRtt, MilliSeconds(100), "First RTT sample not traced as sRtt");
+    NS_TEST_ASSERT_MSG_EQ_TOL(m_rho, 2.0, 1e-9, "Rho of a 100 ms sRtt not traced");
+
+    cong->IncreaseWindow(state, 1);
+    NS_TEST_ASSERT_MSG_EQ(m_scalings, 1, "Slow start increment scaling not traced");
+    // In flight is the whole window (0.9), the RTO estimate twice the sRtt (0.5) and more than
+    // twice the window in segments is outstanding (0.9); their product is bounded at 0.5
+    NS_TEST_ASSERT_MSG_EQ_TOL(m_factorProduct, 0.405, 1e-9, "Unexpected traced factors");
+    NS_TEST_ASSERT_MSG_EQ_TOL(m_scale, 0.5, 1e-9, "Unexpected traced scaling factor");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief TCP HyblaI TestSuite
+ */
+class TcpHyblaITestSuite : public TestSuite
+{
+  public:
+    TcpHyblaITestSuite()
+        : TestSuite("tcp-hybla-i-test", Type::UNIT)
+    {
+        AddTestCase(new TcpHyblaIIncrementTest(500,
+                                               0xFFFFFFFF,
+                                               500,
+                                               MilliSeconds(55),
+                                               1,
+                                               "Rho=1.1, slow start"),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpHyblaIIncrementTest(1000,
+                                               20000,
+                                               500,
+                                               MilliSeconds(100),
+                                               1,
+                                               "Rho=2, slow start then congestion avoidance"),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpHyblaIIncrementTest(500,
+                                               0,
+                                               500,
+                                               MilliSeconds(130),
+                                               3,
+                                               "Rho=2.6, congestion avoidance, 3 segments per ACK"),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpHyblaIIncrementTest(5000,
+                                               0,
+                                               1446,
+                                               MilliSeconds(20),
+                                               2,
+                                               "Rho=1, congestion avoidance, 2 segments per ACK"),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpHyblaIPacingTest(false, 0xFFFFFFFF, DataRate("4Gb/s"), "No pacing"),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpHyblaIPacingTest(true,
+                                            0xFFFFFFFF,
+                                            DataRate("4Gb/s"),
+                                            "Pacing, slow start gain"),
+                    TestCase::Duration::QUICK);
+        AddTestCase(new TcpHyblaIPacingTest(true,
+                                            0,
+                                            DataRate("4Gb/s"),
+                                            "Pacing, congestion avoidance gain"),
+                    TestCase::Duration::QUICK);
+        AddTestCase(
+            new TcpHyblaIPacingTest(true, 0, DataRate("100kb/s"), "Pacing, MaxPacingRate cap"),
+            TestCase::Duration::QUICK);
+        AddTestCase(new TcpHyblaITraceTest(), TestCase::Duration::QUICK);
+    }
+};
+
+static TcpHyblaITestSuite g_tcpHyblaITest; //!< Static variable for test initialization